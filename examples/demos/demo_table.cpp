@@ -99,6 +99,13 @@ SkBitmap DemoTable::GetIcon(int row)
 
 void DemoTable::SetObserver(ui::TableModelObserver* observer) {}
 
+bool DemoTable::GetSortKey(int row, int column_id, std::string* key)
+{
+    // CompareValues isn't overridden, so the text's collation key orders the
+    // same way.
+    return GetTextSortKey(row, column_id, key);
+}
+
 void DemoTable::OnSelectionChanged()
 {
     PrintStatus(base::StringPrintf(L"Selection changed: %d",
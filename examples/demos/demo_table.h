@@ -36,6 +36,7 @@ public:
     virtual string16 GetText(int row, int column_id);
     virtual SkBitmap GetIcon(int row);
     virtual void SetObserver(ui::TableModelObserver* observer);
+    virtual bool GetSortKey(int row, int column_id, std::string* key);
 
     // Overridden from view::TableViewObserver:
     virtual void OnSelectionChanged();
@@ -12,6 +12,8 @@ GanttView::GanttView() : select_frame_(NULL)
 {
     set_background(view::Background::CreateSolidBackground(255, 255, 255));
     set_context_menu_controller(GanttViewMenuController::GetInstance());
+    // A chart can hold many bars; don't hit test all of them on mouse moves.
+    SetChildHitTestIndexEnabled(true);
 
     for(int i=0; i<10; ++i)
     {
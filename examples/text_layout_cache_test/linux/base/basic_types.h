@@ -0,0 +1,27 @@
+
+#ifndef __text_layout_cache_test_base_basic_types_h__
+#define __text_layout_cache_test_base_basic_types_h__
+
+#pragma once
+
+#include <stddef.h>
+
+// The parts of base/basic_types.h that the harness needs; the real one uses
+// MSVC literal suffixes.
+typedef signed char         int8;
+typedef short               int16;
+typedef int                 int32;
+typedef unsigned char       uint8;
+typedef unsigned short      uint16;
+typedef unsigned int        uint32;
+
+#define DISALLOW_COPY_AND_ASSIGN(TypeName) \
+    TypeName(const TypeName&); \
+    void operator=(const TypeName&)
+
+template<typename T, size_t N>
+char (&ArraySizeHelper(T (&array)[N]))[N];
+
+#define arraysize(array) (sizeof(ArraySizeHelper(array)))
+
+#endif //__text_layout_cache_test_base_basic_types_h__
@@ -0,0 +1,12 @@
+
+#ifndef __text_layout_cache_test_base_logging_h__
+#define __text_layout_cache_test_base_logging_h__
+
+#pragma once
+
+#include <assert.h>
+
+// The part of base/logging.h that text_layout_cache.cpp uses.
+#define DCHECK(condition) assert(condition)
+
+#endif //__text_layout_cache_test_base_logging_h__
@@ -0,0 +1,103 @@
+
+#ifndef __text_layout_cache_test_base_ref_counted_h__
+#define __text_layout_cache_test_base_ref_counted_h__
+
+#pragma once
+
+#include <stddef.h>
+
+// The real header gets <windows.h> through the atomics; ui_gfx/font.h relies
+// on that for HFONT.
+#include <windows.h>
+
+// The parts of base/memory/ref_counted.h that gfx::Font uses, without the
+// Windows atomics.
+namespace base
+{
+
+    template<class T>
+    class RefCounted
+    {
+    public:
+        RefCounted() : ref_count_(0) {}
+
+        void AddRef() const
+        {
+            ++ref_count_;
+        }
+
+        void Release() const
+        {
+            if(--ref_count_ == 0)
+            {
+                delete static_cast<const T*>(this);
+            }
+        }
+
+    protected:
+        ~RefCounted() {}
+
+    private:
+        mutable int ref_count_;
+    };
+
+} //namespace base
+
+template<class T>
+class scoped_refptr
+{
+public:
+    scoped_refptr() : ptr_(NULL) {}
+
+    scoped_refptr(T* p) : ptr_(p)
+    {
+        if(ptr_)
+        {
+            ptr_->AddRef();
+        }
+    }
+
+    scoped_refptr(const scoped_refptr<T>& r) : ptr_(r.ptr_)
+    {
+        if(ptr_)
+        {
+            ptr_->AddRef();
+        }
+    }
+
+    ~scoped_refptr()
+    {
+        if(ptr_)
+        {
+            ptr_->Release();
+        }
+    }
+
+    T* get() const { return ptr_; }
+    operator T*() const { return ptr_; }
+    T* operator->() const { return ptr_; }
+
+    scoped_refptr<T>& operator=(T* p)
+    {
+        if(p)
+        {
+            p->AddRef();
+        }
+        if(ptr_)
+        {
+            ptr_->Release();
+        }
+        ptr_ = p;
+        return *this;
+    }
+
+    scoped_refptr<T>& operator=(const scoped_refptr<T>& r)
+    {
+        return *this = r.ptr_;
+    }
+
+private:
+    T* ptr_;
+};
+
+#endif //__text_layout_cache_test_base_ref_counted_h__
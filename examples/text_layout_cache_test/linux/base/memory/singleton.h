@@ -0,0 +1,30 @@
+
+#ifndef __text_layout_cache_test_base_singleton_h__
+#define __text_layout_cache_test_base_singleton_h__
+
+#pragma once
+
+// A single-threaded Singleton with the interface of base/memory/singleton.h;
+// the real one needs the Windows atomics and an AtExitManager.
+template<typename Type>
+struct DefaultSingletonTraits
+{
+    static Type* New()
+    {
+        return new Type();
+    }
+};
+
+template<typename Type, typename Traits=DefaultSingletonTraits<Type>,
+typename DifferentiatingType=Type>
+class Singleton
+{
+public:
+    static Type* get()
+    {
+        static Type* instance = Traits::New();
+        return instance;
+    }
+};
+
+#endif //__text_layout_cache_test_base_singleton_h__
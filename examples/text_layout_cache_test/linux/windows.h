@@ -0,0 +1,13 @@
+
+#ifndef __text_layout_cache_test_windows_h__
+#define __text_layout_cache_test_windows_h__
+
+#pragma once
+
+// Stands in for <windows.h> on Linux. The ui_gfx headers the harness includes
+// only name these handle types.
+typedef void* HDC;
+typedef void* HFONT;
+typedef void* HWND;
+
+#endif //__text_layout_cache_test_windows_h__
@@ -0,0 +1,129 @@
+
+#include "stub_platform_font.h"
+
+#include "ui_gfx/font.h"
+
+int StubPlatformFont::width_calls_ = 0;
+
+StubPlatformFont::StubPlatformFont(int font_size, int style)
+: font_size_(font_size), style_(style) {}
+
+gfx::Font StubPlatformFont::DeriveFont(int size_delta, int style) const
+{
+    return gfx::Font(new StubPlatformFont(font_size_+size_delta, style));
+}
+
+int StubPlatformFont::GetHeight() const
+{
+    return font_size_ + 4;
+}
+
+int StubPlatformFont::GetBaseline() const
+{
+    return font_size_;
+}
+
+int StubPlatformFont::GetAverageCharacterWidth() const
+{
+    return font_size_ * 7 / 12;
+}
+
+int StubPlatformFont::GetStringWidth(const string16& text) const
+{
+    int width = 0;
+    for(size_t i=0; i<text.length(); ++i)
+    {
+        bool has_glyph;
+        width += GetCharacterWidth(text[i], &has_glyph);
+    }
+    return width;
+}
+
+bool StubPlatformFont::GetCharacterWidths(const string16& text,
+                                          std::vector<int>* widths) const
+{
+    ++width_calls_;
+    bool has_all_glyphs = true;
+    widths->assign(text.length(), 0);
+    for(size_t i=0; i<text.length(); ++i)
+    {
+        bool has_glyph;
+        (*widths)[i] = GetCharacterWidth(text[i], &has_glyph);
+        if(!has_glyph)
+        {
+            has_all_glyphs = false;
+        }
+    }
+    return has_all_glyphs;
+}
+
+int StubPlatformFont::GetExpectedTextWidth(int length) const
+{
+    return length * GetAverageCharacterWidth();
+}
+
+int StubPlatformFont::GetStyle() const
+{
+    return style_;
+}
+
+string16 StubPlatformFont::GetFontName() const
+{
+    return string16(L"Stub");
+}
+
+int StubPlatformFont::GetFontSize() const
+{
+    return font_size_;
+}
+
+HFONT StubPlatformFont::GetNativeFont() const
+{
+    return NULL;
+}
+
+int StubPlatformFont::GetCharacterWidth(char16 c, bool* has_glyph) const
+{
+    *has_glyph = true;
+    if(c==L' ' || c==L'i' || c==L'l' || c==L'.')
+    {
+        return font_size_ / 4;
+    }
+    if(c < 0x100)
+    {
+        return font_size_ * 7 / 12;
+    }
+    if(c>=0xAC00 && c<0xD7A4)
+    {
+        *has_glyph = false;
+    }
+    return font_size_;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// PlatformFont, public:
+
+// static
+gfx::PlatformFont* gfx::PlatformFont::CreateDefault()
+{
+    return new StubPlatformFont;
+}
+
+// static
+gfx::PlatformFont* gfx::PlatformFont::CreateFromFont(const Font& other)
+{
+    return new StubPlatformFont(other.GetFontSize(), other.GetStyle());
+}
+
+// static
+gfx::PlatformFont* gfx::PlatformFont::CreateFromNativeFont(HFONT native_font)
+{
+    return new StubPlatformFont;
+}
+
+// static
+gfx::PlatformFont* gfx::PlatformFont::CreateFromNameAndSize(
+    const string16& font_name, int font_size)
+{
+    return new StubPlatformFont(font_size);
+}
@@ -0,0 +1,56 @@
+
+#ifndef __text_layout_cache_test_stub_platform_font_h__
+#define __text_layout_cache_test_stub_platform_font_h__
+
+#pragma once
+
+#include <windows.h>
+
+#include "base/basic_types.h"
+#include "ui_gfx/platform_font.h"
+
+// A PlatformFont with fixed metrics, so that layouts can be checked without a
+// platform font engine. At size 12:
+//   - ' ', 'i', 'l' and '.' advance 3 pixels; other Latin-1 characters 7.
+//   - CJK ideographs and kana advance 12.
+//   - Hangul (U+AC00..U+D7A3) has no glyph; it advances 12 but
+//     GetCharacterWidths() reports it as missing.
+//   - A line is 16 pixels high.
+// Advances scale with the size. Every call to GetCharacterWidths() is counted.
+class StubPlatformFont : public gfx::PlatformFont
+{
+public:
+    explicit StubPlatformFont(int font_size=12, int style=0);
+
+    static int width_calls() { return width_calls_; }
+    static void reset_width_calls() { width_calls_ = 0; }
+
+    // Overridden from PlatformFont:
+    virtual gfx::Font DeriveFont(int size_delta, int style) const;
+    virtual int GetHeight() const;
+    virtual int GetBaseline() const;
+    virtual int GetAverageCharacterWidth() const;
+    virtual int GetStringWidth(const string16& text) const;
+    virtual bool GetCharacterWidths(const string16& text,
+        std::vector<int>* widths) const;
+    virtual int GetExpectedTextWidth(int length) const;
+    virtual int GetStyle() const;
+    virtual string16 GetFontName() const;
+    virtual int GetFontSize() const;
+    virtual HFONT GetNativeFont() const;
+
+private:
+    virtual ~StubPlatformFont() {}
+
+    // Advance of |c|; sets |has_glyph| to false for characters the stub lacks.
+    int GetCharacterWidth(char16 c, bool* has_glyph) const;
+
+    const int font_size_;
+    const int style_;
+
+    static int width_calls_;
+
+    DISALLOW_COPY_AND_ASSIGN(StubPlatformFont);
+};
+
+#endif //__text_layout_cache_test_stub_platform_font_h__
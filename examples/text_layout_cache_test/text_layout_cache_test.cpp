@@ -0,0 +1,301 @@
+
+// Checks gfx::TextLayoutCache against StubPlatformFont: line breaking, the
+// two-segment eviction and the hit/miss counters. Returns non-zero if a check
+// fails. To build it on Linux, run this as one command from the top of the
+// tree:
+//
+//   g++ -DSK_BUILD_FOR_UNIX -finput-charset=gbk
+//       -Iexamples/text_layout_cache_test/linux -Ilibrary -Ilibrary/ui_gfx
+//       -Ilibrary/third_party/skia/include/core
+//       -Ilibrary/third_party/skia/include/config
+//       examples/text_layout_cache_test/*.cpp
+//       library/ui_gfx/text_layout_cache.cpp library/ui_gfx/font.cpp
+//       -o text_layout_cache_test
+//
+// linux/ stands in for the Windows-only parts of base that the cache uses.
+
+#include <stdio.h>
+
+#include "ui_gfx/canvas.h"
+#include "ui_gfx/font.h"
+#include "ui_gfx/text_layout_cache.h"
+
+#include "stub_platform_font.h"
+
+namespace
+{
+
+    int failures = 0;
+
+    void ExpectTrue(bool condition, const char* expression, int line)
+    {
+        if(!condition)
+        {
+            printf("line %d: expected %s\n", line, expression);
+            ++failures;
+        }
+    }
+
+    void ExpectEq(int expected, int actual, const char* expression, int line)
+    {
+        if(expected != actual)
+        {
+            printf("line %d: %s is %d, expected %d\n", line, expression,
+                actual, expected);
+            ++failures;
+        }
+    }
+
+#define EXPECT_TRUE(condition) ExpectTrue(condition, #condition, __LINE__)
+#define EXPECT_EQ(expected, actual) \
+    ExpectEq(static_cast<int>(expected), static_cast<int>(actual), \
+    #actual, __LINE__)
+
+    const int kMultiLine = gfx::Canvas::MULTI_LINE;
+
+    gfx::TextLayout LayOut(const string16& text, int flags, int width)
+    {
+        gfx::TextLayout layout;
+        gfx::TextLayoutCache::LayOut(text, gfx::Font(new StubPlatformFont),
+            flags, width, &layout);
+        return layout;
+    }
+
+    // A string no other call uses, so that it always misses the cache.
+    string16 UniqueText(int n)
+    {
+        wchar_t text[32];
+        swprintf(text, 32, L"unique %d", n);
+        return string16(text);
+    }
+
+    void TestLineBreaking()
+    {
+        // "aaa" is 21 pixels wide and a space 3.
+        gfx::TextLayout layout = LayOut(L"aaa bbb ccc", kMultiLine, 45);
+        EXPECT_EQ(2, layout.lines.size());
+        EXPECT_EQ(0, layout.lines[0].start);
+        EXPECT_EQ(7, layout.lines[0].length);
+        EXPECT_EQ(45, layout.lines[0].width);
+        EXPECT_EQ(8, layout.lines[1].start);
+        EXPECT_EQ(3, layout.lines[1].length);
+        EXPECT_EQ(21, layout.lines[1].width);
+        EXPECT_EQ(45, layout.width);
+        EXPECT_EQ(32, layout.height);
+        EXPECT_TRUE(layout.has_all_glyphs);
+
+        // One pixel less and every word gets its own line. The space a line
+        // breaks at doesn't count towards its width.
+        layout = LayOut(L"aaa bbb ccc", kMultiLine, 44);
+        EXPECT_EQ(3, layout.lines.size());
+        EXPECT_EQ(21, layout.lines[0].width);
+        EXPECT_EQ(21, layout.width);
+        EXPECT_EQ(48, layout.height);
+
+        // Single-line text ignores the width.
+        layout = LayOut(L"aaa bbb ccc", 0, 10);
+        EXPECT_EQ(1, layout.lines.size());
+        EXPECT_EQ(69, layout.width);
+
+        // Line breaks always start a new line; "\r\n" is one break.
+        layout = LayOut(L"ab\ncd\r\nef", kMultiLine, 1000);
+        EXPECT_EQ(3, layout.lines.size());
+        EXPECT_EQ(3, layout.lines[1].start);
+        EXPECT_EQ(2, layout.lines[1].length);
+        EXPECT_EQ(7, layout.lines[2].start);
+
+        // A word wider than the line stays whole, unless CHARACTER_BREAK.
+        layout = LayOut(L"aaaaaa b", kMultiLine, 30);
+        EXPECT_EQ(2, layout.lines.size());
+        EXPECT_EQ(42, layout.lines[0].width);
+        layout = LayOut(L"aaaaaa b",
+            kMultiLine|gfx::Canvas::CHARACTER_BREAK, 30);
+        EXPECT_EQ(2, layout.lines.size());
+        EXPECT_EQ(4, layout.lines[0].length);
+        EXPECT_EQ(28, layout.lines[0].width);
+
+        // CJK text breaks between any two characters.
+        layout = LayOut(L"\x4E2D\x6587\x5B57", kMultiLine, 25);
+        EXPECT_EQ(2, layout.lines.size());
+        EXPECT_EQ(2, layout.lines[0].length);
+        EXPECT_EQ(24, layout.lines[0].width);
+
+        // Characters the font lacks are drawn with another font, so the layout
+        // says it can't be used.
+        layout = LayOut(L"ab \xD55C", kMultiLine, 100);
+        EXPECT_TRUE(!layout.has_all_glyphs);
+    }
+
+    void TestCanLayOut()
+    {
+        EXPECT_TRUE(gfx::TextLayoutCache::CanLayOut(L"Hello, world", 0));
+        EXPECT_TRUE(gfx::TextLayoutCache::CanLayOut(L"\x4E2D\x6587", 0));
+        EXPECT_TRUE(!gfx::TextLayoutCache::CanLayOut(L"\x05D0\x05D1", 0));
+        EXPECT_TRUE(!gfx::TextLayoutCache::CanLayOut(L"a\nb", 0));
+        EXPECT_TRUE(gfx::TextLayoutCache::CanLayOut(L"a\nb", kMultiLine));
+        EXPECT_TRUE(!gfx::TextLayoutCache::CanLayOut(L"&File",
+            gfx::Canvas::SHOW_PREFIX));
+    }
+
+    void TestCounters()
+    {
+        gfx::TextLayoutCache* cache = gfx::TextLayoutCache::GetInstance();
+        cache->Clear();
+        cache->ResetCounts();
+        StubPlatformFont::reset_width_calls();
+        gfx::Font font(new StubPlatformFont);
+
+        cache->GetLayout(L"aaa bbb", font, kMultiLine, 30);
+        cache->GetLayout(L"aaa bbb", font, kMultiLine, 30);
+        // Flags that don't affect the layout share the entry.
+        cache->GetLayout(L"aaa bbb", font,
+            kMultiLine|gfx::Canvas::TEXT_ALIGN_RIGHT, 30);
+        EXPECT_EQ(1, cache->miss_count());
+        EXPECT_EQ(2, cache->hit_count());
+        EXPECT_EQ(1, StubPlatformFont::width_calls());
+
+        // Another width or another font is another entry.
+        cache->GetLayout(L"aaa bbb", font, kMultiLine, 40);
+        cache->GetLayout(L"aaa bbb", gfx::Font(new StubPlatformFont(14)),
+            kMultiLine, 30);
+        EXPECT_EQ(3, cache->miss_count());
+        EXPECT_EQ(3, StubPlatformFont::width_calls());
+
+        // Single-line layouts don't depend on the width.
+        cache->GetLayout(L"aaa bbb", font, 0, 30);
+        cache->GetLayout(L"aaa bbb", font, 0, 40);
+        EXPECT_EQ(4, cache->miss_count());
+        EXPECT_EQ(3, cache->hit_count());
+
+        // Measured sizes are kept apart from layouts.
+        int width = 0, height = 0;
+        EXPECT_TRUE(!cache->GetMeasuredSize(L"aaa bbb", font, kMultiLine, 30,
+            &width, &height));
+        cache->SetMeasuredSize(L"aaa bbb", font, kMultiLine, 30, 21, 32);
+        EXPECT_TRUE(cache->GetMeasuredSize(L"aaa bbb", font, kMultiLine, 30,
+            &width, &height));
+        EXPECT_EQ(21, width);
+        EXPECT_EQ(32, height);
+
+        cache->ResetCounts();
+        EXPECT_EQ(0, cache->hit_count());
+        EXPECT_EQ(0, cache->miss_count());
+    }
+
+    void TestEviction()
+    {
+        gfx::TextLayoutCache* cache = gfx::TextLayoutCache::GetInstance();
+        cache->Clear();
+        gfx::Font font(new StubPlatformFont);
+        const int kProbation =
+            static_cast<int>(gfx::TextLayoutCache::kMaxProbationEntries);
+        const int kProtected =
+            static_cast<int>(gfx::TextLayoutCache::kMaxEntries) - kProbation;
+        int unique = 0;
+
+        // Hit twice, so it moves to the main segment; a flood of strings used
+        // once only pushes out other strings used once.
+        cache->GetLayout(L"label", font, 0, 0);
+        cache->GetLayout(L"label", font, 0, 0);
+        for(int i=0; i<4*kProbation; ++i)
+        {
+            cache->GetLayout(UniqueText(unique++), font, 0, 0);
+        }
+        EXPECT_EQ(kProbation+1, cache->size());
+        cache->ResetCounts();
+        cache->GetLayout(L"label", font, 0, 0);
+        EXPECT_EQ(1, cache->hit_count());
+
+        // Used once, pushed out, and used again soon after: it's remembered and
+        // goes straight to the main segment.
+        cache->GetLayout(L"menu", font, 0, 0);
+        for(int i=0; i<kProbation; ++i)
+        {
+            cache->GetLayout(UniqueText(unique++), font, 0, 0);
+        }
+        cache->ResetCounts();
+        cache->GetLayout(L"menu", font, 0, 0);
+        EXPECT_EQ(1, cache->miss_count());
+        for(int i=0; i<2*kProbation; ++i)
+        {
+            cache->GetLayout(UniqueText(unique++), font, 0, 0);
+        }
+        cache->ResetCounts();
+        cache->GetLayout(L"menu", font, 0, 0);
+        EXPECT_EQ(1, cache->hit_count());
+
+        // The main segment is bounded too.
+        for(int i=0; i<kProtected; ++i)
+        {
+            const string16 text = UniqueText(unique++);
+            cache->GetLayout(text, font, 0, 0);
+            cache->GetLayout(text, font, 0, 0);
+        }
+        EXPECT_TRUE(cache->size() <= gfx::TextLayoutCache::kMaxEntries);
+        cache->ResetCounts();
+        cache->GetLayout(L"label", font, 0, 0);
+        EXPECT_EQ(1, cache->miss_count());
+    }
+
+    void TestGhostReuse()
+    {
+        gfx::TextLayoutCache* cache = gfx::TextLayoutCache::GetInstance();
+        cache->Clear();
+        gfx::Font font(new StubPlatformFont);
+        const int kProbation =
+            static_cast<int>(gfx::TextLayoutCache::kMaxProbationEntries);
+        const int kProtected =
+            static_cast<int>(gfx::TextLayoutCache::kMaxEntries) - kProbation;
+        const int kGhosts = static_cast<int>(gfx::TextLayoutCache::kMaxGhosts);
+        int unique = 0;
+
+        // "tab" is pushed out, comes back from its ghost, and then falls out
+        // of the main segment.
+        cache->GetLayout(L"tab", font, 0, 0);
+        for(int i=0; i<kProbation; ++i)
+        {
+            cache->GetLayout(UniqueText(unique++), font, 0, 0);
+        }
+        cache->GetLayout(L"tab", font, 0, 0);
+        for(int i=0; i<kProtected; ++i)
+        {
+            const string16 text = UniqueText(unique++);
+            cache->GetLayout(text, font, 0, 0);
+            cache->GetLayout(text, font, 0, 0);
+        }
+
+        // Pushed out of probation a second time, its new ghost must outlive
+        // the first one, which has expired by now.
+        cache->GetLayout(L"tab", font, 0, 0);
+        for(int i=0; i<kGhosts+kProbation/2; ++i)
+        {
+            cache->GetLayout(UniqueText(unique++), font, 0, 0);
+        }
+        cache->GetLayout(L"tab", font, 0, 0);
+        for(int i=0; i<2*kProbation; ++i)
+        {
+            cache->GetLayout(UniqueText(unique++), font, 0, 0);
+        }
+        cache->ResetCounts();
+        cache->GetLayout(L"tab", font, 0, 0);
+        EXPECT_EQ(1, cache->hit_count());
+    }
+
+}
+
+int main(int argc, char** argv)
+{
+    TestLineBreaking();
+    TestCanLayOut();
+    TestCounters();
+    TestEviction();
+    TestGhostReuse();
+
+    if(failures)
+    {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,1169 @@
+/*
+ * jsimd_x86.c
+ *
+ * This file contains the SSE2 implementations of the SIMD hooks for x86 and
+ * x86-64, written with compiler intrinsics so that they build with the same
+ * toolchain as the rest of the library.  Support is detected at runtime; a
+ * routine that is not implemented here, or a CPU without SSE2, falls back to
+ * the plain C code.  Setting the environment variable JSIMD_FORCENONE=1
+ * disables SIMD, which is useful for comparing the two paths with jpgtest.
+ *
+ * The integer DCTs, color conversions and resampling produce the same
+ * output as the C versions for valid data.  Blocks whose dequantized
+ * coefficients don't fit in 16 bits, which only happens with corrupt data,
+ * are handed to the C IDCT.
+ */
+
+#define JPEG_INTERNALS
+#include "jinclude.h"
+#include "jpeglib.h"
+#include "jsimd.h"
+#include "jdct.h"
+#include "jsimddct.h"
+
+#include <stdlib.h>
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#elif !defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+#define JSIMD_NONE     0x00
+#define JSIMD_SSE2     0x08
+
+static unsigned int simd_support = ~0U;
+
+/*
+ * Check what SIMD accelerations are supported.  Racing threads all compute
+ * the same answer, so no locking is needed.
+ */
+
+LOCAL(void)
+init_simd (void)
+{
+  unsigned int support = JSIMD_NONE;
+  char *env;
+
+  if (simd_support != ~0U)
+    return;
+
+#if defined(_M_X64) || defined(__x86_64__)
+  support |= JSIMD_SSE2;	/* part of the x86-64 baseline */
+#elif defined(_MSC_VER)
+  {
+    int info[4];
+    __cpuid(info, 1);
+    if (info[3] & (1 << 26))
+      support |= JSIMD_SSE2;
+  }
+#else
+  {
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & (1 << 26)))
+      support |= JSIMD_SSE2;
+  }
+#endif
+
+  env = getenv("JSIMD_FORCENONE");
+  if (env != NULL && env[0] == '1' && env[1] == '\0')
+    support = JSIMD_NONE;
+
+  simd_support = support;
+}
+
+LOCAL(int)
+can_sse2 (void)
+{
+  init_simd();
+
+  /* The routines below assume 8-bit samples. */
+  if (BITS_IN_JSAMPLE != 8)
+    return 0;
+  if (sizeof(JSAMPLE) != 1)
+    return 0;
+
+  return (simd_support & JSIMD_SSE2) ? 1 : 0;
+}
+
+
+/**************** Color conversion ****************/
+
+/* See jccolor.c and jdcolor.c; both scale by 2^16. */
+#define F_0_081  5329			/* FIX(0.08131) */
+#define F_0_114  7471			/* FIX(0.11400) */
+#define F_0_168  11059			/* FIX(0.16874) */
+#define F_0_299  19595			/* FIX(0.29900) */
+#define F_0_331  21709			/* FIX(0.33126) */
+#define F_0_344  22554			/* FIX(0.34414) */
+#define F_0_419  27439			/* FIX(0.41869) */
+#define F_0_587  38470			/* FIX(0.58700) */
+#define F_0_714  46802			/* FIX(0.71414) */
+#define F_1_402  91881			/* FIX(1.40200) */
+#define F_1_772  116130			/* FIX(1.77200) */
+
+#define ONE_HALF_16  (1 << 15)
+
+/* Builds a madd operand whose 32-bit lanes each hold the constant pair (a, b).
+ * The shift is done unsigned, since (b) may be negative.
+ */
+#define PAIR(a, b)  _mm_set1_epi32((int) (((unsigned int) (b) << 16) | \
+                                          ((unsigned int) (a) & 0xFFFF)))
+
+GLOBAL(int)
+jsimd_can_rgb_ycc (void)
+{
+  return can_sse2();
+}
+
+GLOBAL(int)
+jsimd_can_ycc_rgb (void)
+{
+  return can_sse2();
+}
+
+/*
+ * Converts 8 pixels held as 16-bit R, G and B lanes to Y, Cb and Cr.  Wide
+ * constants are split across both halves of a madd pair so that every
+ * product stays exact.
+ */
+
+LOCAL(void)
+rgb_ycc_8 (__m128i r, __m128i g, __m128i b,
+           __m128i * y, __m128i * cb, __m128i * cr)
+{
+  __m128i rg_lo = _mm_unpacklo_epi16(r, g), rg_hi = _mm_unpackhi_epi16(r, g);
+  __m128i bg_lo = _mm_unpacklo_epi16(b, g), bg_hi = _mm_unpackhi_epi16(b, g);
+  __m128i gb_lo = _mm_unpacklo_epi16(g, b), gb_hi = _mm_unpackhi_epi16(g, b);
+  __m128i rr_lo = _mm_unpacklo_epi16(r, r), rr_hi = _mm_unpackhi_epi16(r, r);
+  __m128i bb_lo = _mm_unpacklo_epi16(b, b), bb_hi = _mm_unpackhi_epi16(b, b);
+  __m128i half = _mm_set1_epi32(ONE_HALF_16);
+  __m128i center = _mm_set1_epi32((CENTERJSAMPLE << 16) + ONE_HALF_16 - 1);
+  __m128i lo, hi;
+
+  /* Y = 0.299 R + 0.587 G + 0.114 B, with 0.587 = 32767 + 5703 */
+  lo = _mm_add_epi32(_mm_madd_epi16(rg_lo, PAIR(F_0_299, 32767)),
+                     _mm_madd_epi16(bg_lo, PAIR(F_0_114, F_0_587 - 32767)));
+  hi = _mm_add_epi32(_mm_madd_epi16(rg_hi, PAIR(F_0_299, 32767)),
+                     _mm_madd_epi16(bg_hi, PAIR(F_0_114, F_0_587 - 32767)));
+  lo = _mm_srai_epi32(_mm_add_epi32(lo, half), 16);
+  hi = _mm_srai_epi32(_mm_add_epi32(hi, half), 16);
+  *y = _mm_packs_epi32(lo, hi);
+
+  /* Cb = -0.16874 R - 0.33126 G + 0.5 B, with 0.5 = 32767 + 1 */
+  lo = _mm_add_epi32(_mm_madd_epi16(rg_lo, PAIR(-F_0_168, -F_0_331)),
+                     _mm_madd_epi16(bb_lo, PAIR(32767, 1)));
+  hi = _mm_add_epi32(_mm_madd_epi16(rg_hi, PAIR(-F_0_168, -F_0_331)),
+                     _mm_madd_epi16(bb_hi, PAIR(32767, 1)));
+  lo = _mm_srai_epi32(_mm_add_epi32(lo, center), 16);
+  hi = _mm_srai_epi32(_mm_add_epi32(hi, center), 16);
+  *cb = _mm_packs_epi32(lo, hi);
+
+  /* Cr = 0.5 R - 0.41869 G - 0.08131 B */
+  lo = _mm_add_epi32(_mm_madd_epi16(rr_lo, PAIR(32767, 1)),
+                     _mm_madd_epi16(gb_lo, PAIR(-F_0_419, -F_0_081)));
+  hi = _mm_add_epi32(_mm_madd_epi16(rr_hi, PAIR(32767, 1)),
+                     _mm_madd_epi16(gb_hi, PAIR(-F_0_419, -F_0_081)));
+  lo = _mm_srai_epi32(_mm_add_epi32(lo, center), 16);
+  hi = _mm_srai_epi32(_mm_add_epi32(hi, center), 16);
+  *cr = _mm_packs_epi32(lo, hi);
+}
+
+/*
+ * Converts 8 pixels of Y, Cb and Cr held in 16-bit lanes to R, G and B.
+ * The wide constants are written as an integer plus a 16-bit fraction, e.g.
+ * 1.402 x = x + 26345 x / 65536, which keeps the results bit-exact with the
+ * lookup tables in jdcolor.c.  mulhi of 2x gives floor(c x / 32768), and
+ * (that + 1) >> 1 is the correctly rounded floor((c x + 32768) / 65536).
+ */
+
+LOCAL(void)
+ycc_rgb_8 (__m128i y, __m128i cb, __m128i cr,
+           __m128i * r, __m128i * g, __m128i * b)
+{
+  __m128i one = _mm_set1_epi16(1);
+  __m128i center = _mm_set1_epi16(CENTERJSAMPLE);
+  __m128i half = _mm_set1_epi32(ONE_HALF_16);
+  __m128i xb = _mm_sub_epi16(cb, center);
+  __m128i xr = _mm_sub_epi16(cr, center);
+  __m128i t, lo, hi;
+
+  /* R = y + 1.402 Cr, 91881 = 65536 + 26345 */
+  t = _mm_mulhi_epi16(_mm_add_epi16(xr, xr), _mm_set1_epi16(F_1_402 - 65536));
+  t = _mm_srai_epi16(_mm_add_epi16(t, one), 1);
+  *r = _mm_add_epi16(_mm_add_epi16(y, xr), t);
+
+  /* G = y - 0.34414 Cb - 0.71414 Cr, -46802 = -65536 + 18734 */
+  lo = _mm_madd_epi16(_mm_unpacklo_epi16(xb, xr),
+                      PAIR(-F_0_344, 65536 - F_0_714));
+  hi = _mm_madd_epi16(_mm_unpackhi_epi16(xb, xr),
+                      PAIR(-F_0_344, 65536 - F_0_714));
+  lo = _mm_srai_epi32(_mm_add_epi32(lo, half), 16);
+  hi = _mm_srai_epi32(_mm_add_epi32(hi, half), 16);
+  *g = _mm_add_epi16(_mm_sub_epi16(y, xr), _mm_packs_epi32(lo, hi));
+
+  /* B = y + 1.772 Cb, 116130 = 2 * 65536 - 14942 */
+  t = _mm_mulhi_epi16(_mm_add_epi16(xb, xb), _mm_set1_epi16(F_1_772 - 131072));
+  t = _mm_srai_epi16(_mm_add_epi16(t, one), 1);
+  *b = _mm_add_epi16(_mm_add_epi16(y, _mm_add_epi16(xb, xb)), t);
+}
+
+GLOBAL(void)
+jsimd_rgb_ycc_convert (j_compress_ptr cinfo,
+                       JSAMPARRAY input_buf, JSAMPIMAGE output_buf,
+                       JDIMENSION output_row, int num_rows)
+{
+  int rindex = rgb_red[cinfo->in_color_space];
+  int gindex = rgb_green[cinfo->in_color_space];
+  int bindex = rgb_blue[cinfo->in_color_space];
+  int pixelsize = rgb_pixelsize[cinfo->in_color_space];
+  JDIMENSION num_cols = cinfo->image_width;
+  JSAMPLE rbuf[16], gbuf[16], bbuf[16], ybuf[16], cbbuf[16], crbuf[16];
+  __m128i zero = _mm_setzero_si128();
+  __m128i mask = _mm_set1_epi32(0xFF);
+  JSAMPROW inptr, outptr0, outptr1, outptr2;
+  JDIMENSION col, count, i;
+
+  while (--num_rows >= 0) {
+    inptr = *input_buf++;
+    outptr0 = output_buf[0][output_row];
+    outptr1 = output_buf[1][output_row];
+    outptr2 = output_buf[2][output_row];
+    output_row++;
+
+    for (col = 0; col < num_cols; col += 16) {
+      __m128i r, g, b, y_lo, y_hi, cb_lo, cb_hi, cr_lo, cr_hi;
+
+      count = num_cols - col;
+      if (count > 16)
+        count = 16;
+
+      if (count == 16 && pixelsize == 4) {
+        /* Deinterleave 4 pixels per register with shifts and masks. */
+        __m128i p0 = _mm_loadu_si128((__m128i *) (inptr + 0));
+        __m128i p1 = _mm_loadu_si128((__m128i *) (inptr + 16));
+        __m128i p2 = _mm_loadu_si128((__m128i *) (inptr + 32));
+        __m128i p3 = _mm_loadu_si128((__m128i *) (inptr + 48));
+        __m128i c01, c23;
+
+#define EXTRACT(v, index) \
+        _mm_and_si128(_mm_srli_epi32((v), 8 * (index)), mask)
+#define CHANNEL(index) \
+        (c01 = _mm_packs_epi32(EXTRACT(p0, index), EXTRACT(p1, index)), \
+         c23 = _mm_packs_epi32(EXTRACT(p2, index), EXTRACT(p3, index)), \
+         _mm_packus_epi16(c01, c23))
+        r = CHANNEL(rindex);
+        g = CHANNEL(gindex);
+        b = CHANNEL(bindex);
+#undef CHANNEL
+#undef EXTRACT
+        inptr += 64;
+      } else {
+        for (i = 0; i < count; i++) {
+          rbuf[i] = inptr[rindex];
+          gbuf[i] = inptr[gindex];
+          bbuf[i] = inptr[bindex];
+          inptr += pixelsize;
+        }
+        r = _mm_loadu_si128((__m128i *) rbuf);
+        g = _mm_loadu_si128((__m128i *) gbuf);
+        b = _mm_loadu_si128((__m128i *) bbuf);
+      }
+
+      rgb_ycc_8(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(g, zero),
+                _mm_unpacklo_epi8(b, zero), &y_lo, &cb_lo, &cr_lo);
+      rgb_ycc_8(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(g, zero),
+                _mm_unpackhi_epi8(b, zero), &y_hi, &cb_hi, &cr_hi);
+
+      if (count == 16) {
+        _mm_storeu_si128((__m128i *) (outptr0 + col),
+                         _mm_packus_epi16(y_lo, y_hi));
+        _mm_storeu_si128((__m128i *) (outptr1 + col),
+                         _mm_packus_epi16(cb_lo, cb_hi));
+        _mm_storeu_si128((__m128i *) (outptr2 + col),
+                         _mm_packus_epi16(cr_lo, cr_hi));
+      } else {
+        _mm_storeu_si128((__m128i *) ybuf, _mm_packus_epi16(y_lo, y_hi));
+        _mm_storeu_si128((__m128i *) cbbuf, _mm_packus_epi16(cb_lo, cb_hi));
+        _mm_storeu_si128((__m128i *) crbuf, _mm_packus_epi16(cr_lo, cr_hi));
+        MEMCOPY(outptr0 + col, ybuf, count);
+        MEMCOPY(outptr1 + col, cbbuf, count);
+        MEMCOPY(outptr2 + col, crbuf, count);
+      }
+    }
+  }
+}
+
+GLOBAL(void)
+jsimd_ycc_rgb_convert (j_decompress_ptr cinfo,
+                       JSAMPIMAGE input_buf, JDIMENSION input_row,
+                       JSAMPARRAY output_buf, int num_rows)
+{
+  int rindex = rgb_red[cinfo->out_color_space];
+  int gindex = rgb_green[cinfo->out_color_space];
+  int bindex = rgb_blue[cinfo->out_color_space];
+  int pixelsize = rgb_pixelsize[cinfo->out_color_space];
+  JDIMENSION num_cols = cinfo->output_width;
+  JSAMPLE ybuf[16], cbbuf[16], crbuf[16], rbuf[16], gbuf[16], bbuf[16];
+  __m128i zero = _mm_setzero_si128();
+  JSAMPROW inptr0, inptr1, inptr2, outptr;
+  JDIMENSION col, count, i;
+
+  while (--num_rows >= 0) {
+    inptr0 = input_buf[0][input_row];
+    inptr1 = input_buf[1][input_row];
+    inptr2 = input_buf[2][input_row];
+    input_row++;
+    outptr = *output_buf++;
+
+    for (col = 0; col < num_cols; col += 16) {
+      __m128i y, cb, cr, r_lo, r_hi, g_lo, g_hi, b_lo, b_hi, r, g, b;
+
+      count = num_cols - col;
+      if (count > 16)
+        count = 16;
+
+      if (count == 16) {
+        y = _mm_loadu_si128((__m128i *) (inptr0 + col));
+        cb = _mm_loadu_si128((__m128i *) (inptr1 + col));
+        cr = _mm_loadu_si128((__m128i *) (inptr2 + col));
+      } else {
+        MEMCOPY(ybuf, inptr0 + col, count);
+        MEMCOPY(cbbuf, inptr1 + col, count);
+        MEMCOPY(crbuf, inptr2 + col, count);
+        y = _mm_loadu_si128((__m128i *) ybuf);
+        cb = _mm_loadu_si128((__m128i *) cbbuf);
+        cr = _mm_loadu_si128((__m128i *) crbuf);
+      }
+
+      ycc_rgb_8(_mm_unpacklo_epi8(y, zero), _mm_unpacklo_epi8(cb, zero),
+                _mm_unpacklo_epi8(cr, zero), &r_lo, &g_lo, &b_lo);
+      ycc_rgb_8(_mm_unpackhi_epi8(y, zero), _mm_unpackhi_epi8(cb, zero),
+                _mm_unpackhi_epi8(cr, zero), &r_hi, &g_hi, &b_hi);
+      r = _mm_packus_epi16(r_lo, r_hi);
+      g = _mm_packus_epi16(g_lo, g_hi);
+      b = _mm_packus_epi16(b_lo, b_hi);
+
+      if (count == 16 && pixelsize == 4) {
+        /* Interleave with an opaque filler byte in the unused slot. */
+        __m128i c[4], c01_lo, c01_hi, c23_lo, c23_hi;
+        int xindex = 6 - rindex - gindex - bindex;
+        c[rindex] = r;
+        c[gindex] = g;
+        c[bindex] = b;
+        c[xindex] = _mm_set1_epi8((char) 0xFF);
+        c01_lo = _mm_unpacklo_epi8(c[0], c[1]);
+        c01_hi = _mm_unpackhi_epi8(c[0], c[1]);
+        c23_lo = _mm_unpacklo_epi8(c[2], c[3]);
+        c23_hi = _mm_unpackhi_epi8(c[2], c[3]);
+        _mm_storeu_si128((__m128i *) (outptr + 0),
+                         _mm_unpacklo_epi16(c01_lo, c23_lo));
+        _mm_storeu_si128((__m128i *) (outptr + 16),
+                         _mm_unpackhi_epi16(c01_lo, c23_lo));
+        _mm_storeu_si128((__m128i *) (outptr + 32),
+                         _mm_unpacklo_epi16(c01_hi, c23_hi));
+        _mm_storeu_si128((__m128i *) (outptr + 48),
+                         _mm_unpackhi_epi16(c01_hi, c23_hi));
+        outptr += 64;
+      } else {
+        _mm_storeu_si128((__m128i *) rbuf, r);
+        _mm_storeu_si128((__m128i *) gbuf, g);
+        _mm_storeu_si128((__m128i *) bbuf, b);
+        for (i = 0; i < count; i++) {
+          outptr[rindex] = rbuf[i];
+          outptr[gindex] = gbuf[i];
+          outptr[bindex] = bbuf[i];
+          outptr += pixelsize;
+        }
+      }
+    }
+  }
+}
+
+
+/**************** Downsampling ****************/
+
+GLOBAL(int)
+jsimd_can_h2v2_downsample (void)
+{
+  return can_sse2();
+}
+
+GLOBAL(int)
+jsimd_can_h2v1_downsample (void)
+{
+  return can_sse2();
+}
+
+/*
+ * Same as expand_right_edge() in jcsample.c.  Once the rows are padded,
+ * output_cols is a multiple of DCTSIZE, so 8 outputs per step never read or
+ * write past the row.
+ */
+
+LOCAL(void)
+expand_right_edge (JSAMPARRAY image_data, int num_rows,
+                   JDIMENSION input_cols, JDIMENSION output_cols)
+{
+  JSAMPROW ptr;
+  JSAMPLE pixval;
+  int count;
+  int row;
+  int numcols = (int) (output_cols - input_cols);
+
+  if (numcols > 0) {
+    for (row = 0; row < num_rows; row++) {
+      ptr = image_data[row] + input_cols;
+      pixval = ptr[-1];
+      for (count = numcols; count > 0; count--)
+        *ptr++ = pixval;
+    }
+  }
+}
+
+GLOBAL(void)
+jsimd_h2v2_downsample (j_compress_ptr cinfo, jpeg_component_info * compptr,
+                       JSAMPARRAY input_data, JSAMPARRAY output_data)
+{
+  JDIMENSION output_cols = compptr->width_in_blocks * DCTSIZE;
+  __m128i mask = _mm_set1_epi16(0xFF);
+  __m128i bias = _mm_set1_epi32(0x00020001);	/* 1,2,1,2,... */
+  JSAMPROW inptr0, inptr1, outptr;
+  JDIMENSION outcol;
+  int inrow, outrow;
+
+  expand_right_edge(input_data, cinfo->max_v_samp_factor,
+                    cinfo->image_width, output_cols * 2);
+
+  inrow = 0;
+  for (outrow = 0; outrow < compptr->v_samp_factor; outrow++) {
+    outptr = output_data[outrow];
+    inptr0 = input_data[inrow];
+    inptr1 = input_data[inrow + 1];
+    for (outcol = 0; outcol < output_cols; outcol += 8) {
+      __m128i a = _mm_loadu_si128((__m128i *) (inptr0 + outcol * 2));
+      __m128i b = _mm_loadu_si128((__m128i *) (inptr1 + outcol * 2));
+      __m128i sum = _mm_add_epi16(
+        _mm_add_epi16(_mm_and_si128(a, mask), _mm_srli_epi16(a, 8)),
+        _mm_add_epi16(_mm_and_si128(b, mask), _mm_srli_epi16(b, 8)));
+      sum = _mm_srli_epi16(_mm_add_epi16(sum, bias), 2);
+      _mm_storel_epi64((__m128i *) (outptr + outcol),
+                       _mm_packus_epi16(sum, sum));
+    }
+    inrow += 2;
+  }
+}
+
+GLOBAL(void)
+jsimd_h2v1_downsample (j_compress_ptr cinfo, jpeg_component_info * compptr,
+                       JSAMPARRAY input_data, JSAMPARRAY output_data)
+{
+  JDIMENSION output_cols = compptr->width_in_blocks * DCTSIZE;
+  __m128i mask = _mm_set1_epi16(0xFF);
+  __m128i bias = _mm_set1_epi32(0x00010000);	/* 0,1,0,1,... */
+  JSAMPROW inptr, outptr;
+  JDIMENSION outcol;
+  int outrow;
+
+  expand_right_edge(input_data, cinfo->max_v_samp_factor,
+                    cinfo->image_width, output_cols * 2);
+
+  for (outrow = 0; outrow < compptr->v_samp_factor; outrow++) {
+    outptr = output_data[outrow];
+    inptr = input_data[outrow];
+    for (outcol = 0; outcol < output_cols; outcol += 8) {
+      __m128i a = _mm_loadu_si128((__m128i *) (inptr + outcol * 2));
+      __m128i sum = _mm_add_epi16(_mm_and_si128(a, mask), _mm_srli_epi16(a, 8));
+      sum = _mm_srli_epi16(_mm_add_epi16(sum, bias), 1);
+      _mm_storel_epi64((__m128i *) (outptr + outcol),
+                       _mm_packus_epi16(sum, sum));
+    }
+  }
+}
+
+
+/**************** Upsampling ****************/
+
+GLOBAL(int)
+jsimd_can_h2v2_upsample (void)
+{
+  return can_sse2();
+}
+
+GLOBAL(int)
+jsimd_can_h2v1_upsample (void)
+{
+  return can_sse2();
+}
+
+/*
+ * Doubles each sample of one row.  16 inputs at a time while a whole
+ * 32-byte output fits in the row, then the C loop for the remainder.
+ */
+
+LOCAL(void)
+h2_upsample_row (JSAMPROW inptr, JSAMPROW outptr, JDIMENSION output_width)
+{
+  JDIMENSION outcol = 0;
+  JSAMPLE invalue;
+
+  for (; outcol + 32 <= output_width; outcol += 32) {
+    __m128i v = _mm_loadu_si128((__m128i *) inptr);
+    _mm_storeu_si128((__m128i *) (outptr + outcol), _mm_unpacklo_epi8(v, v));
+    _mm_storeu_si128((__m128i *) (outptr + outcol + 16),
+                     _mm_unpackhi_epi8(v, v));
+    inptr += 16;
+  }
+  for (; outcol < output_width; outcol += 2) {
+    invalue = *inptr++;
+    outptr[outcol] = invalue;
+    outptr[outcol + 1] = invalue;
+  }
+}
+
+GLOBAL(void)
+jsimd_h2v2_upsample (j_decompress_ptr cinfo,
+                     jpeg_component_info * compptr,
+                     JSAMPARRAY input_data,
+                     JSAMPARRAY * output_data_ptr)
+{
+  JSAMPARRAY output_data = *output_data_ptr;
+  int inrow, outrow;
+
+  inrow = outrow = 0;
+  while (outrow < cinfo->max_v_samp_factor) {
+    h2_upsample_row(input_data[inrow], output_data[outrow],
+                    cinfo->output_width);
+    jcopy_sample_rows(output_data, outrow, output_data, outrow + 1,
+                      1, cinfo->output_width);
+    inrow++;
+    outrow += 2;
+  }
+}
+
+GLOBAL(void)
+jsimd_h2v1_upsample (j_decompress_ptr cinfo,
+                     jpeg_component_info * compptr,
+                     JSAMPARRAY input_data,
+                     JSAMPARRAY * output_data_ptr)
+{
+  JSAMPARRAY output_data = *output_data_ptr;
+  int inrow;
+
+  for (inrow = 0; inrow < cinfo->max_v_samp_factor; inrow++)
+    h2_upsample_row(input_data[inrow], output_data[inrow],
+                    cinfo->output_width);
+}
+
+GLOBAL(int)
+jsimd_can_h2v2_fancy_upsample (void)
+{
+  return can_sse2();
+}
+
+GLOBAL(int)
+jsimd_can_h2v1_fancy_upsample (void)
+{
+  return can_sse2();
+}
+
+/*
+ * The fancy upsamplers triangle-filter each row horizontally, as in
+ * jdsample.c:
+ *   out[2i]   = (3 in[i] + in[i-1] + bias0) >> shift
+ *   out[2i+1] = (3 in[i] + in[i+1] + bias1) >> shift
+ * where for h2v2 |in| is the column sum 3 * nearer + further row.  Columns
+ * 1 through width-2 are done 8 at a time straight from the sample rows; the
+ * two end columns and the remainder use the C formulas.
+ */
+
+/* Widens 8 samples at |ptr| to 16 bits. */
+#define LOAD8(ptr) \
+  _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *) (ptr)), _mm_setzero_si128())
+
+/* Computes 8 output pairs from the 16-bit sums and stores them at |outptr|. */
+
+LOCAL(void)
+fancy_store_16 (__m128i prev, __m128i cur, __m128i next,
+                __m128i bias0, __m128i bias1, __m128i shift,
+                JSAMPROW outptr)
+{
+  __m128i cur3 = _mm_add_epi16(cur, _mm_add_epi16(cur, cur));
+  __m128i even = _mm_srl_epi16(
+    _mm_add_epi16(_mm_add_epi16(cur3, prev), bias0), shift);
+  __m128i odd = _mm_srl_epi16(
+    _mm_add_epi16(_mm_add_epi16(cur3, next), bias1), shift);
+  even = _mm_packus_epi16(even, even);
+  odd = _mm_packus_epi16(odd, odd);
+  _mm_storeu_si128((__m128i *) outptr, _mm_unpacklo_epi8(even, odd));
+}
+
+GLOBAL(void)
+jsimd_h2v2_fancy_upsample (j_decompress_ptr cinfo,
+                           jpeg_component_info * compptr,
+                           JSAMPARRAY input_data,
+                           JSAMPARRAY * output_data_ptr)
+{
+  JSAMPARRAY output_data = *output_data_ptr;
+  JDIMENSION width = compptr->downsampled_width;
+  __m128i bias0 = _mm_set1_epi16(8), bias1 = _mm_set1_epi16(7);
+  __m128i shift = _mm_cvtsi32_si128(4);
+  JSAMPROW inptr0, inptr1, outptr;
+  JDIMENSION col;
+  int thiscolsum, lastcolsum, nextcolsum;
+  int inrow, outrow, v;
+
+  inrow = outrow = 0;
+  while (outrow < cinfo->max_v_samp_factor) {
+    for (v = 0; v < 2; v++) {
+      /* inptr0 points to nearest input row, inptr1 points to next nearest */
+      inptr0 = input_data[inrow];
+      inptr1 = input_data[v == 0 ? inrow - 1 : inrow + 1];
+      outptr = output_data[outrow++];
+
+#define COLSUM(i) \
+      (GETJSAMPLE(inptr0[i]) * 3 + GETJSAMPLE(inptr1[i]))
+#define COLSUM8(i) \
+      _mm_add_epi16(_mm_mullo_epi16(LOAD8(inptr0 + (i)), \
+                                    _mm_set1_epi16(3)), LOAD8(inptr1 + (i)))
+
+      /* Special case for first column */
+      thiscolsum = COLSUM(0);
+      outptr[0] = (JSAMPLE) ((thiscolsum * 4 + 8) >> 4);
+      outptr[1] = (JSAMPLE) ((thiscolsum * 3 + COLSUM(1) + 7) >> 4);
+
+      for (col = 1; col + 9 <= width; col += 8)
+        fancy_store_16(COLSUM8(col - 1), COLSUM8(col), COLSUM8(col + 1),
+                       bias0, bias1, shift, outptr + col * 2);
+
+      for (; col < width - 1; col++) {
+        lastcolsum = COLSUM(col - 1);
+        thiscolsum = COLSUM(col);
+        nextcolsum = COLSUM(col + 1);
+        outptr[col * 2] = (JSAMPLE) ((thiscolsum * 3 + lastcolsum + 8) >> 4);
+        outptr[col * 2 + 1] =
+          (JSAMPLE) ((thiscolsum * 3 + nextcolsum + 7) >> 4);
+      }
+
+      /* Special case for last column */
+      lastcolsum = COLSUM(col - 1);
+      thiscolsum = COLSUM(col);
+      outptr[col * 2] = (JSAMPLE) ((thiscolsum * 3 + lastcolsum + 8) >> 4);
+      outptr[col * 2 + 1] = (JSAMPLE) ((thiscolsum * 4 + 7) >> 4);
+#undef COLSUM8
+#undef COLSUM
+    }
+    inrow++;
+  }
+}
+
+GLOBAL(void)
+jsimd_h2v1_fancy_upsample (j_decompress_ptr cinfo,
+                           jpeg_component_info * compptr,
+                           JSAMPARRAY input_data,
+                           JSAMPARRAY * output_data_ptr)
+{
+  JSAMPARRAY output_data = *output_data_ptr;
+  JDIMENSION width = compptr->downsampled_width;
+  __m128i bias0 = _mm_set1_epi16(1), bias1 = _mm_set1_epi16(2);
+  __m128i shift = _mm_cvtsi32_si128(2);
+  JSAMPROW inptr, outptr;
+  JDIMENSION col;
+  int invalue;
+  int inrow;
+
+  for (inrow = 0; inrow < cinfo->max_v_samp_factor; inrow++) {
+    inptr = input_data[inrow];
+    outptr = output_data[inrow];
+
+    /* Special case for first column */
+    invalue = GETJSAMPLE(inptr[0]);
+    outptr[0] = (JSAMPLE) invalue;
+    outptr[1] = (JSAMPLE) ((invalue * 3 + GETJSAMPLE(inptr[1]) + 2) >> 2);
+
+    for (col = 1; col + 9 <= width; col += 8)
+      fancy_store_16(LOAD8(inptr + col - 1), LOAD8(inptr + col),
+                     LOAD8(inptr + col + 1), bias0, bias1, shift,
+                     outptr + col * 2);
+
+    for (; col < width - 1; col++) {
+      invalue = GETJSAMPLE(inptr[col]) * 3;
+      outptr[col * 2] =
+        (JSAMPLE) ((invalue + GETJSAMPLE(inptr[col - 1]) + 1) >> 2);
+      outptr[col * 2 + 1] =
+        (JSAMPLE) ((invalue + GETJSAMPLE(inptr[col + 1]) + 2) >> 2);
+    }
+
+    /* Special case for last column */
+    invalue = GETJSAMPLE(inptr[col]);
+    outptr[col * 2] =
+      (JSAMPLE) ((invalue * 3 + GETJSAMPLE(inptr[col - 1]) + 1) >> 2);
+    outptr[col * 2 + 1] = (JSAMPLE) invalue;
+  }
+}
+
+#undef LOAD8
+
+GLOBAL(int)
+jsimd_can_h2v2_merged_upsample (void)
+{
+  return 0;
+}
+
+GLOBAL(int)
+jsimd_can_h2v1_merged_upsample (void)
+{
+  return 0;
+}
+
+GLOBAL(void)
+jsimd_h2v2_merged_upsample (j_decompress_ptr cinfo,
+                            JSAMPIMAGE input_buf,
+                            JDIMENSION in_row_group_ctr,
+                            JSAMPARRAY output_buf)
+{
+}
+
+GLOBAL(void)
+jsimd_h2v1_merged_upsample (j_decompress_ptr cinfo,
+                            JSAMPIMAGE input_buf,
+                            JDIMENSION in_row_group_ctr,
+                            JSAMPARRAY output_buf)
+{
+}
+
+
+/**************** Integer DCT ****************/
+
+/*
+ * Both integer DCTs work on 32-bit lanes, four columns (or rows) of the
+ * 8x8 block per register.  Every product in jfdctint.c/jidctint.c has been
+ * distributed so that one multiplicand is a single 16-bit value: pmaddwd of
+ * such a lane (sign bits in the upper half) with the pair (c, 0) is then the
+ * exact 32-bit product, so the results match the C code bit for bit.
+ */
+
+#define CONST_BITS  13
+#define PASS1_BITS  2
+
+#define FIX_0_298631336  2446
+#define FIX_0_390180644  3196
+#define FIX_0_541196100  4433
+#define FIX_0_765366865  6270
+#define FIX_0_899976223  7373
+#define FIX_1_175875602  9633
+#define FIX_1_501321110  12299
+#define FIX_1_847759065  15137
+#define FIX_1_961570560  16069
+#define FIX_2_053119869  16819
+#define FIX_2_562915447  20995
+#define FIX_3_072711026  25172
+
+#define MUL(x, c)  _mm_madd_epi16((x), _mm_set1_epi32((c) & 0xFFFF))
+
+LOCAL(__m128i)
+descale (__m128i x, int n)
+{
+  return _mm_sra_epi32(_mm_add_epi32(x, _mm_set1_epi32(1 << (n - 1))),
+                       _mm_cvtsi32_si128(n));
+}
+
+/* Transposes the 8x8 block held as lo[row] (columns 0-3), hi[row] (4-7). */
+
+LOCAL(void)
+transpose_4x4 (__m128i * r0, __m128i * r1, __m128i * r2, __m128i * r3)
+{
+  __m128i t0 = _mm_unpacklo_epi32(*r0, *r1);
+  __m128i t1 = _mm_unpacklo_epi32(*r2, *r3);
+  __m128i t2 = _mm_unpackhi_epi32(*r0, *r1);
+  __m128i t3 = _mm_unpackhi_epi32(*r2, *r3);
+  *r0 = _mm_unpacklo_epi64(t0, t1);
+  *r1 = _mm_unpackhi_epi64(t0, t1);
+  *r2 = _mm_unpacklo_epi64(t2, t3);
+  *r3 = _mm_unpackhi_epi64(t2, t3);
+}
+
+LOCAL(void)
+transpose_8x8 (__m128i lo[8], __m128i hi[8])
+{
+  __m128i t;
+  int i;
+
+  transpose_4x4(&lo[0], &lo[1], &lo[2], &lo[3]);
+  transpose_4x4(&hi[0], &hi[1], &hi[2], &hi[3]);
+  transpose_4x4(&lo[4], &lo[5], &lo[6], &lo[7]);
+  transpose_4x4(&hi[4], &hi[5], &hi[6], &hi[7]);
+  for (i = 0; i < 4; i++) {
+    t = hi[i];
+    hi[i] = lo[i + 4];
+    lo[i + 4] = t;
+  }
+}
+
+/*
+ * The odd part shared by both DCTs.  With (a, b, c, d) being tmp4..tmp7 of
+ * the forward DCT or y7, y5, y3, y1 of the inverse, this returns what the C
+ * code calls tmp4 + z1 + z3, tmp5 + z2 + z4, tmp6 + z2 + z3 and
+ * tmp7 + z1 + z4.
+ */
+
+LOCAL(void)
+islow_odd (__m128i a, __m128i b, __m128i c, __m128i d, __m128i out[4])
+{
+  __m128i ma = MUL(a, FIX_1_175875602);
+  __m128i mb = MUL(b, FIX_1_175875602);
+  __m128i mc = MUL(c, FIX_1_175875602);
+  __m128i md = MUL(d, FIX_1_175875602);
+
+  out[0] = _mm_add_epi32(
+    _mm_add_epi32(MUL(a, FIX_0_298631336 - FIX_0_899976223 -
+                      FIX_1_961570560 + FIX_1_175875602), mb),
+    _mm_add_epi32(MUL(c, FIX_1_175875602 - FIX_1_961570560),
+                  MUL(d, FIX_1_175875602 - FIX_0_899976223)));
+  out[1] = _mm_add_epi32(
+    _mm_add_epi32(ma, MUL(b, FIX_2_053119869 - FIX_2_562915447 -
+                          FIX_0_390180644 + FIX_1_175875602)),
+    _mm_add_epi32(MUL(c, FIX_1_175875602 - FIX_2_562915447),
+                  MUL(d, FIX_1_175875602 - FIX_0_390180644)));
+  out[2] = _mm_add_epi32(
+    _mm_add_epi32(MUL(a, FIX_1_175875602 - FIX_1_961570560),
+                  MUL(b, FIX_1_175875602 - FIX_2_562915447)),
+    _mm_add_epi32(MUL(c, FIX_3_072711026 - FIX_2_562915447 -
+                      FIX_1_961570560 + FIX_1_175875602), md));
+  out[3] = _mm_add_epi32(
+    _mm_add_epi32(MUL(a, FIX_1_175875602 - FIX_0_899976223),
+                  MUL(b, FIX_1_175875602 - FIX_0_390180644)),
+    _mm_add_epi32(mc, MUL(d, FIX_1_501321110 - FIX_0_899976223 -
+                          FIX_0_390180644 + FIX_1_175875602)));
+}
+
+/*
+ * One forward pass over 4 lanes; v[k] holds input k.  In the first pass the
+ * DC and Nyquist terms are scaled up by PASS1_BITS, in the second they are
+ * descaled by it.
+ */
+
+LOCAL(void)
+fdct_islow_1d (__m128i v[8], int pass)
+{
+  __m128i tmp0 = _mm_add_epi32(v[0], v[7]);
+  __m128i tmp7 = _mm_sub_epi32(v[0], v[7]);
+  __m128i tmp1 = _mm_add_epi32(v[1], v[6]);
+  __m128i tmp6 = _mm_sub_epi32(v[1], v[6]);
+  __m128i tmp2 = _mm_add_epi32(v[2], v[5]);
+  __m128i tmp5 = _mm_sub_epi32(v[2], v[5]);
+  __m128i tmp3 = _mm_add_epi32(v[3], v[4]);
+  __m128i tmp4 = _mm_sub_epi32(v[3], v[4]);
+  __m128i tmp10 = _mm_add_epi32(tmp0, tmp3);
+  __m128i tmp13 = _mm_sub_epi32(tmp0, tmp3);
+  __m128i tmp11 = _mm_add_epi32(tmp1, tmp2);
+  __m128i tmp12 = _mm_sub_epi32(tmp1, tmp2);
+  int shift = (pass == 1) ? CONST_BITS - PASS1_BITS : CONST_BITS + PASS1_BITS;
+  __m128i odd[4];
+
+  if (pass == 1) {
+    v[0] = _mm_slli_epi32(_mm_add_epi32(tmp10, tmp11), PASS1_BITS);
+    v[4] = _mm_slli_epi32(_mm_sub_epi32(tmp10, tmp11), PASS1_BITS);
+  } else {
+    v[0] = descale(_mm_add_epi32(tmp10, tmp11), PASS1_BITS);
+    v[4] = descale(_mm_sub_epi32(tmp10, tmp11), PASS1_BITS);
+  }
+
+  v[2] = descale(_mm_add_epi32(MUL(tmp12, FIX_0_541196100),
+                   MUL(tmp13, FIX_0_541196100 + FIX_0_765366865)), shift);
+  v[6] = descale(_mm_add_epi32(MUL(tmp12, FIX_0_541196100 - FIX_1_847759065),
+                   MUL(tmp13, FIX_0_541196100)), shift);
+
+  islow_odd(tmp4, tmp5, tmp6, tmp7, odd);
+  v[7] = descale(odd[0], shift);
+  v[5] = descale(odd[1], shift);
+  v[3] = descale(odd[2], shift);
+  v[1] = descale(odd[3], shift);
+}
+
+/* One inverse pass over 4 lanes; v[k] holds input k. */
+
+LOCAL(void)
+idct_islow_1d (__m128i v[8], int shift)
+{
+  __m128i tmp0 = _mm_slli_epi32(_mm_add_epi32(v[0], v[4]), CONST_BITS);
+  __m128i tmp1 = _mm_slli_epi32(_mm_sub_epi32(v[0], v[4]), CONST_BITS);
+  __m128i tmp2 = _mm_add_epi32(MUL(v[2], FIX_0_541196100),
+                   MUL(v[6], FIX_0_541196100 - FIX_1_847759065));
+  __m128i tmp3 = _mm_add_epi32(MUL(v[2], FIX_0_541196100 + FIX_0_765366865),
+                   MUL(v[6], FIX_0_541196100));
+  __m128i tmp10 = _mm_add_epi32(tmp0, tmp3);
+  __m128i tmp13 = _mm_sub_epi32(tmp0, tmp3);
+  __m128i tmp11 = _mm_add_epi32(tmp1, tmp2);
+  __m128i tmp12 = _mm_sub_epi32(tmp1, tmp2);
+  __m128i odd[4];
+
+  islow_odd(v[7], v[5], v[3], v[1], odd);
+  v[0] = descale(_mm_add_epi32(tmp10, odd[3]), shift);
+  v[7] = descale(_mm_sub_epi32(tmp10, odd[3]), shift);
+  v[1] = descale(_mm_add_epi32(tmp11, odd[2]), shift);
+  v[6] = descale(_mm_sub_epi32(tmp11, odd[2]), shift);
+  v[2] = descale(_mm_add_epi32(tmp12, odd[1]), shift);
+  v[5] = descale(_mm_sub_epi32(tmp12, odd[1]), shift);
+  v[3] = descale(_mm_add_epi32(tmp13, odd[0]), shift);
+  v[4] = descale(_mm_sub_epi32(tmp13, odd[0]), shift);
+}
+
+/* Nonzero if every lane of lo[] and hi[] fits in 16 bits. */
+
+LOCAL(int)
+fits_16 (const __m128i lo[8], const __m128i hi[8])
+{
+  __m128i bad = _mm_setzero_si128();
+  int i;
+
+  for (i = 0; i < 8; i++) {
+    bad = _mm_or_si128(bad, _mm_xor_si128(lo[i],
+            _mm_srai_epi32(_mm_slli_epi32(lo[i], 16), 16)));
+    bad = _mm_or_si128(bad, _mm_xor_si128(hi[i],
+            _mm_srai_epi32(_mm_slli_epi32(hi[i], 16), 16)));
+  }
+  return _mm_movemask_epi8(_mm_cmpeq_epi32(bad, _mm_setzero_si128())) ==
+         0xFFFF;
+}
+
+/* Loads 8 16- or 32-bit values, whichever |size| says, as 32-bit lanes. */
+
+LOCAL(void)
+load_row_32 (const void * src, size_t size, __m128i * lo, __m128i * hi)
+{
+  if (size == 4) {
+    *lo = _mm_loadu_si128((const __m128i *) src);
+    *hi = _mm_loadu_si128((const __m128i *) src + 1);
+  } else {
+    __m128i v = _mm_loadu_si128((const __m128i *) src);
+    *lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+    *hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+  }
+}
+
+GLOBAL(int)
+jsimd_can_convsamp (void)
+{
+  return 0;
+}
+
+GLOBAL(int)
+jsimd_can_convsamp_float (void)
+{
+  return 0;
+}
+
+GLOBAL(void)
+jsimd_convsamp (JSAMPARRAY sample_data, JDIMENSION start_col,
+                DCTELEM * workspace)
+{
+}
+
+GLOBAL(void)
+jsimd_convsamp_float (JSAMPARRAY sample_data, JDIMENSION start_col,
+                      FAST_FLOAT * workspace)
+{
+}
+
+GLOBAL(int)
+jsimd_can_fdct_islow (void)
+{
+  if (DCTSIZE != 8)
+    return 0;
+  if (sizeof(DCTELEM) != 2 && sizeof(DCTELEM) != 4)
+    return 0;
+
+  return can_sse2();
+}
+
+GLOBAL(int)
+jsimd_can_fdct_ifast (void)
+{
+  return 0;
+}
+
+GLOBAL(int)
+jsimd_can_fdct_float (void)
+{
+  return 0;
+}
+
+GLOBAL(void)
+jsimd_fdct_islow (DCTELEM * data)
+{
+  __m128i lo[8], hi[8];
+  int i;
+
+  for (i = 0; i < DCTSIZE; i++)
+    load_row_32(data + i * DCTSIZE, sizeof(DCTELEM), &lo[i], &hi[i]);
+
+  /* Pass 1: rows.  Transpose so that each lane is one row. */
+  transpose_8x8(lo, hi);
+  fdct_islow_1d(lo, 1);
+  fdct_islow_1d(hi, 1);
+
+  /* Pass 2: columns. */
+  transpose_8x8(lo, hi);
+  fdct_islow_1d(lo, 2);
+  fdct_islow_1d(hi, 2);
+
+  for (i = 0; i < DCTSIZE; i++) {
+    if (sizeof(DCTELEM) == 4) {
+      _mm_storeu_si128((__m128i *) (data + i * DCTSIZE), lo[i]);
+      _mm_storeu_si128((__m128i *) (data + i * DCTSIZE) + 1, hi[i]);
+    } else {
+      _mm_storeu_si128((__m128i *) (data + i * DCTSIZE),
+                       _mm_packs_epi32(lo[i], hi[i]));
+    }
+  }
+}
+
+GLOBAL(void)
+jsimd_fdct_ifast (DCTELEM * data)
+{
+}
+
+GLOBAL(void)
+jsimd_fdct_float (FAST_FLOAT * data)
+{
+}
+
+GLOBAL(int)
+jsimd_can_quantize (void)
+{
+  return 0;
+}
+
+GLOBAL(int)
+jsimd_can_quantize_float (void)
+{
+  return 0;
+}
+
+GLOBAL(void)
+jsimd_quantize (JCOEFPTR coef_block, DCTELEM * divisors,
+                DCTELEM * workspace)
+{
+}
+
+GLOBAL(void)
+jsimd_quantize_float (JCOEFPTR coef_block, FAST_FLOAT * divisors,
+                      FAST_FLOAT * workspace)
+{
+}
+
+GLOBAL(int)
+jsimd_can_idct_2x2 (void)
+{
+  return 0;
+}
+
+GLOBAL(int)
+jsimd_can_idct_4x4 (void)
+{
+  return 0;
+}
+
+GLOBAL(void)
+jsimd_idct_2x2 (j_decompress_ptr cinfo, jpeg_component_info * compptr,
+                JCOEFPTR coef_block, JSAMPARRAY output_buf,
+                JDIMENSION output_col)
+{
+}
+
+GLOBAL(void)
+jsimd_idct_4x4 (j_decompress_ptr cinfo, jpeg_component_info * compptr,
+                JCOEFPTR coef_block, JSAMPARRAY output_buf,
+                JDIMENSION output_col)
+{
+}
+
+GLOBAL(int)
+jsimd_can_idct_islow (void)
+{
+  if (DCTSIZE != 8)
+    return 0;
+  if (sizeof(JCOEF) != 2)
+    return 0;
+  if (sizeof(ISLOW_MULT_TYPE) != 2 && sizeof(ISLOW_MULT_TYPE) != 4)
+    return 0;
+
+  return can_sse2();
+}
+
+GLOBAL(int)
+jsimd_can_idct_ifast (void)
+{
+  return 0;
+}
+
+GLOBAL(int)
+jsimd_can_idct_float (void)
+{
+  return 0;
+}
+
+GLOBAL(void)
+jsimd_idct_islow (j_decompress_ptr cinfo, jpeg_component_info * compptr,
+                JCOEFPTR coef_block, JSAMPARRAY output_buf,
+                JDIMENSION output_col)
+{
+  ISLOW_MULT_TYPE * quantptr = (ISLOW_MULT_TYPE *) compptr->dct_table;
+  __m128i lo[8], hi[8], q_lo, q_hi, row;
+  __m128i qbits = _mm_setzero_si128();
+  __m128i center = _mm_set1_epi16(CENTERJSAMPLE);
+  JSAMPROW outptr;
+  int i;
+
+  /* Dequantize.  The products are exact as long as the quantization values
+   * fit in 15 bits, which holds for all 8-bit tables. */
+  for (i = 0; i < DCTSIZE; i++) {
+    load_row_32(coef_block + i * DCTSIZE, sizeof(JCOEF), &lo[i], &hi[i]);
+    load_row_32(quantptr + i * DCTSIZE, sizeof(ISLOW_MULT_TYPE),
+                &q_lo, &q_hi);
+    qbits = _mm_or_si128(qbits, _mm_or_si128(q_lo, q_hi));
+    lo[i] = _mm_madd_epi16(lo[i], q_lo);
+    hi[i] = _mm_madd_epi16(hi[i], q_hi);
+  }
+  qbits = _mm_srli_epi32(qbits, 15);
+  if (_mm_movemask_epi8(_mm_cmpeq_epi32(qbits, _mm_setzero_si128())) !=
+      0xFFFF || !fits_16(lo, hi)) {
+    jpeg_idct_islow(cinfo, compptr, coef_block, output_buf, output_col);
+    return;
+  }
+
+  /* Pass 1: columns. */
+  idct_islow_1d(lo, CONST_BITS - PASS1_BITS);
+  idct_islow_1d(hi, CONST_BITS - PASS1_BITS);
+  if (!fits_16(lo, hi)) {
+    jpeg_idct_islow(cinfo, compptr, coef_block, output_buf, output_col);
+    return;
+  }
+
+  /* Pass 2: rows. */
+  transpose_8x8(lo, hi);
+  idct_islow_1d(lo, CONST_BITS + PASS1_BITS + 3);
+  idct_islow_1d(hi, CONST_BITS + PASS1_BITS + 3);
+  transpose_8x8(lo, hi);
+
+  for (i = 0; i < DCTSIZE; i++) {
+    outptr = output_buf[i] + output_col;
+    row = _mm_adds_epi16(_mm_packs_epi32(lo[i], hi[i]), center);
+    _mm_storel_epi64((__m128i *) outptr, _mm_packus_epi16(row, row));
+  }
+}
+
+GLOBAL(void)
+jsimd_idct_ifast (j_decompress_ptr cinfo, jpeg_component_info * compptr,
+                JCOEFPTR coef_block, JSAMPARRAY output_buf,
+                JDIMENSION output_col)
+{
+}
+
+GLOBAL(void)
+jsimd_idct_float (j_decompress_ptr cinfo, jpeg_component_info * compptr,
+                JCOEFPTR coef_block, JSAMPARRAY output_buf,
+                JDIMENSION output_col)
+{
+}
@@ -7,6 +7,7 @@
 
 #define ZLIB_INTERNAL
 #include "zlib.h"
+#include "x86.h"
 
 #define BASE 65521UL    /* largest prime smaller than 65536 */
 #define NMAX 5552
@@ -81,6 +82,12 @@ uLong ZEXPORT adler32(adler, buf, len)
     if (buf == Z_NULL)
         return 1L;
 
+#ifdef X86_SIMD
+    /* the vector code needs a couple of blocks to pay off */
+    if (len >= 64 && (x86_cpu_features() & X86_CPU_SSSE3))
+        return adler32_ssse3(adler | (sum2 << 16), buf, len);
+#endif
+
     /* in case short lengths are provided, keep it somewhat fast */
     if (len < 16) {
         while (len--) {
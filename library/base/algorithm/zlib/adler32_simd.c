@@ -0,0 +1,87 @@
+/* adler32_simd.c -- compute the Adler-32 checksum of a data stream with SSSE3
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * Every 32-byte block adds its bytes to s1 (psadbw) and its bytes weighted
+ * 32, 31, ..., 1 to s2 (pmaddubsw). The 32 * s1 term that each block adds to
+ * s2 is accumulated separately and applied once per NMAX bytes, when both
+ * sums are reduced modulo BASE like the C code does.
+ */
+
+#include "x86.h"
+
+#ifdef X86_SIMD
+
+#include <tmmintrin.h>
+
+#define BASE 65521UL    /* largest prime smaller than 65536 */
+#define NMAX 5552
+/* NMAX is the largest n such that 255n(n+1)/2 + (n+1)(BASE-1) <= 2^32-1 */
+
+#define BLOCK_SIZE 32
+
+X86_TARGET("ssse3")
+uLong adler32_ssse3(adler, buf, len)
+    uLong adler;
+    const Bytef *buf;
+    uInt len;
+{
+    unsigned long s1 = adler & 0xffff;
+    unsigned long s2 = (adler >> 16) & 0xffff;
+    unsigned blocks = len / BLOCK_SIZE;
+    const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                                       24, 23, 22, 21, 20, 19, 18, 17);
+    const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9,
+                                       8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+
+    len -= blocks * BLOCK_SIZE;
+    while (blocks) {
+        unsigned n = NMAX / BLOCK_SIZE;
+        __m128i v_ps, v_s1, v_s2;
+        if (n > blocks)
+            n = blocks;
+        blocks -= n;
+
+        /* v_ps collects s1 before each block; every block adds 32 * s1 to s2. */
+        v_ps = _mm_cvtsi32_si128((int)(s1 * n));
+        v_s1 = zero;
+        v_s2 = _mm_cvtsi32_si128((int)s2);
+        do {
+            const __m128i bytes1 = _mm_loadu_si128((const __m128i *)buf);
+            const __m128i bytes2 = _mm_loadu_si128((const __m128i *)(buf + 16));
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+            v_s2 = _mm_add_epi32(v_s2,
+                _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+            v_s2 = _mm_add_epi32(v_s2,
+                _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+            buf += BLOCK_SIZE;
+        } while (--n);
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+        /* Horizontal sums of the four 32-bit lanes. */
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += (unsigned long)(unsigned int)_mm_cvtsi128_si32(v_s1);
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = (unsigned long)(unsigned int)_mm_cvtsi128_si32(v_s2);
+
+        s1 %= BASE;
+        s2 %= BASE;
+    }
+
+    /* Fewer than 32 bytes left. */
+    while (len--) {
+        s1 += *buf++;
+        s2 += s1;
+    }
+    s1 %= BASE;
+    s2 %= BASE;
+
+    return s1 | (s2 << 16);
+}
+
+#endif /* X86_SIMD */
@@ -27,6 +27,7 @@
 #endif /* MAKECRCH */
 
 #include "zutil.h"      /* for STDC and FAR definitions */
+#include "x86.h"
 
 #define local static
 
@@ -228,6 +229,18 @@ unsigned long ZEXPORT crc32(crc, buf, len)
         make_crc_table();
 #endif /* DYNAMIC_CRC_TABLE */
 
+#ifdef X86_SIMD
+    /* fold whole 16-byte blocks with PCLMULQDQ, the tail goes on below */
+    if (len >= 64 && (x86_cpu_features() & X86_CPU_PCLMUL)) {
+        unsigned chunk = len & ~15U;
+        crc = crc32_pclmul(crc ^ 0xffffffffUL, buf, chunk) ^ 0xffffffffUL;
+        buf += chunk;
+        len -= chunk;
+        if (len == 0)
+            return crc;
+    }
+#endif /* X86_SIMD */
+
 #ifdef BYFOUR
     if (sizeof(void *) == sizeof(ptrdiff_t)) {
         u4 endian;
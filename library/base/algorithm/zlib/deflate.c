@@ -50,6 +50,7 @@
 /* @(#) $Id: deflate.c,v 3.6 2005/08/04 19:14:14 tor%cs.brown.edu Exp $ */
 
 #include "deflate.h"
+#include "x86.h"
 
 const char deflate_copyright[] =
    " deflate 1.2.3 Copyright 1995-2005 Jean-loup Gailly ";
@@ -1010,6 +1011,50 @@ local void lm_init (s)
 #endif
 }
 
+#ifdef X86_SIMD
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
+
+/* ===========================================================================
+ * Match length between two strings, 16 bytes at a time. scan and match point
+ * two bytes into the strings, as in the byte loops of longest_match() and
+ * longest_match_fast(), and the result is the same as theirs: the offset of
+ * the first difference after the third byte, or MAX_MATCH. Like those loops
+ * this reads MAX_MATCH bytes of each string, which the window always holds.
+ */
+local int compare258_sse2 OF((const Bytef *scan, const Bytef *match));
+
+X86_TARGET("sse2")
+local int compare258_sse2(scan, match)
+    const Bytef *scan;
+    const Bytef *match;
+{
+    unsigned long index;
+    unsigned mask;
+    int i;
+
+    for (i = 0; i < MAX_MATCH - 2; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(scan + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(match + i));
+        mask = ~(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) & 0xffff;
+        /* scan[2] == match[2] follows from the hash; it is never compared */
+        if (i == 0)
+            mask &= ~1U;
+        if (mask) {
+#ifdef _MSC_VER
+            _BitScanForward(&index, mask);
+#else
+            index = (unsigned long)__builtin_ctz(mask);
+#endif
+            return 2 + i + (int)index;
+        }
+    }
+    return MAX_MATCH;
+}
+#endif /* X86_SIMD */
+
 #ifndef FASTEST
 /* ===========================================================================
  * Set match_start to the longest match starting at the given string and
@@ -1041,6 +1086,9 @@ local uInt longest_match(s, cur_match)
      */
     Posf *prev = s->prev;
     uInt wmask = s->w_mask;
+#ifdef X86_SIMD
+    int use_sse2 = x86_cpu_features() & X86_CPU_SSE2;
+#endif
 
 #ifdef UNALIGNED_OK
     /* Compare two bytes at a time. Note: this is not always beneficial.
@@ -1132,20 +1180,28 @@ local uInt longest_match(s, cur_match)
         scan += 2, match++;
         Assert(*scan == *match, "match[2]?");
 
-        /* We check for insufficient lookahead only every 8th comparison;
-         * the 256th check will be made at strstart+258.
-         */
-        do {
-        } while (*++scan == *++match && *++scan == *++match &&
-                 *++scan == *++match && *++scan == *++match &&
-                 *++scan == *++match && *++scan == *++match &&
-                 *++scan == *++match && *++scan == *++match &&
-                 scan < strend);
+#ifdef X86_SIMD
+        if (use_sse2) {
+            len = compare258_sse2(scan, match);
+            scan -= 2;
+        } else
+#endif
+        {
+            /* We check for insufficient lookahead only every 8th comparison;
+             * the 256th check will be made at strstart+258.
+             */
+            do {
+            } while (*++scan == *++match && *++scan == *++match &&
+                     *++scan == *++match && *++scan == *++match &&
+                     *++scan == *++match && *++scan == *++match &&
+                     *++scan == *++match && *++scan == *++match &&
+                     scan < strend);
 
-        Assert(scan <= s->window+(unsigned)(s->window_size-1), "wild scan");
+            Assert(scan <= s->window+(unsigned)(s->window_size-1), "wild scan");
 
-        len = MAX_MATCH - (int)(strend - scan);
-        scan = strend - MAX_MATCH;
+            len = MAX_MATCH - (int)(strend - scan);
+            scan = strend - MAX_MATCH;
+        }
 
 #endif /* UNALIGNED_OK */
 
@@ -1205,19 +1261,26 @@ local uInt longest_match_fast(s, cur_match)
     scan += 2, match += 2;
     Assert(*scan == *match, "match[2]?");
 
-    /* We check for insufficient lookahead only every 8th comparison;
-     * the 256th check will be made at strstart+258.
-     */
-    do {
-    } while (*++scan == *++match && *++scan == *++match &&
-             *++scan == *++match && *++scan == *++match &&
-             *++scan == *++match && *++scan == *++match &&
-             *++scan == *++match && *++scan == *++match &&
-             scan < strend);
+#ifdef X86_SIMD
+    if (x86_cpu_features() & X86_CPU_SSE2) {
+        len = compare258_sse2(scan, match);
+    } else
+#endif
+    {
+        /* We check for insufficient lookahead only every 8th comparison;
+         * the 256th check will be made at strstart+258.
+         */
+        do {
+        } while (*++scan == *++match && *++scan == *++match &&
+                 *++scan == *++match && *++scan == *++match &&
+                 *++scan == *++match && *++scan == *++match &&
+                 *++scan == *++match && *++scan == *++match &&
+                 scan < strend);
 
-    Assert(scan <= s->window+(unsigned)(s->window_size-1), "wild scan");
+        Assert(scan <= s->window+(unsigned)(s->window_size-1), "wild scan");
 
-    len = MAX_MATCH - (int)(strend - scan);
+        len = MAX_MATCH - (int)(strend - scan);
+    }
 
     if (len < MIN_MATCH) return MIN_MATCH - 1;
 
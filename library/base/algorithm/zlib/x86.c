@@ -0,0 +1,54 @@
+/* x86.c -- runtime detection of x86 SIMD extensions
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "x86.h"
+
+#ifdef X86_SIMD
+
+#ifdef _MSC_VER
+#  include <intrin.h>
+#else
+#  include <cpuid.h>
+#endif
+
+local volatile int cpu_features = -1;
+
+local int detect_cpu_features OF((void));
+
+local int detect_cpu_features()
+{
+    unsigned int regs[4] = { 0, 0, 0, 0 };
+    int features = 0;
+
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 1) {
+        __cpuid(info, 1);
+        regs[2] = (unsigned int)info[2];
+        regs[3] = (unsigned int)info[3];
+    }
+#else
+    if (!__get_cpuid(1, &regs[0], &regs[1], &regs[2], &regs[3]))
+        return 0;
+#endif
+
+    if (regs[3] & (1 << 26))
+        features |= X86_CPU_SSE2;
+    if (regs[2] & (1 << 9))
+        features |= X86_CPU_SSSE3;
+    if ((regs[2] & (1 << 1)) && (features & X86_CPU_SSE2))
+        features |= X86_CPU_PCLMUL;
+    return features;
+}
+
+/* The first callers may race here, but they all store the same value. */
+int x86_cpu_features()
+{
+    if (cpu_features < 0)
+        cpu_features = detect_cpu_features();
+    return cpu_features;
+}
+
+#endif /* X86_SIMD */
@@ -0,0 +1,52 @@
+/* x86.h -- runtime detection of x86 SIMD extensions
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+/* WARNING: this file should *not* be used by applications. It is
+   part of the implementation of the compression library and is
+   subject to change. Applications should only use zlib.h.
+ */
+
+#ifndef X86_H
+#define X86_H
+
+#include "zutil.h"
+
+/* Define NO_X86_SIMD to build the portable C code only. */
+#if !defined(NO_X86_SIMD) && \
+    (defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || \
+     defined(__x86_64__))
+#  define X86_SIMD
+#endif
+
+#ifdef X86_SIMD
+
+/* gcc only emits SSSE3/PCLMUL instructions for functions that ask for them;
+ * MSVC accepts the intrinsics anywhere.
+ */
+#ifdef __GNUC__
+#  define X86_TARGET(x) __attribute__((target(x)))
+#else
+#  define X86_TARGET(x)
+#endif
+
+#define X86_CPU_SSE2    0x01
+#define X86_CPU_SSSE3   0x02
+#define X86_CPU_PCLMUL  0x04
+
+/* Returns the X86_CPU_* bits supported by the running processor. */
+int x86_cpu_features OF((void));
+
+/* Adler-32 of len >= 32 bytes using SSSE3. */
+uLong adler32_ssse3 OF((uLong adler, const Bytef *buf, uInt len));
+
+/* CRC-32 of len >= 64 bytes, len a multiple of 16, by PCLMULQDQ folding.
+ * crc is the pre- and post-conditioned register, i.e. crc32()'s value
+ * xor'ed with 0xffffffff.
+ */
+unsigned long crc32_pclmul OF((unsigned long crc, const unsigned char *buf,
+                               unsigned len));
+
+#endif /* X86_SIMD */
+
+#endif /* X86_H */
@@ -0,0 +1,64 @@
+#include "worker_pool.h"
+
+#include <windows.h>
+
+#include "base/logging.h"
+#include "base/task.h"
+
+namespace base
+{
+
+    namespace
+    {
+
+        // ClosureװTask, ύʽһ̳߳ػص.
+        class ClosureTask : public Task
+        {
+        public:
+            explicit ClosureTask(const Closure& closure) : closure_(closure) {}
+
+            virtual void Run()
+            {
+                closure_.Run();
+            }
+
+        private:
+            Closure closure_;
+        };
+
+        DWORD CALLBACK WorkItemCallback(void* param)
+        {
+            Task* task = static_cast<Task*>(param);
+            task->Run();
+            delete task;
+            return 0;
+        }
+
+    }
+
+    // static
+    bool WorkerPool::PostTask(Task* task, bool task_is_slow)
+    {
+        ULONG flags = 0;
+        if(task_is_slow)
+        {
+            flags |= WT_EXECUTELONGFUNCTION;
+        }
+
+        if(!QueueUserWorkItem(WorkItemCallback, task, flags))
+        {
+            DLOG(ERROR) << "QueueUserWorkItem failed: " << GetLastError();
+            delete task;
+            return false;
+        }
+
+        return true;
+    }
+
+    // static
+    bool WorkerPool::PostTask(const Closure& task, bool task_is_slow)
+    {
+        return PostTask(new ClosureTask(task), task_is_slow);
+    }
+
+} //namespace base
@@ -0,0 +1,29 @@
+
+#ifndef __base_worker_pool_h__
+#define __base_worker_pool_h__
+
+#pragma once
+
+#include "base/callback.h"
+
+class Task;
+
+namespace base
+{
+
+    // ̳߳, ִвҪض߳еĺ̨. ײʹϵͳ̳߳
+    // (QueueUserWorkItem), ûа취ȴȡѾύ, Ҫȴ
+    // ԼʹWaitableEvent֮ͬ.
+    class WorkerPool
+    {
+    public:
+        // ύ̳߳첽ִ, ִɺɾ.
+        // |task_is_slow|ʾнϳʱ, ϵͳ̳߳ػΪ䴴߳.
+        // ύʧʱfalse, ᱻɾ.
+        static bool PostTask(Task* task, bool task_is_slow);
+        static bool PostTask(const Closure& task, bool task_is_slow);
+    };
+
+} //namespace base
+
+#endif //__base_worker_pool_h__
@@ -106,10 +106,11 @@ public:
         kLCDRenderText_Flag   = 0x200,  //!< mask to enable subpixel glyph renderering
         kEmbeddedBitmapText_Flag = 0x400, //!< mask to enable embedded bitmap strikes
         kAutoHinting_Flag     = 0x800,  //!< mask to force Freetype's autohinter
+        kCoverageAA_Flag      = 0x1000, //!< mask to enable coverage-accumulating AA path fills
         // when adding extra flags, note that the fFlags member is specified
         // with a bit-width and you'll have to expand it.
 
-        kAllFlags = 0xFFF
+        kAllFlags = 0x1FFF
     };
 
     /** Return the paint's flags. Use the Flag enum to test flag values.
@@ -203,6 +204,23 @@ public:
     */
     void setAutohinted(bool useAutohinter);
 
+    /** Helper for getFlags(), returning true if kCoverageAA_Flag bit is set
+        @return true if antialiased path fills use the coverage accumulator
+    */
+    bool isCoverageAA() const {
+        return SkToBool(this->getFlags() & kCoverageAA_Flag);
+    }
+
+    /** Helper for setFlags(), setting or clearing the kCoverageAA_Flag bit.
+        Antialiased path fills then accumulate the supersampled coverage of
+        each scanline in a sparse buffer (see SkScan::AntiFillPathCoverage),
+        which is faster for complex paths but may differ from the default
+        rasterizer by a few levels of alpha along the edges.
+        @param useCoverageAA true to set the kCoverageAA bit in the paint's
+                             flags, false to clear it.
+    */
+    void setCoverageAA(bool useCoverageAA);
+
     /** Helper for getFlags(), returning true if kUnderlineText_Flag bit is set
         @return true if the underlineText bit is set in the paint's flags.
     */
@@ -839,7 +857,7 @@ private:
     SkColor         fColor;
     SkScalar        fWidth;
     SkScalar        fMiterLimit;
-    unsigned        fFlags : 12;
+    unsigned        fFlags : 13;
     unsigned        fTextAlign : 2;
     unsigned        fCapType : 2;
     unsigned        fJoinType : 2;
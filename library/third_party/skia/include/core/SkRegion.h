@@ -33,6 +33,11 @@ namespace android {
 
     The SkRegion class encapsulates the geometric region used to specify
     clipping areas for drawing.
+
+    A region is empty, a single rectangle, or complex. Complex regions store
+    their scanlines as runs; runs that fit in kInlineRunCount values (a
+    handful of rectangles) live inside the region itself, larger ones in a
+    shared, copy-on-write RunHead.
 */
 class SK_API SkRegion {
 public:
@@ -385,7 +390,11 @@ private:
     };
 
     enum {
-        kRectRegionRuns = 6 // need to store a region of a rect [T B L R S S]        
+        kRectRegionRuns = 6, // need to store a region of a rect [T B L R S S]
+        // enough for an L-shape, a frame, or a few rects in two bands
+        kInlineRunCount = 18,
+        // fRefCnt and fRunCount of the inline RunHead
+        kInlineHeadCount = 2
     };
 
     friend class android::Region;    // needed for marshalling efficiently
@@ -395,6 +404,12 @@ private:
 
     SkIRect     fBounds;
     RunHead*    fRunHead;
+    // RunHead and runs of a small complex region; never shared, so copies
+    // and swaps move the values instead of the pointer.
+    RunType     fInlineRuns[kInlineHeadCount + kInlineRunCount];
+
+    RunHead* inlineHead() const { return (RunHead*)fInlineRuns; }
+    bool isInline() const { return fRunHead == this->inlineHead(); }
 
     void            freeRuns();
     const RunType*  getRuns(RunType tmpStorage[], int* count) const;
@@ -71,6 +71,12 @@ public:
 #endif
     
     static void AntiFillPath(const SkPath&, const SkRegion& clip, SkBlitter*);
+    /** Same as AntiFillPath(), but rather than merging each supersampled span
+        into SkAlphaRuns, record it as four deltas in a per-scanline buffer,
+        which is prefix-summed (with SIMD where available) once per pixel row.
+     */
+    static void AntiFillPathCoverage(const SkPath&, const SkRegion& clip,
+                                     SkBlitter*);
 
     static void AntiHairLine(const SkPoint&, const SkPoint&, const SkRegion*,
                              SkBlitter*);
@@ -68,4 +68,38 @@ private:
 
 #endif
 
+/** Implemented by the porting layer, this function stores newValue at addr if
+    addr still holds oldValue (in a thread-safe manner), and returns the value
+    that addr held before.
+*/
+SK_API void* sk_atomic_cas_ptr(void* volatile* addr, void* oldValue,
+                               void* newValue);
+
+/** Implemented by the porting layer, SkThreadLocal holds one pointer for each
+    thread. When a thread that stored a non-NULL value exits, exitProc (if any)
+    is called on that thread with the value. exitProc may run while the OS
+    holds a loader lock, so it must not block or take a mutex. Instances are
+    meant to be static; they are never removed from the porting layer's
+    thread-exit list.
+*/
+class SkThreadLocal {
+public:
+    typedef void (*ExitProc)(void* value);
+
+    SkThreadLocal(ExitProc exitProc = NULL);
+    ~SkThreadLocal();
+
+    void*   get() const;
+    void    set(void* value);
+
+    /** Called by the porting layer as each thread exits.
+    */
+    static void ThreadExit();
+
+private:
+    ExitProc        fExitProc;
+    uint32_t        fIndex;
+    SkThreadLocal*  fNext;
+};
+
 #endif
@@ -154,6 +154,18 @@ public:
       */
     static SkXfermodeProc16 GetProc16(Mode mode, SkColor srcColor);
 
+    /** Function pointer that applies a transfer mode to a row of pixels, with
+        the same contract as xfer32().
+     */
+    typedef void (*Proc32)(SkPMColor dst[], const SkPMColor src[], int count,
+                           const SkAlpha aa[]);
+
+    /** Return a platform-optimized row routine for the specified mode, or NULL
+        if there is none. Implemented in src/opts; the result must match the
+        portable proc for every pair of premultiplied colors.
+     */
+    static Proc32 PlatformProcs32(Mode mode);
+
     /**
      *  If the specified mode can be represented by a pair of Coeff, then return
      *  true and set (if not NULL) the corresponding coeffs. If the mode is
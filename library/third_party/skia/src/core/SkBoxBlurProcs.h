@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2011 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SkBoxBlurProcs_DEFINED
+#define SkBoxBlurProcs_DEFINED
+
+#include "SkTypes.h"
+
+/** Row loops of the vertical pass of SkBlurMask's separable box blur. The
+    horizontal pass turns each mask row into 16bit window sums; the vertical
+    pass slides a column of 32bit accumulators over those rows and scales
+    them back to 8 bits.
+ */
+struct SkBoxBlurProcs {
+    /** acc[i] += add[i] - sub[i] */
+    typedef void (*AccumulateProc)(uint32_t acc[], const uint16_t add[],
+                                   const uint16_t sub[], int count);
+
+    /** dst[i] = acc[i] * scale >> 24, where the product fits in 32 bits. */
+    typedef void (*ScaleProc)(uint8_t dst[], const uint32_t acc[],
+                              uint32_t scale, int count);
+
+    /** dst[i] = (outer[i] * outerScale + inner[i] * innerScale) >> 24, where
+        the sum fits in 32 bits.
+     */
+    typedef void (*ScaleInterpProc)(uint8_t dst[],
+                                    const uint32_t outer[], uint32_t outerScale,
+                                    const uint32_t inner[], uint32_t innerScale,
+                                    int count);
+
+    AccumulateProc  fAccumulate;
+    ScaleProc       fScale;
+    ScaleInterpProc fScaleInterp;
+};
+
+/** Replace the portable procs with platform-optimized ones where available.
+    Implemented in src/opts.
+ */
+void SkBoxBlurGetPlatformProcs(SkBoxBlurProcs* procs);
+
+#endif
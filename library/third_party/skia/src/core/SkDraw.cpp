@@ -997,7 +997,12 @@ void SkDraw::drawPath(const SkPath& origSrcPath, const SkPaint& paint,
 
     if (doFill) {
         if (paint.isAntiAlias()) {
-            SkScan::AntiFillPath(*devPathPtr, *fClip, blitter.get());
+            if (paint.isCoverageAA()) {
+                SkScan::AntiFillPathCoverage(*devPathPtr, *fClip,
+                                             blitter.get());
+            } else {
+                SkScan::AntiFillPath(*devPathPtr, *fClip, blitter.get());
+            }
         } else {
             SkScan::FillPath(*devPathPtr, *fClip, blitter.get());
         }
@@ -70,6 +70,7 @@ SkGlyphCache::SkGlyphCache(const SkDescriptor* desc)
     memset(fCharToGlyphHash, 0xFF, sizeof(fCharToGlyphHash));
 
     fMemoryUsed = sizeof(*this) + kMinGlphAlloc + kMinImageAlloc;
+    fMemoryChecked = 0;
 
     fGlyphArray.setReserve(METRICS_RESERVE_COUNT);
 
@@ -413,15 +414,52 @@ void SkGlyphCache::invokeAndRemoveAuxProcs() {
     }
 #endif
 
+/*  Each thread parks its most recently used strikes in a small front cache,
+    so that drawing with the same few fonts over and over finds the strike
+    without taking the global mutex. Strikes only move between a front and
+    the global list under the mutex, and only the global list deletes them.
+*/
+#define kFrontCacheCount    4
+
+struct SkGlyphCache_Front {
+    // only the owning thread changes these, but the globals read them (with
+    // the mutex held) to account for the memory of the parked strikes
+    SkGlyphCache* volatile  fCaches[kFrontCacheCount];
+    uint32_t                fStamps[kFrontCacheCount];
+    uint32_t                fClock;
+    // set under the mutex when a purge wants the parked strikes back
+    volatile int32_t        fFlush;
+    // list of all the fronts, owned by the globals' mutex
+    SkGlyphCache_Front*     fNext;
+    SkGlyphCache_Front*     fPrev;
+    // link in the globals' lock-free list of fronts whose thread has exited
+    SkGlyphCache_Front*     fExitNext;
+};
+
 class SkGlyphCache_Globals : public SkGlobals::Rec {
 public:
     SkMutex         fMutex;
     SkGlyphCache*   fHead;
-    size_t          fTotalMemoryUsed;
+    size_t          fTotalMemoryUsed;   // of the caches on the fHead list
+    SkGlyphCache_Front* fFrontHead;
+    // pushed without the mutex by exiting threads, popped with it held
+    SkGlyphCache_Front* volatile fExitedHead;
 #ifdef USE_CACHE_HASH
     SkGlyphCache*   fHash[HASH_COUNT];
 #endif
 
+    // these need the mutex to be held
+    void    attachToList(SkGlyphCache*);
+    void    flushFront(SkGlyphCache_Front*);
+    void    reapExitedFronts();
+    size_t  parkedMemoryUsed() const;
+
+    // these are only called by the thread that owns the front
+    SkGlyphCache_Front* getThreadFront();
+    static SkGlyphCache* TakeFromFront(SkGlyphCache_Front*,
+                                       const SkDescriptor*);
+    static SkGlyphCache* ParkInFront(SkGlyphCache_Front*, SkGlyphCache*);
+
 #ifdef SK_DEBUG
     void validate() const;
 #else
@@ -434,6 +472,8 @@ public:
         SkGlyphCache_Globals* rec = SkNEW(SkGlyphCache_Globals);
         rec->fHead = NULL;
         rec->fTotalMemoryUsed = 0;
+        rec->fFrontHead = NULL;
+        rec->fExitedHead = NULL;
 #ifdef USE_CACHE_HASH
         memset(rec->fHash, 0, sizeof(rec->fHash));
 #endif
@@ -448,12 +488,163 @@ public:
     #define GET_GC_GLOBALS()    gGCGlobals
 #endif
 
+void SkGlyphCache_Globals::attachToList(SkGlyphCache* cache) {
+    cache->attachToHead(&fHead);
+    fTotalMemoryUsed += cache->fMemoryUsed;
+    cache->fMemoryChecked = cache->fMemoryUsed;
+
+#ifdef USE_CACHE_HASH
+    unsigned index = desc_to_hashindex(cache->fDesc);
+    SkASSERT(fHash[index] != cache);
+    fHash[index] = cache;
+#endif
+}
+
+void SkGlyphCache_Globals::flushFront(SkGlyphCache_Front* front) {
+    for (int i = 0; i < kFrontCacheCount; i++) {
+        SkGlyphCache* cache = front->fCaches[i];
+        if (cache) {
+            front->fCaches[i] = NULL;
+            this->attachToList(cache);
+        }
+    }
+    front->fFlush = 0;
+}
+
+size_t SkGlyphCache_Globals::parkedMemoryUsed() const {
+    size_t size = 0;
+
+    for (const SkGlyphCache_Front* front = fFrontHead; front != NULL;
+         front = front->fNext) {
+        for (int i = 0; i < kFrontCacheCount; i++) {
+            // The owner may be swapping this slot right now, but any strike
+            // we see is alive: deleting one takes the mutex we are holding.
+            const SkGlyphCache* cache = front->fCaches[i];
+            if (cache) {
+                size += cache->fMemoryUsed;
+            }
+        }
+    }
+    return size;
+}
+
+/*  Hand the strikes of fronts whose thread has exited back to the global
+    list, and free those fronts. Until then an exited front stays on the
+    fFrontHead list, so its strikes are still counted against the budget.
+*/
+void SkGlyphCache_Globals::reapExitedFronts() {
+    SkGlyphCache_Front* front;
+    do {
+        front = fExitedHead;
+        if (NULL == front) {
+            return;
+        }
+    } while (sk_atomic_cas_ptr((void* volatile*)&fExitedHead, front, NULL) !=
+             front);
+
+    while (front) {
+        SkGlyphCache_Front* next = front->fExitNext;
+
+        this->flushFront(front);
+        if (front->fPrev) {
+            front->fPrev->fNext = front->fNext;
+        } else {
+            fFrontHead = front->fNext;
+        }
+        if (front->fNext) {
+            front->fNext->fPrev = front->fPrev;
+        }
+        SkDELETE(front);
+        front = next;
+    }
+}
+
+/*  This runs on the exiting thread, and on Windows from a loader TLS callback
+    while the loader lock is held. Taking our mutex there could deadlock with
+    a thread that holds it and is waiting on the loader (e.g. a font scaler
+    loading a DLL), so the front is only queued here; the next thread to take
+    the mutex reaps it.
+*/
+static void front_thread_exit(void* data) {
+    SkGlyphCache_Front* front = (SkGlyphCache_Front*)data;
+    SkGlyphCache_Globals& globals = GET_GC_GLOBALS();
+    SkGlyphCache_Front* head;
+
+    do {
+        head = globals.fExitedHead;
+        front->fExitNext = head;
+    } while (sk_atomic_cas_ptr((void* volatile*)&globals.fExitedHead, head,
+                               front) != head);
+}
+
+static SkThreadLocal gThreadFront(front_thread_exit);
+
+SkGlyphCache_Front* SkGlyphCache_Globals::getThreadFront() {
+    SkGlyphCache_Front* front = (SkGlyphCache_Front*)gThreadFront.get();
+    if (NULL == front) {
+        front = SkNEW(SkGlyphCache_Front);
+        for (int i = 0; i < kFrontCacheCount; i++) {
+            front->fCaches[i] = NULL;
+            front->fStamps[i] = 0;
+        }
+        front->fClock = 0;
+        front->fFlush = 0;
+        front->fPrev = NULL;
+        front->fExitNext = NULL;
+
+        SkAutoMutexAcquire ac(fMutex);
+        this->reapExitedFronts();
+        front->fNext = fFrontHead;
+        if (fFrontHead) {
+            fFrontHead->fPrev = front;
+        }
+        fFrontHead = front;
+        gThreadFront.set(front);
+    }
+    return front;
+}
+
+SkGlyphCache* SkGlyphCache_Globals::TakeFromFront(SkGlyphCache_Front* front,
+                                                  const SkDescriptor* desc) {
+    for (int i = 0; i < kFrontCacheCount; i++) {
+        SkGlyphCache* cache = front->fCaches[i];
+        if (cache && cache->fDesc->equals(*desc)) {
+            front->fCaches[i] = NULL;
+            return cache;
+        }
+    }
+    return NULL;
+}
+
+/*  Park the cache in an empty slot, or in place of the least recently used
+    one, which is returned so the caller can attach it to the global list.
+*/
+SkGlyphCache* SkGlyphCache_Globals::ParkInFront(SkGlyphCache_Front* front,
+                                                SkGlyphCache* cache) {
+    int victim = 0;
+    for (int i = 0; i < kFrontCacheCount; i++) {
+        if (NULL == front->fCaches[i]) {
+            victim = i;
+            break;
+        }
+        if (front->fStamps[i] < front->fStamps[victim]) {
+            victim = i;
+        }
+    }
+
+    SkGlyphCache* evicted = front->fCaches[victim];
+    front->fCaches[victim] = cache;
+    front->fStamps[victim] = ++front->fClock;
+    return evicted;
+}
+
 void SkGlyphCache::VisitAllCaches(bool (*proc)(SkGlyphCache*, void*),
                                   void* context) {
     SkGlyphCache_Globals& globals = FIND_GC_GLOBALS();
     SkAutoMutexAcquire    ac(globals.fMutex);
     SkGlyphCache*         cache;
 
+    globals.reapExitedFronts();
     globals.validate();
 
     for (cache = globals.fHead; cache != NULL; cache = cache->fNext) {
@@ -477,10 +668,33 @@ SkGlyphCache* SkGlyphCache::VisitCache(const SkDescriptor* desc,
     SkASSERT(desc);
 
     SkGlyphCache_Globals& globals = FIND_GC_GLOBALS();
-    SkAutoMutexAcquire    ac(globals.fMutex);
+    SkGlyphCache_Front*   front = globals.getThreadFront();
     SkGlyphCache*         cache;
+
+    // our own front cache needs no lock, unless a purge wants it back
+    if (!front->fFlush) {
+        cache = SkGlyphCache_Globals::TakeFromFront(front, desc);
+        if (cache) {
+            AutoValidate av(cache);
+
+            if (proc(cache, context)) {   // stay detached
+                return cache;
+            }
+            // we just emptied a slot, so nothing is evicted
+            cache = SkGlyphCache_Globals::ParkInFront(front, cache);
+            SkASSERT(NULL == cache);
+            return NULL;
+        }
+    }
+
+    SkAutoMutexAcquire    ac(globals.fMutex);
     bool                  insideMutex = true;
 
+    globals.reapExitedFronts();
+    if (front->fFlush) {
+        globals.flushFront(front);
+    }
+
     globals.validate();
 
 #ifdef USE_CACHE_HASH
@@ -539,27 +753,46 @@ void SkGlyphCache::AttachCache(SkGlyphCache* cache) {
     SkASSERT(cache->fNext == NULL);
 
     SkGlyphCache_Globals& globals = GET_GC_GLOBALS();
+    SkGlyphCache_Front*   front = globals.getThreadFront();
+
+    // A strike that has not grown since it was last checked against the
+    // budget can be parked without the mutex; only the strike it evicts has
+    // to go back to the global list.
+    if (!front->fFlush && cache->fMemoryChecked == cache->fMemoryUsed) {
+        SkGlyphCache* evicted = SkGlyphCache_Globals::ParkInFront(front, cache);
+        if (evicted) {
+            SkAutoMutexAcquire ac(globals.fMutex);
+            globals.reapExitedFronts();
+            globals.attachToList(evicted);
+            globals.validate();
+        }
+        return;
+    }
+
     SkAutoMutexAcquire    ac(globals.fMutex);
 
+    globals.reapExitedFronts();
     globals.validate();
     cache->validate();
 
+    if (front->fFlush) {
+        globals.flushFront(front);
+    }
+
     // if we have a fixed budget for our cache, do a purge here
     {
-        size_t allocated = globals.fTotalMemoryUsed + cache->fMemoryUsed;
+        size_t allocated = globals.fTotalMemoryUsed +
+                           globals.parkedMemoryUsed() + cache->fMemoryUsed;
         size_t amountToFree = SkFontHost::ShouldPurgeFontCache(allocated);
         if (amountToFree)
             (void)InternalFreeCache(&globals, amountToFree);
     }
 
-    cache->attachToHead(&globals.fHead);
-    globals.fTotalMemoryUsed += cache->fMemoryUsed;
-
-#ifdef USE_CACHE_HASH
-    unsigned index = desc_to_hashindex(cache->fDesc);
-    SkASSERT(globals.fHash[index] != cache);
-    globals.fHash[index] = cache;
-#endif
+    cache->fMemoryChecked = cache->fMemoryUsed;
+    cache = SkGlyphCache_Globals::ParkInFront(front, cache);
+    if (cache) {
+        globals.attachToList(cache);
+    }
 
     globals.validate();
 }
@@ -568,7 +801,9 @@ size_t SkGlyphCache::GetCacheUsed() {
     SkGlyphCache_Globals& globals = FIND_GC_GLOBALS();
     SkAutoMutexAcquire  ac(globals.fMutex);
 
-    return SkGlyphCache::ComputeMemoryUsed(globals.fHead);
+    globals.reapExitedFronts();
+    return SkGlyphCache::ComputeMemoryUsed(globals.fHead) +
+           globals.parkedMemoryUsed();
 }
 
 bool SkGlyphCache::SetCacheUsed(size_t bytesUsed) {
@@ -648,6 +883,15 @@ size_t SkGlyphCache::InternalFreeCache(SkGlyphCache_Globals* globals,
     globals->fTotalMemoryUsed -= bytesFreed;
     globals->validate();
 
+    // not enough on the global list, so ask each thread to hand back its
+    // parked strikes the next time it visits the cache
+    if (bytesFreed < bytesNeeded) {
+        for (SkGlyphCache_Front* front = globals->fFrontHead; front != NULL;
+             front = front->fNext) {
+            front->fFlush = 1;
+        }
+    }
+
 #ifdef SPEW_PURGE_STATUS
     if (count) {
         SkDebugf("purging %dK from font cache [%d entries]\n",
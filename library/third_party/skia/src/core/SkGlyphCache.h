@@ -121,7 +121,7 @@ public:
 
     /** Call proc on all cache entries, stopping early if proc returns true.
         The proc should not create or delete caches, since it could produce
-        deadlock.
+        deadlock. Strikes parked in a thread's front cache are not visited.
     */
     static void VisitAllCaches(bool (*proc)(SkGlyphCache*, void*), void* ctx);
 
@@ -135,7 +135,9 @@ public:
 
     /** Given a strike that was returned by either VisitCache() or DetachCache()
         add it back into the global cache list (after which the caller should
-        not reference it anymore.
+        not reference it anymore. The strike is first parked in the calling
+        thread's front cache, so the next VisitCache() for it from this thread
+        can find it without taking the global mutex.
     */
     static void AttachCache(SkGlyphCache*);
 
@@ -259,6 +261,9 @@ private:
 
     // used to track (approx) how much ram is tied-up in this cache
     size_t  fMemoryUsed;
+    // fMemoryUsed when this cache was last checked against the font cache
+    // budget; a cache that has not grown since can skip the global mutex
+    size_t  fMemoryChecked;
 
     struct AuxProcRec {
         AuxProcRec* fNext;
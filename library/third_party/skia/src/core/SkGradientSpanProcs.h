@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2011 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SkGradientSpanProcs_DEFINED
+#define SkGradientSpanProcs_DEFINED
+
+#include "SkColor.h"
+#include "SkFixed.h"
+
+#define kSQRT_TABLE_BITS    11
+#define kSQRT_TABLE_SIZE    (1 << kSQRT_TABLE_BITS)
+
+/** Inner loops of the linear and radial gradient shadeSpan(), split out so
+    that they can be replaced by platform-optimized versions. cache is the
+    gradient's 256 entry color cache; every proc must produce exactly what the
+    portable loop in SkGradientShader.cpp produces.
+ */
+struct SkGradientSpanProcs {
+    /** dstC[i] = cache[toggle + index(fx + i * dx)], where toggle flips by 256
+        every pixel (for the dithered half of the cache) and index() is the
+        tile mode applied to the top 8 bits of the 16.16 position. The clamp
+        version is only called on runs where fx >> 8 stays within 0..255.
+     */
+    typedef void (*LinearProc)(SkPMColor dstC[], const SkPMColor cache[],
+                               SkFixed fx, SkFixed dx, int toggle, int count);
+
+    /** The clamped radial gradient, with fx/dx and fy/dy already halved, looks
+        up the distance from the center in sqrtTable (kSQRT_TABLE_SIZE
+        entries).
+     */
+    typedef void (*RadialClampProc)(SkPMColor dstC[], const SkPMColor cache[],
+                                    const uint8_t sqrtTable[],
+                                    SkFixed fx, SkFixed dx,
+                                    SkFixed fy, SkFixed dy, int count);
+
+    /** The repeat and mirror radial gradients compute the distance as
+        SkFixedSqrt(SkFixedSquare(fx) + SkFixedSquare(fy)).
+     */
+    typedef void (*RadialProc)(SkPMColor dstC[], const SkPMColor cache[],
+                               SkFixed fx, SkFixed dx,
+                               SkFixed fy, SkFixed dy, int count);
+
+    LinearProc      fLinearClamp;
+    LinearProc      fLinearRepeat;
+    LinearProc      fLinearMirror;
+    RadialClampProc fRadialClamp;
+    RadialProc      fRadialRepeat;
+    RadialProc      fRadialMirror;
+};
+
+/** Fill in the platform-optimized procs, leaving the others NULL.
+    Implemented in src/opts.
+ */
+void SkGradientSpanGetPlatformProcs(SkGradientSpanProcs* procs);
+
+#endif
@@ -200,6 +200,11 @@ void SkPaint::setAutohinted(bool useAutohinter) {
     this->setFlags(SkSetClearMask(fFlags, useAutohinter, kAutoHinting_Flag));
 }
 
+void SkPaint::setCoverageAA(bool useCoverageAA) {
+    GEN_ID_INC_EVAL(useCoverageAA != isCoverageAA());
+    this->setFlags(SkSetClearMask(fFlags, useCoverageAA, kCoverageAA_Flag));
+}
+
 void SkPaint::setLinearText(bool doLinearText) {
     GEN_ID_INC_EVAL(doLinearText != isLinearText());
     this->setFlags(SkSetClearMask(fFlags, doLinearText, kLinearText_Flag));
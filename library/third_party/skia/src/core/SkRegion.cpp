@@ -105,7 +105,7 @@ SkRegion::~SkRegion() {
 }
 
 void SkRegion::freeRuns() {
-    if (fRunHead->isComplex()) {
+    if (fRunHead->isComplex() && !this->isInline()) {
         SkASSERT(fRunHead->fRefCnt >= 1);
         if (sk_atomic_dec(&fRunHead->fRefCnt) == 1) {
             //SkASSERT(gRgnAllocCounter > 0);
@@ -117,7 +117,14 @@ void SkRegion::freeRuns() {
 }
 
 void SkRegion::allocateRuns(int count) {
-    fRunHead = RunHead::Alloc(count);
+    if (count <= kInlineRunCount) {
+        SkASSERT(count >= kRectRegionRuns);
+        fRunHead = this->inlineHead();
+        fRunHead->fRefCnt = 1;
+        fRunHead->fRunCount = count;
+    } else {
+        fRunHead = RunHead::Alloc(count);
+    }
 }
 
 SkRegion& SkRegion::operator=(const SkRegion& src) {
@@ -126,8 +133,25 @@ SkRegion& SkRegion::operator=(const SkRegion& src) {
 }
 
 void SkRegion::swap(SkRegion& other) {
+    bool thisInline = this->isInline();
+    bool otherInline = other.isInline();
+
     SkTSwap<SkIRect>(fBounds, other.fBounds);
     SkTSwap<RunHead*>(fRunHead, other.fRunHead);
+
+    // inline runs travel by value, so repoint the heads at the new owner
+    if (thisInline | otherInline) {
+        RunType tmp[kInlineHeadCount + kInlineRunCount];
+        memcpy(tmp, fInlineRuns, sizeof(tmp));
+        memcpy(fInlineRuns, other.fInlineRuns, sizeof(tmp));
+        memcpy(other.fInlineRuns, tmp, sizeof(tmp));
+        if (thisInline) {
+            other.fRunHead = other.inlineHead();
+        }
+        if (otherInline) {
+            fRunHead = this->inlineHead();
+        }
+    }
 }
 
 bool SkRegion::setEmpty() {
@@ -157,9 +181,15 @@ bool SkRegion::setRegion(const SkRegion& src) {
         this->freeRuns();
 
         fBounds = src.fBounds;
-        fRunHead = src.fRunHead;
-        if (fRunHead->isComplex()) {
-            sk_atomic_inc(&fRunHead->fRefCnt);
+        if (src.isInline()) {
+            fRunHead = this->inlineHead();
+            memcpy(fInlineRuns, src.fInlineRuns,
+                   (kInlineHeadCount + src.fRunHead->fRunCount) * sizeof(RunType));
+        } else {
+            fRunHead = src.fRunHead;
+            if (fRunHead->isComplex()) {
+                sk_atomic_inc(&fRunHead->fRefCnt);
+            }
         }
     }
     return fRunHead != SkRegion_gEmptyRunHeadPtr;
@@ -297,7 +327,8 @@ bool SkRegion::setRuns(RunType runs[], int count)
 
     //  if we get here, we need to become a complex region
 
-    if (!fRunHead->isComplex() || fRunHead->fRunCount != count)
+    if (!fRunHead->isComplex() || fRunHead->fRunCount != count ||
+            (count <= kInlineRunCount && !this->isInline()))
     {
 #ifdef SK_DEBUGx
         SkDebugf("setRuns: rgn [");
@@ -381,11 +412,75 @@ bool SkRegion::contains(int32_t x, int32_t y) const
     return false;
 }
 
+/*  Walk the scanlines of a complex region that overlap [r.fTop, r.fBottom),
+    and check that each has a single interval covering [r.fLeft, r.fRight).
+ */
+static bool runs_contain_rect(const SkRegion::RunType runs[], const SkIRect& r)
+{
+    runs += 1;  // skip top-Y
+    for (;;)
+    {
+        int bottom = *runs++;
+        SkASSERT(bottom != SkRegion::kRunTypeSentinel);   // r is within bounds
+        if (bottom > r.fTop)
+        {
+            for (;;)
+            {   // intervals are sorted, so the first one ending past left
+                // is the only one that can contain the rect's span
+                if (runs[0] == SkRegion::kRunTypeSentinel || runs[0] > r.fLeft)
+                    return false;
+                if (runs[1] > r.fLeft)
+                {
+                    if (runs[1] < r.fRight)
+                        return false;
+                    break;
+                }
+                runs += 2;
+            }
+            if (bottom >= r.fBottom)
+                return true;
+        }
+        runs = skip_scanline(runs);
+    }
+}
+
+/*  Return true if any interval of a complex region overlaps r.
+ */
+static bool runs_intersect_rect(const SkRegion::RunType runs[], const SkIRect& r)
+{
+    int top = *runs++;
+    for (;;)
+    {
+        if (top >= r.fBottom)
+            return false;
+
+        int bottom = *runs++;
+        if (bottom == SkRegion::kRunTypeSentinel)
+            return false;
+        if (bottom > r.fTop)
+        {
+            while (runs[0] < r.fRight)  // the sentinel stops this too
+            {
+                if (runs[1] > r.fLeft)
+                    return true;
+                runs += 2;
+            }
+        }
+        runs = skip_scanline(runs);
+        top = bottom;
+    }
+}
+
 bool SkRegion::contains(const SkIRect& r) const
 {
-    SkRegion tmp(r);
-    
-    return this->contains(tmp);
+    if (!fBounds.contains(r))   // also rejects empties
+        return false;
+
+    if (this->isRect())
+        return true;
+
+    SkASSERT(this->isComplex());
+    return runs_contain_rect(fRunHead->readonly_runs(), r);
 }
 
 bool SkRegion::contains(const SkRegion& rgn) const
@@ -396,6 +491,18 @@ bool SkRegion::contains(const SkRegion& rgn) const
     if (this->isRect())
         return true;
 
+    if (rgn.isRect())
+        return runs_contain_rect(fRunHead->readonly_runs(), rgn.fBounds);
+
+    // a few rects are cheaper to test one at a time than to union
+    if (rgn.isInline())
+    {
+        for (Iterator iter(rgn); !iter.done(); iter.next())
+            if (!runs_contain_rect(fRunHead->readonly_runs(), iter.rect()))
+                return false;
+        return true;
+    }
+
     SkRegion    tmp;
     
     tmp.op(*this, rgn, kUnion_Op);
@@ -441,8 +548,7 @@ bool SkRegion::intersects(const SkIRect& r) const {
     }
     
     // we are complex
-    SkRegion tmp;
-    return tmp.op(*this, r, kIntersect_Op);
+    return runs_intersect_rect(fRunHead->readonly_runs(), r);
 }
 
 bool SkRegion::intersects(const SkRegion& rgn) const {
@@ -454,11 +560,15 @@ bool SkRegion::intersects(const SkRegion& rgn) const {
         return false;
     }
     
-    if (this->isRect() && rgn.isRect()) {
-        return true;
+    if (this->isRect()) {
+        return rgn.isRect() ||
+               runs_intersect_rect(rgn.fRunHead->readonly_runs(), fBounds);
+    }
+    if (rgn.isRect()) {
+        return runs_intersect_rect(fRunHead->readonly_runs(), rgn.fBounds);
     }
     
-    // one or both of us is complex
+    // both of us are complex
     // TODO: write a faster version that aborts as soon as we write the first
     //       non-empty span, to avoid build the entire result
     SkRegion tmp;
@@ -934,6 +1044,64 @@ static int compute_worst_case_count(int a_count, int b_count) {
     return intervals_to_count(intervals);
 }
 
+/*  If the union of two rects is itself a rect (they share both columns or
+    both rows, and touch or overlap), return it in dst.
+ */
+static bool union_is_rect(const SkIRect& a, const SkIRect& b, SkIRect* dst)
+{
+    if (a.fLeft == b.fLeft && a.fRight == b.fRight)
+    {
+        if (a.fTop > b.fBottom || b.fTop > a.fBottom)
+            return false;
+    }
+    else if (a.fTop == b.fTop && a.fBottom == b.fBottom)
+    {
+        if (a.fLeft > b.fRight || b.fLeft > a.fRight)
+            return false;
+    }
+    else
+        return false;
+
+    dst->set(SkMin32(a.fLeft, b.fLeft), SkMin32(a.fTop, b.fTop),
+             SkMax32(a.fRight, b.fRight), SkMax32(a.fBottom, b.fBottom));
+    return true;
+}
+
+/*  If subtracting b from a (which it intersects) leaves a rect, i.e. b spans
+    a and covers one of its edges, return it in dst (possibly empty).
+ */
+static bool difference_is_rect(const SkIRect& a, const SkIRect& b, SkIRect* dst)
+{
+    *dst = a;
+    if (b.fLeft <= a.fLeft && b.fRight >= a.fRight)
+    {
+        if (b.fTop <= a.fTop)
+        {
+            dst->fTop = b.fBottom;
+            return true;
+        }
+        if (b.fBottom >= a.fBottom)
+        {
+            dst->fBottom = b.fTop;
+            return true;
+        }
+    }
+    else if (b.fTop <= a.fTop && b.fBottom >= a.fBottom)
+    {
+        if (b.fLeft <= a.fLeft)
+        {
+            dst->fLeft = b.fRight;
+            return true;
+        }
+        if (b.fRight >= a.fRight)
+        {
+            dst->fRight = b.fLeft;
+            return true;
+        }
+    }
+    return false;
+}
+
 bool SkRegion::op(const SkRegion& rgnaOrig, const SkRegion& rgnbOrig, Op op)
 {
     SkDEBUGCODE(this->validate();)
@@ -967,6 +1135,11 @@ bool SkRegion::op(const SkRegion& rgnaOrig, const SkRegion& rgnbOrig, Op op)
             return this->setEmpty();
         if (b_empty || !SkIRect::Intersects(rgna->fBounds, rgnb->fBounds))
             return this->setRegion(*rgna);
+        if (b_rect && rgnb->fBounds.contains(rgna->fBounds))
+            return this->setEmpty();
+        if ((a_rect & b_rect)
+                && difference_is_rect(rgna->fBounds, rgnb->fBounds, &bounds))
+            return this->setRect(bounds);
         break;
 
     case kIntersect_Op:
@@ -986,6 +1159,9 @@ bool SkRegion::op(const SkRegion& rgnaOrig, const SkRegion& rgnbOrig, Op op)
             return this->setRegion(*rgna);
         if (b_rect && rgnb->fBounds.contains(rgna->fBounds))
             return this->setRegion(*rgnb);
+        if ((a_rect & b_rect)
+                && union_is_rect(rgna->fBounds, rgnb->fBounds, &bounds))
+            return this->setRect(bounds);
         break;
 
     case kXOR_Op:
@@ -1006,8 +1182,10 @@ bool SkRegion::op(const SkRegion& rgnaOrig, const SkRegion& rgnbOrig, Op op)
     const RunType* a_runs = rgna->getRuns(tmpA, &a_count);
     const RunType* b_runs = rgnb->getRuns(tmpB, &b_count);
 
+    // the stack buffer covers a rect op'd with any inline region (and most
+    // inline pairs), so clip and damage ops on a few rects never allocate
     int dstCount = compute_worst_case_count(a_count, b_count);
-    SkAutoSTMalloc<32, RunType> array(dstCount);
+    SkAutoSTMalloc<256, RunType> array(dstCount);
 
     int count = operate(a_runs, b_runs, array.get(), op);
     SkASSERT(count <= dstCount);
@@ -311,7 +311,7 @@ bool SkRegion::setPath(const SkPath& path, const SkRegion& clip) {
     } else {
         SkRegion    tmp;
 
-        tmp.fRunHead = RunHead::Alloc(count);
+        tmp.allocateRuns(count);
         builder.copyToRgn(tmp.fRunHead->writable_runs());
         ComputeRunBounds(tmp.fRunHead->readonly_runs(), count, &tmp.fBounds);
         this->swap(tmp);
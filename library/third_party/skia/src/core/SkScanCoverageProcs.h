@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2011 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SkScanCoverageProcs_DEFINED
+#define SkScanCoverageProcs_DEFINED
+
+#include "SkTypes.h"
+
+/** Row loops of SkScan::AntiFillPathCoverage(). Each supersampled span adds
+    its coverage to a scanline as deltas, so that the running sum of the
+    deltas is the number of subsamples covered in each pixel. The resulting
+    alpha row is then cut into runs for SkBlitter::blitAntiH().
+ */
+struct SkScanCoverageProcs {
+    /** alpha[i] = min(255, (sum + delta[0] + ... + delta[i]) << 4), then
+        zero delta[0..count-1] for the next scanline. Returns the sum carried
+        out of the last entry.
+     */
+    typedef int (*AccumulateProc)(uint8_t alpha[], int16_t delta[], int count,
+                                  int sum);
+
+    /** Return the number of leading entries of alpha[] equal to alpha[0],
+        at least 1 and at most count.
+     */
+    typedef int (*RunLengthProc)(const uint8_t alpha[], int count);
+
+    AccumulateProc  fAccumulate;
+    RunLengthProc   fRunLength;
+};
+
+/** Replace the portable procs with platform-optimized ones where available.
+    Implemented in src/opts.
+ */
+void SkScanCoverageGetPlatformProcs(SkScanCoverageProcs* procs);
+
+#endif
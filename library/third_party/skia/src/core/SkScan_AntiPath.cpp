@@ -21,6 +21,8 @@
 #include "SkBlitter.h"
 #include "SkRegion.h"
 #include "SkAntiRun.h"
+#include "SkScanCoverageProcs.h"
+#include "SkThread.h"
 
 #define SHIFT   2
 #define SCALE   (1 << SHIFT)
@@ -407,6 +409,255 @@ void MaskSuperBlitter::blitH(int x, int y, int width) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static inline U8CPU subsamples_to_alpha(int sum) {
+    return SkClampMax(sum << (8 - 2*SHIFT), 255);
+}
+
+static int coverage_accumulate(uint8_t alpha[], int16_t delta[], int count,
+                               int sum) {
+    for (int i = 0; i < count; i++) {
+        sum += delta[i];
+        delta[i] = 0;
+        alpha[i] = SkToU8(subsamples_to_alpha(sum));
+    }
+    return sum;
+}
+
+static int coverage_run_length(const uint8_t alpha[], int count) {
+    const U8CPU value = alpha[0];
+    int n = 1;
+    while (n < count && alpha[n] == value) {
+        n += 1;
+    }
+    return n;
+}
+
+// Paths are filled on more than one thread, and the first fills would
+// otherwise race to set up the table.
+static SkMutex gScanCoverageProcsMutex;
+
+static const SkScanCoverageProcs& scan_coverage_procs() {
+    static SkScanCoverageProcs gProcs;
+    static bool gInited;
+
+    SkAutoMutexAcquire ama(gScanCoverageProcsMutex);
+    if (!gInited) {
+        gProcs.fAccumulate = coverage_accumulate;
+        gProcs.fRunLength = coverage_run_length;
+        SkScanCoverageGetPlatformProcs(&gProcs);
+        gInited = true;
+    }
+    return gProcs;
+}
+
+/*  Rather than merging each span into SkAlphaRuns, which costs time
+    proportional to the number of runs already in the scanline, record it as
+    four deltas: entering and leaving the pixels that hold its two ends.
+    The running sum of the deltas is then the number of subsamples covered in
+    each pixel, and is resolved once per pixel row by the accumulate proc.
+    Only the blocks of kBlockSize pixels that received a delta need to be
+    summed; the pixels between them just repeat the sum carried into them,
+    so they can be skipped in a single run.
+ */
+class CoverageSuperBlitter : public BaseSuperBlitter {
+public:
+    CoverageSuperBlitter(SkBlitter* realBlitter, const SkIRect& ir,
+                         const SkRegion& clip);
+
+    virtual ~CoverageSuperBlitter() {
+        this->flush();
+        sk_free(fDelta);
+    }
+
+    void flush();
+
+    virtual void blitH(int x, int y, int width);
+    virtual void blitRect(int x, int y, int width, int height);
+
+private:
+    enum {
+        kBlockShift = 4,
+        kBlockSize = 1 << kBlockShift
+    };
+
+    // each of these has fWidth + 2 entries, rounded up to whole blocks
+    int16_t*    fDelta;     // all 0 between scanlines
+    int16_t*    fRuns;
+    uint8_t*    fAlpha;
+    // the blocks touched by the current scanline, as a flag per block and
+    // as a list in the order they were touched
+    uint8_t*    fTouched;
+    uint16_t*   fTouchedList;
+    int         fTouchedCount;
+    int         fMinX;      // range of fDelta touched by the current scanline
+    int         fMaxX;
+
+    const SkScanCoverageProcs& fProcs;
+
+    void touch(int ix) {
+        const int block = ix >> kBlockShift;
+        if (!fTouched[block]) {
+            fTouched[block] = 1;
+            fTouchedList[fTouchedCount++] = SkToU16(block);
+        }
+    }
+};
+
+CoverageSuperBlitter::CoverageSuperBlitter(SkBlitter* realBlitter,
+                                           const SkIRect& ir,
+                                           const SkRegion& clip)
+        : BaseSuperBlitter(realBlitter, ir, clip)
+        , fProcs(scan_coverage_procs()) {
+    SK_COMPILE_ASSERT(2 == SHIFT, accumulate_proc_assumes_16_subsamples);
+
+    const int blocks = (fWidth + 2 + kBlockSize - 1) >> kBlockShift;
+    const int count = blocks << kBlockShift;
+
+    fDelta = (int16_t*)sk_malloc_throw(count * (2 * sizeof(int16_t) +
+                                                sizeof(uint8_t)) +
+                                       blocks * (sizeof(uint16_t) +
+                                                 sizeof(uint8_t)));
+    fRuns = fDelta + count;
+    fTouchedList = (uint16_t*)(fRuns + count);
+    fAlpha = (uint8_t*)(fTouchedList + blocks);
+    fTouched = fAlpha + count;
+    memset(fDelta, 0, count * sizeof(int16_t));
+    memset(fTouched, 0, blocks);
+    fTouchedCount = 0;
+
+    fMinX = fWidth + 2;
+    fMaxX = 0;
+}
+
+static void sort_blocks(uint16_t list[], int count) {
+    // short, and usually almost in order
+    for (int i = 1; i < count; i++) {
+        uint16_t value = list[i];
+        int j = i;
+        while (j > 0 && list[j - 1] > value) {
+            list[j] = list[j - 1];
+            j -= 1;
+        }
+        list[j] = value;
+    }
+}
+
+void CoverageSuperBlitter::flush() {
+    if (fCurrIY >= 0) {
+        if (fMinX < fMaxX) {
+            // the last delta only brings the sum back to 0, and the pixel
+            // before it may be past our right edge if its span ended there
+            const int stop = SkMin32(fMaxX - 1, fWidth);
+            int sum = 0;
+            int run = fMinX;    // start of the run being built
+            int x = fMinX;
+
+            sort_blocks(fTouchedList, fTouchedCount);
+            for (int i = 0; i < fTouchedCount; i++) {
+                const int block = fTouchedList[i];
+                const int base = block << kBlockShift;
+
+                // no deltas since the previous block, so the pixels up to
+                // this one all have the carried alpha
+                const int gap = SkMin32(base, stop);
+                if (x < gap) {
+                    const U8CPU alpha = subsamples_to_alpha(sum);
+                    if (alpha != fAlpha[run]) {
+                        fRuns[run] = SkToS16(x - run);
+                        run = x;
+                        fAlpha[x] = SkToU8(alpha);
+                    }
+                    x = gap;
+                }
+
+                fTouched[block] = 0;
+                sum = fProcs.fAccumulate(fAlpha + base, fDelta + base,
+                                         kBlockSize, sum);
+
+                const int end = SkMin32(base + kBlockSize, stop);
+                while (x < end) {
+                    if (fAlpha[x] != fAlpha[run]) {
+                        fRuns[run] = SkToS16(x - run);
+                        run = x;
+                    }
+                    x += fProcs.fRunLength(fAlpha + x, end - x);
+                }
+            }
+            fTouchedCount = 0;
+
+            if (x > fMinX) {
+                fRuns[run] = SkToS16(x - run);
+                fRuns[x] = 0;
+                fRealBlitter->blitAntiH(fLeft + fMinX, fCurrIY,
+                                        fAlpha + fMinX, fRuns + fMinX);
+            }
+            fMinX = fWidth + 2;
+            fMaxX = 0;
+        }
+        fCurrIY = -1;
+        SkDEBUGCODE(fCurrX = -1;)
+    }
+}
+
+void CoverageSuperBlitter::blitH(int x, int y, int width) {
+    int iy = y >> SHIFT;
+    SkASSERT(iy >= fCurrIY);
+
+    x -= fSuperLeft;
+    // hack, until I figure out why my cubics (I think) go beyond the bounds
+    if (x < 0) {
+        width += x;
+        x = 0;
+    }
+
+#ifdef SK_DEBUG
+    SkASSERT(y != fCurrY || x >= fCurrX);
+#endif
+    SkASSERT(y >= fCurrY);
+    fCurrY = y;
+
+    if (iy != fCurrIY) {  // new scanline
+        this->flush();
+        fCurrIY = iy;
+    }
+
+    int start = x;
+    int stop = SkMin32(x + width, fWidth << SHIFT);
+    if (stop <= start) {
+        return;
+    }
+
+    int ix = start >> SHIFT;
+    int fb = start & SUPER_Mask;
+    fDelta[ix] += SCALE - fb;
+    fDelta[ix + 1] += fb;
+    this->touch(ix);
+    this->touch(ix + 1);
+    fMinX = SkMin32(fMinX, ix);
+
+    ix = stop >> SHIFT;
+    int fe = stop & SUPER_Mask;
+    fDelta[ix] -= SCALE - fe;
+    fDelta[ix + 1] -= fe;
+    this->touch(ix);
+    this->touch(ix + 1);
+    fMaxX = SkMax32(fMaxX, ix + 2);
+
+#ifdef SK_DEBUG
+    fCurrX = x + width;
+#endif
+}
+
+void CoverageSuperBlitter::blitRect(int x, int y, int width, int height) {
+    for (int i = 0; i < height; ++i) {
+        blitH(x, y + i, width);
+    }
+
+    flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 /*  Returns non-zero if (value << shift) overflows a short, which would mean
     we could not shift it up and then convert to SkFixed.
     i.e. is x expressible as signed (16-shift) bits?
@@ -416,8 +667,8 @@ static int overflows_short_shift(int value, int shift) {
     return (value << s >> s) - value;
 }
 
-void SkScan::AntiFillPath(const SkPath& path, const SkRegion& clip,
-                          SkBlitter* blitter) {
+static void anti_fill_path(const SkPath& path, const SkRegion& clip,
+                           SkBlitter* blitter, bool useCoverage) {
     if (clip.isEmpty()) {
         return;
     }
@@ -472,6 +723,9 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRegion& clip,
         MaskSuperBlitter    superBlit(blitter, ir, clip);
         SkASSERT(SkIntToScalar(ir.fTop) <= path.getBounds().fTop);
         sk_fill_path(path, superClipRect, &superBlit, ir.fTop, ir.fBottom, SHIFT, clip);
+    } else if (useCoverage) {
+        CoverageSuperBlitter    superBlit(blitter, ir, clip);
+        sk_fill_path(path, superClipRect, &superBlit, ir.fTop, ir.fBottom, SHIFT, clip);
     } else {
         SuperBlitter    superBlit(blitter, ir, clip);
         sk_fill_path(path, superClipRect, &superBlit, ir.fTop, ir.fBottom, SHIFT, clip);
@@ -481,3 +735,13 @@ void SkScan::AntiFillPath(const SkPath& path, const SkRegion& clip,
         sk_blit_below(blitter, ir, clip);
     }
 }
+
+void SkScan::AntiFillPath(const SkPath& path, const SkRegion& clip,
+                          SkBlitter* blitter) {
+    anti_fill_path(path, clip, blitter, false);
+}
+
+void SkScan::AntiFillPathCoverage(const SkPath& path, const SkRegion& clip,
+                                  SkBlitter* blitter) {
+    anti_fill_path(path, clip, blitter, true);
+}
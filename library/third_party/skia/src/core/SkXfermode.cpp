@@ -717,6 +717,18 @@ public:
         // these may be valid, or may be CANNOT_USE_COEFF
         fSrcCoeff = rec.fSC;
         fDstCoeff = rec.fDC;
+        fProc32 = SkXfermode::PlatformProcs32(mode);
+    }
+
+    virtual void xfer32(SkPMColor* SK_RESTRICT dst,
+                        const SkPMColor* SK_RESTRICT src, int count,
+                        const SkAlpha* SK_RESTRICT aa) {
+        if (NULL != fProc32) {
+            SkASSERT(dst && src && count >= 0);
+            fProc32(dst, src, count, aa);
+        } else {
+            this->INHERITED::xfer32(dst, src, count, aa);
+        }
     }
 
     virtual bool asMode(Mode* mode) {
@@ -758,8 +770,12 @@ protected:
         fMode = (SkXfermode::Mode)buffer.readU32();
         fSrcCoeff = (Coeff)buffer.readU32();
         fDstCoeff = (Coeff)buffer.readU32();
+        fProc32 = SkXfermode::PlatformProcs32(fMode);
     }
 
+    // optional SIMD row proc, used by xfer32 in place of fProc
+    Proc32  fProc32;
+
 private:
     Mode    fMode;
     Coeff   fSrcCoeff, fDstCoeff;
@@ -896,7 +912,7 @@ public:
         if (count <= 0) {
             return;
         }
-        if (NULL != aa) {
+        if (NULL != aa || NULL != fProc32) {
             return this->INHERITED::xfer32(dst, src, count, aa);
         }
 
@@ -932,7 +948,7 @@ public:
         if (count <= 0) {
             return;
         }
-        if (NULL != aa) {
+        if (NULL != aa || NULL != fProc32) {
             return this->INHERITED::xfer32(dst, src, count, aa);
         }
 
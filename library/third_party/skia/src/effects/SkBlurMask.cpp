@@ -179,6 +179,155 @@ static void apply_kernel_interp(uint8_t dst[], int rx, int ry,
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SkBoxBlurProcs.h"
+#include "SkThread.h"
+
+// Horizontal sums of 2*rx+1 alpha values must fit in 16 bits.
+#define kMaxSeparableRadius     128
+
+static void box_accumulate(uint32_t acc[], const uint16_t add[],
+                           const uint16_t sub[], int count) {
+    for (int i = 0; i < count; i++) {
+        acc[i] += add[i] - sub[i];
+    }
+}
+
+static void box_scale(uint8_t dst[], const uint32_t acc[], uint32_t scale,
+                      int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = SkToU8(acc[i] * scale >> 24);
+    }
+}
+
+static void box_scale_interp(uint8_t dst[],
+                             const uint32_t outer[], uint32_t outer_scale,
+                             const uint32_t inner[], uint32_t inner_scale,
+                             int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = SkToU8((outer[i] * outer_scale + inner[i] * inner_scale) >> 24);
+    }
+}
+
+// Guards filling the table; masks are blurred on several threads.
+static SkMutex gBoxBlurProcsMutex;
+
+static const SkBoxBlurProcs& box_blur_procs() {
+    static SkBoxBlurProcs gProcs;
+    static bool gInited;
+
+    SkAutoMutexAcquire ama(gBoxBlurProcsMutex);
+    if (!gInited) {
+        gProcs.fAccumulate = box_accumulate;
+        gProcs.fScale = box_scale;
+        gProcs.fScaleInterp = box_scale_interp;
+        SkBoxBlurGetPlatformProcs(&gProcs);
+        gInited = true;
+    }
+    return gProcs;
+}
+
+/*  outer[x] is the sum of src[x-2*rx .. x], and inner[x] (if not NULL) that
+    of src[x-2*rx+1 .. x-1], with src treated as 0 outside 0..sw-1. Both rows
+    are sw + 2*rx long.
+ */
+static void box_sum_row(uint16_t outer[], uint16_t inner[],
+                        const uint8_t src[], int sw, int rx) {
+    int diameter = 2*rx;
+    int dw = sw + diameter;
+    unsigned sum = 0;
+
+    for (int x = 0; x < dw; x++) {
+        unsigned entering = x < sw ? src[x] : 0;
+        unsigned leaving = x >= diameter ? src[x - diameter] : 0;
+
+        sum += entering;
+        outer[x] = SkToU16(sum);
+        if (inner) {
+            inner[x] = SkToU16(sum - entering - leaving);
+        }
+        sum -= leaving;
+    }
+}
+
+/*  Separable equivalent of build_sum_buffer + apply_kernel/apply_kernel_interp.
+    Each dst value is the same integer window sum, so the output is identical,
+    but src is read directly: the horizontal sums of the last 2*ry+2 rows are
+    kept in a ring, and a row of accumulators slides down over them. Scratch
+    memory is therefore bounded by the radius rather than the mask size.
+ */
+static void apply_box_blur(uint8_t dst[], const uint8_t src[], int srcRB,
+                           int sw, int sh, int rx, int ry,
+                           U8CPU outer_weight) {
+    SkASSERT(rx > 0 && rx <= kMaxSeparableRadius);
+    SkASSERT(ry > 0 && ry <= kMaxSeparableRadius);
+    SkASSERT(outer_weight <= 255);
+
+    const SkBoxBlurProcs& procs = box_blur_procs();
+    const bool interp = outer_weight != 255;
+
+    uint32_t outer_scale, inner_scale;
+    if (interp) {
+        int inner_weight = 255 - outer_weight;
+
+        // round these guys up if they're bigger than 127
+        outer_weight += outer_weight >> 7;
+        inner_weight += inner_weight >> 7;
+
+        outer_scale = (outer_weight << 16) / ((2*rx + 1)*(2*ry + 1));
+        inner_scale = (inner_weight << 16) / ((2*rx - 1)*(2*ry - 1));
+    } else {
+        outer_scale = (1 << 24) / ((2*rx + 1)*(2*ry + 1));
+        inner_scale = 0;
+    }
+
+    int dw = sw + 2*rx;
+    int dh = sh + 2*ry;
+    int ringCount = 2*ry + 2;
+
+    // the outer ring, the inner ring (if interpolating), then a row of zeros
+    // standing in for the rows above and below src
+    int rowCount = (interp ? 2 * ringCount : ringCount) + 1;
+    SkAutoTMalloc<uint16_t> rowStorage(rowCount * dw);
+    SkAutoTMalloc<uint32_t> accStorage(2 * dw);
+
+    uint16_t* outerRing = rowStorage.get();
+    uint16_t* innerRing = interp ? outerRing + ringCount * dw : NULL;
+    uint16_t* zeroRow = rowStorage.get() + (rowCount - 1) * dw;
+    uint32_t* outerAcc = accStorage.get();
+    uint32_t* innerAcc = outerAcc + dw;
+
+    memset(zeroRow, 0, dw * sizeof(uint16_t));
+    memset(accStorage.get(), 0, 2 * dw * sizeof(uint32_t));
+
+#define RING_ROW(ring, row) \
+    ((unsigned)(row) < (unsigned)sh ? (ring) + ((row) % ringCount) * dw : zeroRow)
+
+    for (int y = 0; y < dh; y++) {
+        if (y < sh) {
+            int slot = (y % ringCount) * dw;
+            box_sum_row(outerRing + slot, interp ? innerRing + slot : NULL,
+                        src + y * srcRB, sw, rx);
+        }
+
+        // outerAcc sums rows y-2*ry .. y, innerAcc rows y-2*ry+1 .. y-1
+        procs.fAccumulate(outerAcc, RING_ROW(outerRing, y),
+                          RING_ROW(outerRing, y - 2*ry - 1), dw);
+        if (interp) {
+            procs.fAccumulate(innerAcc, RING_ROW(innerRing, y - 1),
+                              RING_ROW(innerRing, y - 2*ry), dw);
+            procs.fScaleInterp(dst, outerAcc, outer_scale,
+                               innerAcc, inner_scale, dw);
+        } else {
+            procs.fScale(dst, outerAcc, outer_scale, dw);
+        }
+        dst += dw;
+    }
+
+#undef RING_ROW
+}
+
 #include "SkColorPriv.h"
 
 static void merge_src_with_blur(uint8_t dst[], int dstRB,
@@ -291,7 +440,26 @@ bool SkBlurMask::Blur(SkMask* dst, const SkMask& src,
         SkAutoTCallVProc<uint8_t, SkMask_FreeImage> autoCall(dp);
 
         // build the blurry destination
-        {
+        if (rx <= kMaxSeparableRadius) {
+            //pass1: sp is source, dp is destination
+            apply_box_blur(dp, sp, src.fRowBytes, sw, sh, rx, ry, outer_weight);
+
+            if (quality == kHigh_Quality)
+            {
+                //pass2: dp is source, tmpBuffer is destination
+                int tmp_sw = sw + 2 * rx;
+                int tmp_sh = sh + 2 * ry;
+                SkAutoTMalloc<uint8_t>  tmpBuffer(dstSize);
+                apply_box_blur(tmpBuffer.get(), dp, tmp_sw, tmp_sw, tmp_sh,
+                               rx, ry, outer_weight);
+
+                //pass3: tmpBuffer is source, dp is destination
+                tmp_sw += 2 * rx;
+                tmp_sh += 2 * ry;
+                apply_box_blur(dp, tmpBuffer.get(), tmp_sw, tmp_sw, tmp_sh,
+                               rx, ry, outer_weight);
+            }
+        } else {
             SkAutoTMalloc<uint32_t> storage((sw + 2 * (passCount - 1) * rx + 1) * (sh + 2 * (passCount - 1) * ry + 1));
             uint32_t*               sumBuffer = storage.get();
 
@@ -22,6 +22,7 @@
 #include "SkUtils.h"
 #include "SkTemplates.h"
 #include "SkBitmapCache.h"
+#include "SkGradientSpanProcs.h"
 
 #ifndef SK_DISABLE_DITHER_32BIT_GRADIENT
     #define USE_DITHER_32BIT_GRADIENT
@@ -81,6 +82,29 @@ static const TileProc gTileProcs[] = {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// The first calls may come from several raster threads at once.
+static SkMutex gGradientSpanProcsMutex;
+
+static const SkGradientSpanProcs& gradient_span_procs() {
+    static SkGradientSpanProcs gProcs;
+    static bool gInited;
+
+    SkAutoMutexAcquire ama(gGradientSpanProcsMutex);
+    if (!gInited) {
+        SkGradientSpanGetPlatformProcs(&gProcs);
+#ifndef USE_DITHER_32BIT_GRADIENT
+        // the linear span procs always toggle through the dither half
+        gProcs.fLinearClamp = NULL;
+        gProcs.fLinearRepeat = NULL;
+        gProcs.fLinearMirror = NULL;
+#endif
+        gInited = true;
+    }
+    return gProcs;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 static inline int repeat_bits(int x, const int bits) {
     return x & ((1 << bits) - 1);
 }
@@ -851,6 +875,7 @@ void Linear_Gradient::shadeSpan(int x, int y, SkPMColor dstC[], int count) {
     SkMatrix::MapXYProc dstProc = fDstToIndexProc;
     TileProc            proc = fTileProc;
     const SkPMColor*    cache = this->getCache32();
+    const SkGradientSpanProcs& spanProcs = gradient_span_procs();
 #ifdef USE_DITHER_32BIT_GRADIENT
     int                 toggle = ((x ^ y) & 1) << kCache32Bits;
     const int           TOGGLE_MASK = (1 << kCache32Bits);
@@ -891,18 +916,26 @@ void Linear_Gradient::shadeSpan(int x, int y, SkPMColor dstC[], int count) {
                 dstC += count;
             }
             if ((count = range.fCount1) > 0) {
-                int unroll = count >> 3;
                 fx = range.fFx1;
-                for (int i = 0; i < unroll; i++) {
-                    NO_CHECK_ITER;  NO_CHECK_ITER;
-                    NO_CHECK_ITER;  NO_CHECK_ITER;
-                    NO_CHECK_ITER;  NO_CHECK_ITER;
-                    NO_CHECK_ITER;  NO_CHECK_ITER;
-                }
-                if ((count &= 7) > 0) {
-                    do {
-                        NO_CHECK_ITER;
-                    } while (--count != 0);
+                if (NULL != spanProcs.fLinearClamp) {
+                    spanProcs.fLinearClamp(dstC, cache, fx, dx, toggle, count);
+                    dstC += count;
+                    if (count & 1) {
+                        toggle ^= TOGGLE_MASK;
+                    }
+                } else {
+                    int unroll = count >> 3;
+                    for (int i = 0; i < unroll; i++) {
+                        NO_CHECK_ITER;  NO_CHECK_ITER;
+                        NO_CHECK_ITER;  NO_CHECK_ITER;
+                        NO_CHECK_ITER;  NO_CHECK_ITER;
+                        NO_CHECK_ITER;  NO_CHECK_ITER;
+                    }
+                    if ((count &= 7) > 0) {
+                        do {
+                            NO_CHECK_ITER;
+                        } while (--count != 0);
+                    }
                 }
             }
             if ((count = range.fCount2) > 0) {
@@ -912,6 +945,10 @@ void Linear_Gradient::shadeSpan(int x, int y, SkPMColor dstC[], int count) {
                                    count);
             }
         } else if (proc == mirror_tileproc) {
+            if (NULL != spanProcs.fLinearMirror) {
+                spanProcs.fLinearMirror(dstC, cache, fx, dx, toggle, count);
+                return;
+            }
             do {
                 unsigned fi = mirror_8bits(fx >> 8);
                 SkASSERT(fi <= 0xFF);
@@ -921,6 +958,10 @@ void Linear_Gradient::shadeSpan(int x, int y, SkPMColor dstC[], int count) {
             } while (--count != 0);
         } else {
             SkASSERT(proc == repeat_tileproc);
+            if (NULL != spanProcs.fLinearRepeat) {
+                spanProcs.fLinearRepeat(dstC, cache, fx, dx, toggle, count);
+                return;
+            }
             do {
                 unsigned fi = repeat_8bits(fx >> 8);
                 SkASSERT(fi <= 0xFF);
@@ -1094,9 +1135,7 @@ void Linear_Gradient::shadeSpan16(int x, int y, uint16_t dstC[], int count) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-#define kSQRT_TABLE_BITS    11
-#define kSQRT_TABLE_SIZE    (1 << kSQRT_TABLE_BITS)
-
+// kSQRT_TABLE_BITS and kSQRT_TABLE_SIZE are in SkGradientSpanProcs.h
 #include "SkRadialGradient_Table.h"
 
 #if defined(SK_BUILD_FOR_WIN32) && defined(SK_DEBUG)
@@ -1162,6 +1201,7 @@ public:
         SkMatrix::MapXYProc dstProc = fDstToIndexProc;
         TileProc            proc = fTileProc;
         const SkPMColor*    cache = this->getCache32();
+        const SkGradientSpanProcs& spanProcs = gradient_span_procs();
 
         if (fDstToIndexClass != kPerspective_MatrixClass) {
             dstProc(fDstToIndex, SkIntToScalar(x) + SK_ScalarHalf,
@@ -1186,6 +1226,11 @@ public:
                 dx >>= 1;
                 fy >>= 1;
                 dy >>= 1;
+                if (NULL != spanProcs.fRadialClamp) {
+                    spanProcs.fRadialClamp(dstC, cache, sqrt_table,
+                                           fx, dx, fy, dy, count);
+                    return;
+                }
                 do {
                     unsigned xx = SkPin32(fx, -0xFFFF >> 1, 0xFFFF >> 1);
                     unsigned fi = SkPin32(fy, -0xFFFF >> 1, 0xFFFF >> 1);
@@ -1196,6 +1241,10 @@ public:
                     fy += dy;
                 } while (--count != 0);
             } else if (proc == mirror_tileproc) {
+                if (NULL != spanProcs.fRadialMirror) {
+                    spanProcs.fRadialMirror(dstC, cache, fx, dx, fy, dy, count);
+                    return;
+                }
                 do {
                     SkFixed magnitudeSquared = SkFixedSquare(fx) + SkFixedSquare(fy);
                     if (magnitudeSquared < 0) // Overflow.
@@ -1209,6 +1258,10 @@ public:
                 } while (--count != 0);
             } else {
                 SkASSERT(proc == repeat_tileproc);
+                if (NULL != spanProcs.fRadialRepeat) {
+                    spanProcs.fRadialRepeat(dstC, cache, fx, dx, fy, dy, count);
+                    return;
+                }
                 do {
                     SkFixed magnitudeSquared = SkFixedSquare(fx) + SkFixedSquare(fy);
                     if (magnitudeSquared < 0) // Overflow.
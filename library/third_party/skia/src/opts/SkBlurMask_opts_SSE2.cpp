@@ -0,0 +1,125 @@
+/*
+ **
+ ** Copyright 2009, The Android Open Source Project
+ **
+ ** Licensed under the Apache License, Version 2.0 (the "License");
+ ** you may not use this file except in compliance with the License.
+ ** You may obtain a copy of the License at
+ **
+ **     http://www.apache.org/licenses/LICENSE-2.0
+ **
+ ** Unless required by applicable law or agreed to in writing, software
+ ** distributed under the License is distributed on an "AS IS" BASIS,
+ ** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ ** See the License for the specific language governing permissions and
+ ** limitations under the License.
+ */
+
+#include "SkBlurMask_opts_SSE2.h"
+
+#include <emmintrin.h>
+
+/* SSE2 versions of the vertical pass row loops in effects/SkBlurMask.cpp */
+
+void SkBoxBlurAccumulate_SSE2(uint32_t acc[], const uint16_t add[],
+                              const uint16_t sub[], int count) {
+    const __m128i zero = _mm_setzero_si128();
+
+    while (count >= 8) {
+        __m128i a = _mm_loadu_si128((const __m128i*)add);
+        __m128i s = _mm_loadu_si128((const __m128i*)sub);
+        __m128i lo = _mm_loadu_si128((const __m128i*)acc);
+        __m128i hi = _mm_loadu_si128((const __m128i*)(acc + 4));
+
+        lo = _mm_sub_epi32(_mm_add_epi32(lo, _mm_unpacklo_epi16(a, zero)),
+                           _mm_unpacklo_epi16(s, zero));
+        hi = _mm_sub_epi32(_mm_add_epi32(hi, _mm_unpackhi_epi16(a, zero)),
+                           _mm_unpackhi_epi16(s, zero));
+
+        _mm_storeu_si128((__m128i*)acc, lo);
+        _mm_storeu_si128((__m128i*)(acc + 4), hi);
+        acc += 8;
+        add += 8;
+        sub += 8;
+        count -= 8;
+    }
+    while (count > 0) {
+        *acc++ += *add++ - *sub++;
+        count--;
+    }
+}
+
+// (acc * scale) >> 24 for four lanes whose products fit in 32 bits. The
+// products are formed as 64 bits by pmuludq, even and odd lanes separately.
+static inline __m128i mul_shr24_SSE2(__m128i acc, __m128i scale) {
+    __m128i even = _mm_srli_epi64(_mm_mul_epu32(acc, scale), 24);
+    __m128i odd = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(acc, 32),
+                                               scale), 24);
+    return _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+}
+
+// Same for (outer * outerScale + inner * innerScale) >> 24.
+static inline __m128i mul_add_shr24_SSE2(__m128i outer, __m128i outerScale,
+                                         __m128i inner, __m128i innerScale) {
+    __m128i even = _mm_add_epi64(_mm_mul_epu32(outer, outerScale),
+                                 _mm_mul_epu32(inner, innerScale));
+    __m128i odd = _mm_add_epi64(
+            _mm_mul_epu32(_mm_srli_epi64(outer, 32), outerScale),
+            _mm_mul_epu32(_mm_srli_epi64(inner, 32), innerScale));
+    return _mm_or_si128(_mm_srli_epi64(even, 24),
+                        _mm_slli_epi64(_mm_srli_epi64(odd, 24), 32));
+}
+
+// Packs sixteen 32bit lanes, each 0..255, into bytes.
+static inline void store16_SSE2(uint8_t dst[], __m128i a, __m128i b,
+                                __m128i c, __m128i d) {
+    _mm_storeu_si128((__m128i*)dst,
+                     _mm_packus_epi16(_mm_packs_epi32(a, b),
+                                      _mm_packs_epi32(c, d)));
+}
+
+void SkBoxBlurScale_SSE2(uint8_t dst[], const uint32_t acc[], uint32_t scale,
+                         int count) {
+    const __m128i s = _mm_set1_epi32(scale);
+
+    while (count >= 16) {
+        __m128i a = mul_shr24_SSE2(_mm_loadu_si128((const __m128i*)acc), s);
+        __m128i b = mul_shr24_SSE2(_mm_loadu_si128((const __m128i*)(acc + 4)), s);
+        __m128i c = mul_shr24_SSE2(_mm_loadu_si128((const __m128i*)(acc + 8)), s);
+        __m128i d = mul_shr24_SSE2(_mm_loadu_si128((const __m128i*)(acc + 12)), s);
+        store16_SSE2(dst, a, b, c, d);
+        dst += 16;
+        acc += 16;
+        count -= 16;
+    }
+    while (count > 0) {
+        *dst++ = SkToU8(*acc++ * scale >> 24);
+        count--;
+    }
+}
+
+void SkBoxBlurScaleInterp_SSE2(uint8_t dst[],
+                               const uint32_t outer[], uint32_t outerScale,
+                               const uint32_t inner[], uint32_t innerScale,
+                               int count) {
+    const __m128i os = _mm_set1_epi32(outerScale);
+    const __m128i is = _mm_set1_epi32(innerScale);
+
+    while (count >= 16) {
+        __m128i r[4];
+        for (int i = 0; i < 4; i++) {
+            r[i] = mul_add_shr24_SSE2(
+                    _mm_loadu_si128((const __m128i*)(outer + 4 * i)), os,
+                    _mm_loadu_si128((const __m128i*)(inner + 4 * i)), is);
+        }
+        store16_SSE2(dst, r[0], r[1], r[2], r[3]);
+        dst += 16;
+        outer += 16;
+        inner += 16;
+        count -= 16;
+    }
+    while (count > 0) {
+        *dst++ = SkToU8((*outer++ * outerScale + *inner++ * innerScale) >> 24);
+        count--;
+    }
+}
@@ -0,0 +1,27 @@
+/*
+ **
+ ** Copyright 2009, The Android Open Source Project
+ **
+ ** Licensed under the Apache License, Version 2.0 (the "License");
+ ** you may not use this file except in compliance with the License.
+ ** You may obtain a copy of the License at
+ **
+ **     http://www.apache.org/licenses/LICENSE-2.0
+ **
+ ** Unless required by applicable law or agreed to in writing, software
+ ** distributed under the License is distributed on an "AS IS" BASIS,
+ ** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ ** See the License for the specific language governing permissions and
+ ** limitations under the License.
+ */
+
+#include "SkBoxBlurProcs.h"
+
+void SkBoxBlurAccumulate_SSE2(uint32_t acc[], const uint16_t add[],
+                              const uint16_t sub[], int count);
+void SkBoxBlurScale_SSE2(uint8_t dst[], const uint32_t acc[], uint32_t scale,
+                         int count);
+void SkBoxBlurScaleInterp_SSE2(uint8_t dst[],
+                               const uint32_t outer[], uint32_t outerScale,
+                               const uint32_t inner[], uint32_t innerScale,
+                               int count);
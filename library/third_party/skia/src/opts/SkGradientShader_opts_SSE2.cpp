@@ -0,0 +1,244 @@
+/*
+ **
+ ** Copyright 2009, The Android Open Source Project
+ **
+ ** Licensed under the Apache License, Version 2.0 (the "License");
+ ** you may not use this file except in compliance with the License.
+ ** You may obtain a copy of the License at
+ **
+ **     http://www.apache.org/licenses/LICENSE-2.0
+ **
+ ** Unless required by applicable law or agreed to in writing, software
+ ** distributed under the License is distributed on an "AS IS" BASIS,
+ ** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ ** See the License for the specific language governing permissions and
+ ** limitations under the License.
+ */
+
+#include "SkGradientShader_opts_SSE2.h"
+#include "SkMath.h"
+
+#include <emmintrin.h>
+
+/* SSE2 versions of the 32bit span loops in effects/SkGradientShader.cpp.
+ *
+ * Four positions are stepped at once and turned into cache indices in
+ * registers; only the cache reads stay scalar.
+ */
+
+// toggle between the two halves of the (dithered) 256 entry cache
+#define CACHE_TOGGLE    256
+
+// The tile modes applied to a 16.16 position, giving a cache index 0..255.
+// These match both the linear *_8bits() helpers applied to fx >> 8 and the
+// radial *_tileproc() helpers followed by >> 8.
+struct Clamp_Index_SSE2 {
+    // only used where the position is already in range
+    static inline __m128i index(__m128i x) {
+        return _mm_srai_epi32(x, 8);
+    }
+};
+
+struct Repeat_Index_SSE2 {
+    static inline __m128i index(__m128i x) {
+        return _mm_and_si128(_mm_srai_epi32(x, 8), _mm_set1_epi32(0xFF));
+    }
+};
+
+struct Mirror_Index_SSE2 {
+    static inline __m128i index(__m128i x) {
+        __m128i s = _mm_srai_epi32(_mm_slli_epi32(x, 15), 31);
+        return _mm_and_si128(_mm_srai_epi32(_mm_xor_si128(x, s), 8),
+                             _mm_set1_epi32(0xFF));
+    }
+};
+
+// Returns x, x + dx, x + 2dx, x + 3dx.
+static inline __m128i step4_SSE2(SkFixed x, SkFixed dx) {
+    return _mm_add_epi32(_mm_set1_epi32(x),
+                         _mm_set_epi32(3 * dx, 2 * dx, dx, 0));
+}
+
+// Writes cache[index] for the first count (at most 4) lanes; every index is
+// below 2^16.
+static inline void gather_SSE2(SkPMColor dstC[], const SkPMColor cache[],
+                               __m128i index, int count) {
+    dstC[0] = cache[_mm_extract_epi16(index, 0)];
+    if (count > 1) {
+        dstC[1] = cache[_mm_extract_epi16(index, 2)];
+        if (count > 2) {
+            dstC[2] = cache[_mm_extract_epi16(index, 4)];
+            if (count > 3) {
+                dstC[3] = cache[_mm_extract_epi16(index, 6)];
+            }
+        }
+    }
+}
+
+template <typename Tile>
+static void linear_span_SSE2(SkPMColor* SK_RESTRICT dstC,
+                             const SkPMColor* SK_RESTRICT cache,
+                             SkFixed fx, SkFixed dx, int toggle, int count) {
+    SkASSERT(count > 0);
+
+    __m128i fx4 = step4_SSE2(fx, dx);
+    const __m128i dx4 = _mm_set1_epi32(4 * dx);
+    // an even number of pixels per step keeps this pattern
+    const __m128i toggle4 = _mm_set_epi32(toggle ^ CACHE_TOGGLE, toggle,
+                                          toggle ^ CACHE_TOGGLE, toggle);
+
+    while (count >= 4) {
+        __m128i index = _mm_add_epi32(Tile::index(fx4), toggle4);
+        gather_SSE2(dstC, cache, index, 4);
+        fx4 = _mm_add_epi32(fx4, dx4);
+        dstC += 4;
+        count -= 4;
+    }
+    if (count > 0) {
+        __m128i index = _mm_add_epi32(Tile::index(fx4), toggle4);
+        gather_SSE2(dstC, cache, index, count);
+    }
+}
+
+void Linear_Clamp_Span_SSE2(SkPMColor dstC[], const SkPMColor cache[],
+                            SkFixed fx, SkFixed dx, int toggle, int count) {
+    linear_span_SSE2<Clamp_Index_SSE2>(dstC, cache, fx, dx, toggle, count);
+}
+
+void Linear_Repeat_Span_SSE2(SkPMColor dstC[], const SkPMColor cache[],
+                             SkFixed fx, SkFixed dx, int toggle, int count) {
+    linear_span_SSE2<Repeat_Index_SSE2>(dstC, cache, fx, dx, toggle, count);
+}
+
+void Linear_Mirror_Span_SSE2(SkPMColor dstC[], const SkPMColor cache[],
+                             SkFixed fx, SkFixed dx, int toggle, int count) {
+    linear_span_SSE2<Mirror_Index_SSE2>(dstC, cache, fx, dx, toggle, count);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Radial_Clamp_Span_SSE2(SkPMColor dstC[], const SkPMColor cache[],
+                            const uint8_t sqrtTable[],
+                            SkFixed fx, SkFixed dx,
+                            SkFixed fy, SkFixed dy, int count) {
+    SkASSERT(count > 0);
+
+    __m128i fx4 = step4_SSE2(fx, dx);
+    __m128i fy4 = step4_SSE2(fy, dy);
+    const __m128i dx4 = _mm_set1_epi32(4 * dx);
+    const __m128i dy4 = _mm_set1_epi32(4 * dy);
+    const __m128i maxIndex = _mm_set1_epi32(0xFFFF >> (16 - kSQRT_TABLE_BITS));
+
+    for (;;) {
+        // Saturating to 16 bits is the same SkPin32() to +-(0xFFFF >> 1) as
+        // the portable loop, and leaves x,y pairs for madd to square and sum.
+        __m128i xy = _mm_packs_epi32(fx4, fy4);
+        xy = _mm_unpacklo_epi16(xy, _mm_unpackhi_epi64(xy, xy));
+        __m128i fi = _mm_srli_epi32(_mm_madd_epi16(xy, xy),
+                                    14 + 16 - kSQRT_TABLE_BITS);
+        // fi fits in 16 bits here, so a 16bit min is enough
+        fi = _mm_min_epi16(fi, maxIndex);
+
+        int n = SkMin32(count, 4);
+        for (int i = 0; i < n; i++) {
+            unsigned index = _mm_cvtsi128_si32(fi);
+            dstC[i] = cache[sqrtTable[index]];
+            fi = _mm_srli_si128(fi, 4);
+        }
+        if ((count -= n) == 0) {
+            break;
+        }
+        fx4 = _mm_add_epi32(fx4, dx4);
+        fy4 = _mm_add_epi32(fy4, dy4);
+        dstC += 4;
+    }
+}
+
+// Below this magnitude (64.0) both squares and their sum fit in 29 bits, and
+// every step of the double precision distance below is exact.
+#define RADIAL_MAX_COORD    (64 << 16)
+
+static bool radial_span_in_range(SkFixed fx, SkFixed dx, SkFixed fy, SkFixed dy,
+                                 int count) {
+    double lastX = fx + (double)dx * (count - 1);
+    double lastY = fy + (double)dy * (count - 1);
+    return SkAbs32(fx) < RADIAL_MAX_COORD && SkAbs32(fy) < RADIAL_MAX_COORD &&
+           lastX > -RADIAL_MAX_COORD && lastX < RADIAL_MAX_COORD &&
+           lastY > -RADIAL_MAX_COORD && lastY < RADIAL_MAX_COORD;
+}
+
+// SkFixedSquare() of the two low lanes, as doubles.
+static inline __m128i fixed_square_SSE2(__m128d x) {
+    return _mm_cvttpd_epi32(_mm_mul_pd(_mm_mul_pd(x, x),
+                                       _mm_set1_pd(1.0 / 65536)));
+}
+
+// SkFixedSqrt(), i.e. floor(sqrt(mag << 16)), of the two low lanes.
+static inline __m128i fixed_sqrt_SSE2(__m128i mag) {
+    __m128d m = _mm_mul_pd(_mm_cvtepi32_pd(mag), _mm_set1_pd(65536.0));
+    return _mm_cvttpd_epi32(_mm_sqrt_pd(m));
+}
+
+// SkFixedSqrt(SkFixedSquare(x) + SkFixedSquare(y)) for four lanes in range.
+static inline __m128i radial_dist_SSE2(__m128i x, __m128i y) {
+    __m128i xHi = _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+    __m128i yHi = _mm_shuffle_epi32(y, _MM_SHUFFLE(1, 0, 3, 2));
+
+    __m128i lo = _mm_add_epi32(fixed_square_SSE2(_mm_cvtepi32_pd(x)),
+                               fixed_square_SSE2(_mm_cvtepi32_pd(y)));
+    __m128i hi = _mm_add_epi32(fixed_square_SSE2(_mm_cvtepi32_pd(xHi)),
+                               fixed_square_SSE2(_mm_cvtepi32_pd(yHi)));
+    return _mm_unpacklo_epi64(fixed_sqrt_SSE2(lo), fixed_sqrt_SSE2(hi));
+}
+
+template <typename Tile>
+static void radial_span_SSE2(SkPMColor* SK_RESTRICT dstC,
+                             const SkPMColor* SK_RESTRICT cache,
+                             SkFixed fx, SkFixed dx,
+                             SkFixed fy, SkFixed dy, int count) {
+    SkASSERT(count > 0);
+
+    if (!radial_span_in_range(fx, dx, fy, dy, count)) {
+        // same as the portable loop, overflow clamping included
+        do {
+            SkFixed magnitudeSquared = SkFixedSquare(fx) + SkFixedSquare(fy);
+            if (magnitudeSquared < 0) // Overflow.
+                magnitudeSquared = SK_FixedMax;
+            SkFixed dist = SkFixedSqrt(magnitudeSquared);
+            __m128i index = Tile::index(_mm_cvtsi32_si128(dist));
+            *dstC++ = cache[_mm_cvtsi128_si32(index)];
+            fx += dx;
+            fy += dy;
+        } while (--count != 0);
+        return;
+    }
+
+    __m128i fx4 = step4_SSE2(fx, dx);
+    __m128i fy4 = step4_SSE2(fy, dy);
+    const __m128i dx4 = _mm_set1_epi32(4 * dx);
+    const __m128i dy4 = _mm_set1_epi32(4 * dy);
+
+    while (count >= 4) {
+        gather_SSE2(dstC, cache, Tile::index(radial_dist_SSE2(fx4, fy4)), 4);
+        fx4 = _mm_add_epi32(fx4, dx4);
+        fy4 = _mm_add_epi32(fy4, dy4);
+        dstC += 4;
+        count -= 4;
+    }
+    if (count > 0) {
+        gather_SSE2(dstC, cache, Tile::index(radial_dist_SSE2(fx4, fy4)),
+                    count);
+    }
+}
+
+void Radial_Repeat_Span_SSE2(SkPMColor dstC[], const SkPMColor cache[],
+                             SkFixed fx, SkFixed dx,
+                             SkFixed fy, SkFixed dy, int count) {
+    radial_span_SSE2<Repeat_Index_SSE2>(dstC, cache, fx, dx, fy, dy, count);
+}
+
+void Radial_Mirror_Span_SSE2(SkPMColor dstC[], const SkPMColor cache[],
+                             SkFixed fx, SkFixed dx,
+                             SkFixed fy, SkFixed dy, int count) {
+    radial_span_SSE2<Mirror_Index_SSE2>(dstC, cache, fx, dx, fy, dy, count);
+}
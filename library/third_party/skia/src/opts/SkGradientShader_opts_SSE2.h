@@ -0,0 +1,35 @@
+/*
+ **
+ ** Copyright 2009, The Android Open Source Project
+ **
+ ** Licensed under the Apache License, Version 2.0 (the "License");
+ ** you may not use this file except in compliance with the License.
+ ** You may obtain a copy of the License at
+ **
+ **     http://www.apache.org/licenses/LICENSE-2.0
+ **
+ ** Unless required by applicable law or agreed to in writing, software
+ ** distributed under the License is distributed on an "AS IS" BASIS,
+ ** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ ** See the License for the specific language governing permissions and
+ ** limitations under the License.
+ */
+
+#include "SkGradientSpanProcs.h"
+
+void Linear_Clamp_Span_SSE2(SkPMColor dstC[], const SkPMColor cache[],
+                            SkFixed fx, SkFixed dx, int toggle, int count);
+void Linear_Repeat_Span_SSE2(SkPMColor dstC[], const SkPMColor cache[],
+                             SkFixed fx, SkFixed dx, int toggle, int count);
+void Linear_Mirror_Span_SSE2(SkPMColor dstC[], const SkPMColor cache[],
+                             SkFixed fx, SkFixed dx, int toggle, int count);
+void Radial_Clamp_Span_SSE2(SkPMColor dstC[], const SkPMColor cache[],
+                            const uint8_t sqrtTable[],
+                            SkFixed fx, SkFixed dx,
+                            SkFixed fy, SkFixed dy, int count);
+void Radial_Repeat_Span_SSE2(SkPMColor dstC[], const SkPMColor cache[],
+                             SkFixed fx, SkFixed dx,
+                             SkFixed fy, SkFixed dy, int count);
+void Radial_Mirror_Span_SSE2(SkPMColor dstC[], const SkPMColor cache[],
+                             SkFixed fx, SkFixed dx,
+                             SkFixed fy, SkFixed dy, int count);
@@ -0,0 +1,94 @@
+/*
+ **
+ ** Copyright 2009, The Android Open Source Project
+ **
+ ** Licensed under the Apache License, Version 2.0 (the "License");
+ ** you may not use this file except in compliance with the License.
+ ** You may obtain a copy of the License at
+ **
+ **     http://www.apache.org/licenses/LICENSE-2.0
+ **
+ ** Unless required by applicable law or agreed to in writing, software
+ ** distributed under the License is distributed on an "AS IS" BASIS,
+ ** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ ** See the License for the specific language governing permissions and
+ ** limitations under the License.
+ */
+
+#include "SkScan_AntiPath_opts_SSE2.h"
+#include "SkMath.h"
+
+#include <emmintrin.h>
+
+/* SSE2 versions of the coverage row loops in core/SkScan_AntiPath.cpp */
+
+// Running sum of the 8 lanes, plus the sum carried in from the left.
+static inline __m128i prefix_sum_epi16(__m128i v, __m128i carry) {
+    v = _mm_add_epi16(v, _mm_slli_si128(v, 2));
+    v = _mm_add_epi16(v, _mm_slli_si128(v, 4));
+    v = _mm_add_epi16(v, _mm_slli_si128(v, 8));
+    return _mm_add_epi16(v, carry);
+}
+
+// Broadcast the last lane, to be carried into the next 8.
+static inline __m128i last_lane_epi16(__m128i v) {
+    v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 3, 3, 3));
+    return _mm_unpackhi_epi64(v, v);
+}
+
+int SkScanCoverageAccumulate_SSE2(uint8_t alpha[], int16_t delta[],
+                                  int count, int sum) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i carry = _mm_set1_epi16((short)sum);
+
+    while (count >= 16) {
+        __m128i lo = _mm_loadu_si128((const __m128i*)delta);
+        __m128i hi = _mm_loadu_si128((const __m128i*)(delta + 8));
+        _mm_storeu_si128((__m128i*)delta, zero);
+        _mm_storeu_si128((__m128i*)(delta + 8), zero);
+
+        lo = prefix_sum_epi16(lo, carry);
+        hi = prefix_sum_epi16(hi, last_lane_epi16(lo));
+        carry = last_lane_epi16(hi);
+
+        // 16 subsamples << 4 is 256, which the pack saturates to 255
+        __m128i a = _mm_packus_epi16(_mm_slli_epi16(lo, 4),
+                                     _mm_slli_epi16(hi, 4));
+        _mm_storeu_si128((__m128i*)alpha, a);
+
+        alpha += 16;
+        delta += 16;
+        count -= 16;
+    }
+
+    sum = (int16_t)_mm_cvtsi128_si32(carry);
+    while (count > 0) {
+        sum += *delta;
+        *delta++ = 0;
+        *alpha++ = SkToU8(SkClampMax(sum << 4, 255));
+        count -= 1;
+    }
+    return sum;
+}
+
+int SkScanCoverageRunLength_SSE2(const uint8_t alpha[], int count) {
+    const U8CPU value = alpha[0];
+    const __m128i match = _mm_set1_epi8((char)value);
+    int n = 0;
+
+    while (count - n >= 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(alpha + n));
+        // bit i set where alpha[n + i] differs from alpha[0]
+        uint32_t diff = ~_mm_movemask_epi8(_mm_cmpeq_epi8(a, match)) & 0xFFFF;
+        if (diff) {
+            // count the trailing zeros
+            return n + 31 - SkCLZ(diff & (0 - diff));
+        }
+        n += 16;
+    }
+
+    while (n < count && alpha[n] == value) {
+        n += 1;
+    }
+    return n;
+}
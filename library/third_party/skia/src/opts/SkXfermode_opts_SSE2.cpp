@@ -0,0 +1,319 @@
+/*
+ **
+ ** Copyright 2009, The Android Open Source Project
+ **
+ ** Licensed under the Apache License, Version 2.0 (the "License");
+ ** you may not use this file except in compliance with the License.
+ ** You may obtain a copy of the License at
+ **
+ **     http://www.apache.org/licenses/LICENSE-2.0
+ **
+ ** Unless required by applicable law or agreed to in writing, software
+ ** distributed under the License is distributed on an "AS IS" BASIS,
+ ** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ ** See the License for the specific language governing permissions and
+ ** limitations under the License.
+ */
+
+#include "SkXfermode_opts_SSE2.h"
+#include "SkColorPriv.h"
+
+#include <emmintrin.h>
+
+/* SSE2 versions of the 32bit modeprocs in core/SkXfermode.cpp.
+ *
+ * Pixels are unpacked to 16bit channels, two pixels per register, and every
+ * helper below reproduces the rounding of its scalar counterpart exactly, so
+ * for premultiplied input the results are bit-identical to the portable
+ * xfer32().
+ */
+
+#define SK_A32_LANE         (SK_A32_SHIFT / 8)
+#define SK_A32_LANE_MASK(i) ((i) == SK_A32_LANE ? -1 : 0)
+
+// Copies each pixel's alpha into all four of its 16bit channels.
+static inline __m128i SkGetPackedA32_SSE2(__m128i c) {
+    c = _mm_shufflelo_epi16(c, _MM_SHUFFLE(SK_A32_LANE, SK_A32_LANE,
+                                           SK_A32_LANE, SK_A32_LANE));
+    return _mm_shufflehi_epi16(c, _MM_SHUFFLE(SK_A32_LANE, SK_A32_LANE,
+                                              SK_A32_LANE, SK_A32_LANE));
+}
+
+// Selects the alpha channel from a and the color channels from c.
+static inline __m128i SkReplaceA32_SSE2(__m128i c, __m128i a) {
+    const __m128i mask = _mm_set_epi16(
+            SK_A32_LANE_MASK(3), SK_A32_LANE_MASK(2),
+            SK_A32_LANE_MASK(1), SK_A32_LANE_MASK(0),
+            SK_A32_LANE_MASK(3), SK_A32_LANE_MASK(2),
+            SK_A32_LANE_MASK(1), SK_A32_LANE_MASK(0));
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, c));
+}
+
+// SkAlphaMulQ() per channel, scale is 0..256
+static inline __m128i SkAlphaMulQ_SSE2(__m128i c, __m128i scale) {
+    return _mm_srli_epi16(_mm_mullo_epi16(c, scale), 8);
+}
+
+// SkMulDiv255Round() per channel
+static inline __m128i SkAlphaMulAlpha_SSE2(__m128i a, __m128i b) {
+    __m128i prod = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(prod, _mm_srli_epi16(prod, 8)), 8);
+}
+
+// SkAlphaBlend() per channel, scale is 1..256. (src - dst) * scale needs 17
+// bits, so the signed product is rebuilt from its high and low halves before
+// the arithmetic shift by 8.
+static inline __m128i SkAlphaBlend_SSE2(__m128i src, __m128i dst,
+                                        __m128i scale) {
+    __m128i diff = _mm_sub_epi16(src, dst);
+    __m128i lo = _mm_mullo_epi16(diff, scale);
+    __m128i hi = _mm_mulhi_epi16(diff, scale);
+    return _mm_add_epi16(dst, _mm_or_si128(_mm_slli_epi16(hi, 8),
+                                           _mm_srli_epi16(lo, 8)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct dstover_modeproc_SSE2 {
+    static inline __m128i proc(__m128i src, __m128i dst) {
+        __m128i da = SkGetPackedA32_SSE2(dst);
+        return _mm_add_epi16(dst, SkAlphaMulQ_SSE2(src,
+                                      _mm_sub_epi16(_mm_set1_epi16(256), da)));
+    }
+};
+
+struct srcin_modeproc_SSE2 {
+    static inline __m128i proc(__m128i src, __m128i dst) {
+        __m128i da = SkGetPackedA32_SSE2(dst);
+        return SkAlphaMulQ_SSE2(src, _mm_add_epi16(da, _mm_set1_epi16(1)));
+    }
+};
+
+struct dstin_modeproc_SSE2 {
+    static inline __m128i proc(__m128i src, __m128i dst) {
+        __m128i sa = SkGetPackedA32_SSE2(src);
+        return SkAlphaMulQ_SSE2(dst, _mm_add_epi16(sa, _mm_set1_epi16(1)));
+    }
+};
+
+struct srcout_modeproc_SSE2 {
+    static inline __m128i proc(__m128i src, __m128i dst) {
+        __m128i da = SkGetPackedA32_SSE2(dst);
+        return SkAlphaMulQ_SSE2(src, _mm_sub_epi16(_mm_set1_epi16(256), da));
+    }
+};
+
+struct dstout_modeproc_SSE2 {
+    static inline __m128i proc(__m128i src, __m128i dst) {
+        __m128i sa = SkGetPackedA32_SSE2(src);
+        return SkAlphaMulQ_SSE2(dst, _mm_sub_epi16(_mm_set1_epi16(256), sa));
+    }
+};
+
+struct srcatop_modeproc_SSE2 {
+    static inline __m128i proc(__m128i src, __m128i dst) {
+        __m128i sa = SkGetPackedA32_SSE2(src);
+        __m128i da = SkGetPackedA32_SSE2(dst);
+        __m128i isa = _mm_sub_epi16(_mm_set1_epi16(255), sa);
+        __m128i c = _mm_add_epi16(SkAlphaMulAlpha_SSE2(da, src),
+                                  SkAlphaMulAlpha_SSE2(isa, dst));
+        return SkReplaceA32_SSE2(c, da);
+    }
+};
+
+struct dstatop_modeproc_SSE2 {
+    static inline __m128i proc(__m128i src, __m128i dst) {
+        __m128i sa = SkGetPackedA32_SSE2(src);
+        __m128i da = SkGetPackedA32_SSE2(dst);
+        __m128i ida = _mm_sub_epi16(_mm_set1_epi16(255), da);
+        __m128i c = _mm_add_epi16(SkAlphaMulAlpha_SSE2(ida, src),
+                                  SkAlphaMulAlpha_SSE2(sa, dst));
+        return SkReplaceA32_SSE2(c, sa);
+    }
+};
+
+struct xor_modeproc_SSE2 {
+    static inline __m128i proc(__m128i src, __m128i dst) {
+        __m128i sa = SkGetPackedA32_SSE2(src);
+        __m128i da = SkGetPackedA32_SSE2(dst);
+        __m128i isa = _mm_sub_epi16(_mm_set1_epi16(255), sa);
+        __m128i ida = _mm_sub_epi16(_mm_set1_epi16(255), da);
+        __m128i c = _mm_add_epi16(SkAlphaMulAlpha_SSE2(ida, src),
+                                  SkAlphaMulAlpha_SSE2(isa, dst));
+        __m128i a = _mm_sub_epi16(_mm_add_epi16(sa, da),
+                        _mm_slli_epi16(SkAlphaMulAlpha_SSE2(sa, da), 1));
+        return SkReplaceA32_SSE2(c, a);
+    }
+};
+
+struct plus_modeproc_SSE2 {
+    static inline __m128i proc(__m128i src, __m128i dst) {
+        // the final pack saturates to 255, same as saturated_add()
+        return _mm_add_epi16(src, dst);
+    }
+};
+
+struct multiply_modeproc_SSE2 {
+    static inline __m128i proc(__m128i src, __m128i dst) {
+        return SkAlphaMulAlpha_SSE2(src, dst);
+    }
+};
+
+struct screen_modeproc_SSE2 {
+    static inline __m128i proc(__m128i src, __m128i dst) {
+        return _mm_sub_epi16(_mm_add_epi16(src, dst),
+                             SkAlphaMulAlpha_SSE2(src, dst));
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Applies Mode::proc to four packed pixels.
+template <typename Mode>
+static inline __m128i xfer4_SSE2(__m128i src, __m128i dst) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = Mode::proc(_mm_unpacklo_epi8(src, zero),
+                            _mm_unpacklo_epi8(dst, zero));
+    __m128i hi = Mode::proc(_mm_unpackhi_epi8(src, zero),
+                            _mm_unpackhi_epi8(dst, zero));
+    return _mm_packus_epi16(lo, hi);
+}
+
+// SkFourByteInterp() on four packed pixels, with aa4 holding their coverage
+// in its four bytes. Pixels with zero coverage keep dst.
+static inline __m128i SkFourByteInterp_SSE2(__m128i c, __m128i dst,
+                                            uint32_t aa4) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = _mm_unpacklo_epi8(_mm_cvtsi32_si128(aa4), zero);
+    __m128i skip = _mm_cmpeq_epi32(_mm_unpacklo_epi16(a, zero), zero);
+
+    // a + 1 in every channel of its pixel
+    a = _mm_add_epi16(a, _mm_set1_epi16(1));
+    a = _mm_unpacklo_epi16(a, a);
+    __m128i scale_lo = _mm_unpacklo_epi32(a, a);
+    __m128i scale_hi = _mm_unpackhi_epi32(a, a);
+
+    __m128i lo = SkAlphaBlend_SSE2(_mm_unpacklo_epi8(c, zero),
+                                   _mm_unpacklo_epi8(dst, zero), scale_lo);
+    __m128i hi = SkAlphaBlend_SSE2(_mm_unpackhi_epi8(c, zero),
+                                   _mm_unpackhi_epi8(dst, zero), scale_hi);
+    c = _mm_packus_epi16(lo, hi);
+    return _mm_or_si128(_mm_and_si128(skip, dst), _mm_andnot_si128(skip, c));
+}
+
+template <typename Mode>
+static void xfer32_SSE2(SkPMColor* SK_RESTRICT dst,
+                        const SkPMColor* SK_RESTRICT src, int count,
+                        const SkAlpha* SK_RESTRICT aa) {
+    SkASSERT(dst && src && count >= 0);
+
+    if (NULL == aa) {
+        while (count >= 4) {
+            __m128i s = _mm_loadu_si128((const __m128i*)src);
+            __m128i d = _mm_loadu_si128((const __m128i*)dst);
+            _mm_storeu_si128((__m128i*)dst, xfer4_SSE2<Mode>(s, d));
+            src += 4;
+            dst += 4;
+            count -= 4;
+        }
+        while (count > 0) {
+            __m128i s = _mm_cvtsi32_si128(*src);
+            __m128i d = _mm_cvtsi32_si128(*dst);
+            *dst = _mm_cvtsi128_si32(xfer4_SSE2<Mode>(s, d));
+            src++;
+            dst++;
+            count--;
+        }
+    } else {
+        while (count >= 4) {
+            uint32_t aa4 = aa[0] | (aa[1] << 8) | (aa[2] << 16) |
+                           ((uint32_t)aa[3] << 24);
+            if (0 != aa4) {
+                __m128i s = _mm_loadu_si128((const __m128i*)src);
+                __m128i d = _mm_loadu_si128((const __m128i*)dst);
+                __m128i c = xfer4_SSE2<Mode>(s, d);
+                if (0xFFFFFFFF != aa4) {
+                    c = SkFourByteInterp_SSE2(c, d, aa4);
+                }
+                _mm_storeu_si128((__m128i*)dst, c);
+            }
+            src += 4;
+            dst += 4;
+            aa += 4;
+            count -= 4;
+        }
+        while (count > 0) {
+            unsigned a = *aa;
+            if (0 != a) {
+                __m128i s = _mm_cvtsi32_si128(*src);
+                __m128i d = _mm_cvtsi32_si128(*dst);
+                __m128i c = xfer4_SSE2<Mode>(s, d);
+                if (0xFF != a) {
+                    c = SkFourByteInterp_SSE2(c, d, a);
+                }
+                *dst = _mm_cvtsi128_si32(c);
+            }
+            src++;
+            dst++;
+            aa++;
+            count--;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void dstover_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                         const SkAlpha aa[]) {
+    xfer32_SSE2<dstover_modeproc_SSE2>(dst, src, count, aa);
+}
+
+void srcin_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                       const SkAlpha aa[]) {
+    xfer32_SSE2<srcin_modeproc_SSE2>(dst, src, count, aa);
+}
+
+void dstin_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                       const SkAlpha aa[]) {
+    xfer32_SSE2<dstin_modeproc_SSE2>(dst, src, count, aa);
+}
+
+void srcout_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                        const SkAlpha aa[]) {
+    xfer32_SSE2<srcout_modeproc_SSE2>(dst, src, count, aa);
+}
+
+void dstout_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                        const SkAlpha aa[]) {
+    xfer32_SSE2<dstout_modeproc_SSE2>(dst, src, count, aa);
+}
+
+void srcatop_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                         const SkAlpha aa[]) {
+    xfer32_SSE2<srcatop_modeproc_SSE2>(dst, src, count, aa);
+}
+
+void dstatop_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                         const SkAlpha aa[]) {
+    xfer32_SSE2<dstatop_modeproc_SSE2>(dst, src, count, aa);
+}
+
+void xor_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                     const SkAlpha aa[]) {
+    xfer32_SSE2<xor_modeproc_SSE2>(dst, src, count, aa);
+}
+
+void plus_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                      const SkAlpha aa[]) {
+    xfer32_SSE2<plus_modeproc_SSE2>(dst, src, count, aa);
+}
+
+void multiply_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                          const SkAlpha aa[]) {
+    xfer32_SSE2<multiply_modeproc_SSE2>(dst, src, count, aa);
+}
+
+void screen_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                        const SkAlpha aa[]) {
+    xfer32_SSE2<screen_modeproc_SSE2>(dst, src, count, aa);
+}
@@ -0,0 +1,41 @@
+/*
+ **
+ ** Copyright 2009, The Android Open Source Project
+ **
+ ** Licensed under the Apache License, Version 2.0 (the "License");
+ ** you may not use this file except in compliance with the License.
+ ** You may obtain a copy of the License at
+ **
+ **     http://www.apache.org/licenses/LICENSE-2.0
+ **
+ ** Unless required by applicable law or agreed to in writing, software
+ ** distributed under the License is distributed on an "AS IS" BASIS,
+ ** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ ** See the License for the specific language governing permissions and
+ ** limitations under the License.
+ */
+
+#include "SkXfermode.h"
+
+void dstover_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                         const SkAlpha aa[]);
+void srcin_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                       const SkAlpha aa[]);
+void dstin_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                       const SkAlpha aa[]);
+void srcout_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                        const SkAlpha aa[]);
+void dstout_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                        const SkAlpha aa[]);
+void srcatop_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                         const SkAlpha aa[]);
+void dstatop_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                         const SkAlpha aa[]);
+void xor_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                     const SkAlpha aa[]);
+void plus_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                      const SkAlpha aa[]);
+void multiply_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                          const SkAlpha aa[]);
+void screen_xfer32_SSE2(SkPMColor dst[], const SkPMColor src[], int count,
+                        const SkAlpha aa[]);
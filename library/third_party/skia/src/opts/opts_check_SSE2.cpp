@@ -17,7 +17,11 @@
 
 #include "SkBitmapProcState_opts_SSE2.h"
 #include "SkBlitRow_opts_SSE2.h"
+#include "SkBlurMask_opts_SSE2.h"
+#include "SkGradientShader_opts_SSE2.h"
+#include "SkScan_AntiPath_opts_SSE2.h"
 #include "SkUtils_opts_SSE2.h"
+#include "SkXfermode_opts_SSE2.h"
 #include "SkUtils.h"
 
 /* This file must *not* be compiled with -msse or -msse2, otherwise
@@ -140,3 +144,56 @@ SkMemset32Proc SkMemset32GetPlatformProc() {
         return NULL;
     }
 }
+
+static SkXfermode::Proc32 platform_xfer32_procs[] = {
+    NULL,                               // kClear_Mode
+    NULL,                               // kSrc_Mode
+    NULL,                               // kDst_Mode
+    NULL,                               // kSrcOver_Mode
+    dstover_xfer32_SSE2,                // kDstOver_Mode
+    srcin_xfer32_SSE2,                  // kSrcIn_Mode
+    dstin_xfer32_SSE2,                  // kDstIn_Mode
+    srcout_xfer32_SSE2,                 // kSrcOut_Mode
+    dstout_xfer32_SSE2,                 // kDstOut_Mode
+    srcatop_xfer32_SSE2,                // kSrcATop_Mode
+    dstatop_xfer32_SSE2,                // kDstATop_Mode
+    xor_xfer32_SSE2,                    // kXor_Mode
+    plus_xfer32_SSE2,                   // kPlus_Mode
+    multiply_xfer32_SSE2,               // kMultiply_Mode
+    screen_xfer32_SSE2,                 // kScreen_Mode
+};
+
+SkXfermode::Proc32 SkXfermode::PlatformProcs32(Mode mode) {
+    if (hasSSE2() &&
+            (unsigned)mode < SK_ARRAY_COUNT(platform_xfer32_procs)) {
+        return platform_xfer32_procs[mode];
+    } else {
+        return NULL;
+    }
+}
+
+void SkGradientSpanGetPlatformProcs(SkGradientSpanProcs* procs) {
+    if (hasSSE2()) {
+        procs->fLinearClamp = Linear_Clamp_Span_SSE2;
+        procs->fLinearRepeat = Linear_Repeat_Span_SSE2;
+        procs->fLinearMirror = Linear_Mirror_Span_SSE2;
+        procs->fRadialClamp = Radial_Clamp_Span_SSE2;
+        procs->fRadialRepeat = Radial_Repeat_Span_SSE2;
+        procs->fRadialMirror = Radial_Mirror_Span_SSE2;
+    }
+}
+
+void SkBoxBlurGetPlatformProcs(SkBoxBlurProcs* procs) {
+    if (hasSSE2()) {
+        procs->fAccumulate = SkBoxBlurAccumulate_SSE2;
+        procs->fScale = SkBoxBlurScale_SSE2;
+        procs->fScaleInterp = SkBoxBlurScaleInterp_SSE2;
+    }
+}
+
+void SkScanCoverageGetPlatformProcs(SkScanCoverageProcs* procs) {
+    if (hasSSE2()) {
+        procs->fAccumulate = SkScanCoverageAccumulate_SSE2;
+        procs->fRunLength = SkScanCoverageRunLength_SSE2;
+    }
+}
@@ -29,6 +29,11 @@ int32_t sk_atomic_dec(int32_t* addr)
     return InterlockedDecrement(reinterpret_cast<LONG*>(addr)) + 1;
 }
 
+void* sk_atomic_cas_ptr(void* volatile* addr, void* oldValue, void* newValue)
+{
+    return InterlockedCompareExchangePointer(addr, newValue, oldValue);
+}
+
 SkMutex::SkMutex(bool /* isGlobal */)
 {
     SK_COMPILE_ASSERT(sizeof(fStorage) > sizeof(CRITICAL_SECTION),
@@ -51,3 +56,94 @@ void SkMutex::release()
     LeaveCriticalSection(reinterpret_cast<CRITICAL_SECTION*>(&fStorage));
 }
 
+
+///////////////////////////////////////////////////////////////////////////////
+
+static SkThreadLocal* volatile gThreadLocalHead;
+
+SkThreadLocal::SkThreadLocal(ExitProc exitProc) : fExitProc(exitProc)
+{
+    fIndex = TlsAlloc();
+    SkASSERT(TLS_OUT_OF_INDEXES != fIndex);
+
+    // push onto the list walked by ThreadExit(), without a lock since static
+    // instances can be constructed before anything else is ready
+    SkThreadLocal* head;
+    do {
+        head = gThreadLocalHead;
+        fNext = head;
+    } while (sk_atomic_cas_ptr(
+                 reinterpret_cast<void* volatile*>(&gThreadLocalHead),
+                 head, this) != head);
+}
+
+SkThreadLocal::~SkThreadLocal()
+{
+    if (TLS_OUT_OF_INDEXES != fIndex) {
+        TlsFree(fIndex);
+        fIndex = TLS_OUT_OF_INDEXES;
+    }
+}
+
+void* SkThreadLocal::get() const
+{
+    if (TLS_OUT_OF_INDEXES == fIndex) {
+        return NULL;
+    }
+    return TlsGetValue(fIndex);
+}
+
+void SkThreadLocal::set(void* value)
+{
+    if (TLS_OUT_OF_INDEXES != fIndex) {
+        TlsSetValue(fIndex, value);
+    }
+}
+
+void SkThreadLocal::ThreadExit()
+{
+    for (SkThreadLocal* rec = gThreadLocalHead; rec; rec = rec->fNext) {
+        if (TLS_OUT_OF_INDEXES == rec->fIndex || NULL == rec->fExitProc) {
+            continue;
+        }
+        void* value = TlsGetValue(rec->fIndex);
+        if (value) {
+            TlsSetValue(rec->fIndex, NULL);
+            rec->fExitProc(value);
+        }
+    }
+}
+
+// Windows TLS has no per-thread destructor, so register a TLS callback with
+// the loader to get told about each thread's exit. Only DLL_THREAD_DETACH is
+// handled; at process exit our statics may already have been destroyed.
+// The callback runs under the loader lock, so exit procs must not block.
+// See VC\crt\src\tlssup.c for reference.
+#ifdef _WIN64
+#pragma comment(linker, "/INCLUDE:_tls_used")
+#pragma comment(linker, "/INCLUDE:sk_thread_exit_callback")
+#else
+#pragma comment(linker, "/INCLUDE:__tls_used")
+#pragma comment(linker, "/INCLUDE:_sk_thread_exit_callback")
+#endif
+
+static void NTAPI sk_on_thread_exit(PVOID module, DWORD reason, PVOID reserved)
+{
+    if (DLL_THREAD_DETACH == reason) {
+        SkThreadLocal::ThreadExit();
+    }
+}
+
+extern "C" {
+#ifdef _WIN64
+    // .CRT is merged with .rdata on x64, so this must be constant data
+#pragma const_seg(".CRT$XLB")
+    extern const PIMAGE_TLS_CALLBACK sk_thread_exit_callback;
+    const PIMAGE_TLS_CALLBACK sk_thread_exit_callback = sk_on_thread_exit;
+#pragma const_seg()
+#else
+#pragma data_seg(".CRT$XLB")
+    PIMAGE_TLS_CALLBACK sk_thread_exit_callback = sk_on_thread_exit;
+#pragma data_seg()
+#endif
+}
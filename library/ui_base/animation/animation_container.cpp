@@ -3,6 +3,7 @@
 
 #include "animation_container_element.h"
 #include "animation_container_observer.h"
+#include "animation_frame_clock.h"
 
 using base::TimeDelta;
 using base::TimeTicks;
@@ -27,11 +28,12 @@ namespace ui
         if(elements_.empty())
         {
             last_tick_time_ = TimeTicks::Now();
-            SetMinTimerInterval(element->GetTimerInterval());
+            min_timer_interval_ = element->GetTimerInterval();
+            AnimationFrameClock::GetInstance()->AddContainer(this);
         }
         else if(element->GetTimerInterval() < min_timer_interval_)
         {
-            SetMinTimerInterval(element->GetTimerInterval());
+            min_timer_interval_ = element->GetTimerInterval();
         }
 
         element->SetStartTime(last_tick_time_);
@@ -46,7 +48,7 @@ namespace ui
 
         if(elements_.empty())
         {
-            timer_.Stop();
+            AnimationFrameClock::GetInstance()->RemoveContainer(this);
             if(observer_)
             {
                 observer_->AnimationContainerEmpty(this);
@@ -54,23 +56,27 @@ namespace ui
         }
         else
         {
-            TimeDelta min_timer_interval = GetMinInterval();
-            if(min_timer_interval > min_timer_interval_)
-            {
-                SetMinTimerInterval(min_timer_interval);
-            }
+            min_timer_interval_ = GetMinInterval();
         }
     }
 
-    void AnimationContainer::Run()
+    void AnimationContainer::OnFrame(TimeTicks frame_time)
+    {
+        // ڰ֮֡Ҳ㵽, Դ֡ԪҪһ֡ƽһ.
+        if(frame_time-last_tick_time_+AnimationFrameClock::GetFrameInterval()/2 >=
+            min_timer_interval_)
+        {
+            Run(frame_time);
+        }
+    }
+
+    void AnimationContainer::Run(TimeTicks current_time)
     {
         // ڸԪغ֪ͨ۲. Ԫڸʱɾ, ôǵü
         // Ϊ0, ֪ͨ۲ߺҲᱻɾ. һñ֤Ԫغ
         // ǺϷ.
         scoped_refptr<AnimationContainer> this_ref(this);
 
-        TimeTicks current_time = TimeTicks::Now();
-
         last_tick_time_ = current_time;
 
         // һڱ, ڵStepʱƳκԪض.
@@ -91,15 +97,6 @@ namespace ui
         }
     }
 
-    void AnimationContainer::SetMinTimerInterval(base::TimeDelta delta)
-    {
-        // Ǻ͵ǰԪصʱ, ʹAnimation/AnimationContainer˵
-        // .
-        timer_.Stop();
-        min_timer_interval_ = delta;
-        timer_.Start(min_timer_interval_, this, &AnimationContainer::Run);
-    }
-
     TimeDelta AnimationContainer::GetMinInterval()
     {
         DCHECK(!elements_.empty());
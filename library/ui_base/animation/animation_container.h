@@ -6,7 +6,8 @@
 
 #include <set>
 
-#include "base/timer.h"
+#include "base/memory/ref_counted.h"
+#include "base/time.h"
 
 namespace ui
 {
@@ -21,16 +22,19 @@ namespace ui
     //
     // AnimationContainerʹü. ÿAnimationڲ
     // AnimationContainer.
+    //
+    // ûʱ, ʱAnimationFrameClock֡ƽ, ϴƽԪ
+    // Сʱ֡ƽ.
     class AnimationContainer : public base::RefCounted<AnimationContainer>
     {
     public:
         AnimationContainer();
 
-        // AnimationҪʱ. бҪʱ.
+        // AnimationҪʱ. бҪ֡ʱ.
         // ע: AnimationԶ, Ҫֱӵ.
         void Start(AnimationContainerElement* animation);
 
-        // AnimationҪֹͣʱ. ûanimations, ֹͣʱ.
+        // AnimationҪֹͣʱ. ûanimations, 뿪֡ʱ.
         // ע: AnimationԶ, Ҫֱӵ.
         void Stop(AnimationContainerElement* animation);
 
@@ -46,17 +50,18 @@ namespace ui
         bool is_running() const { return !elements_.empty(); }
 
     private:
+        friend class AnimationFrameClock;
         friend class base::RefCounted<AnimationContainer>;
 
         typedef std::set<AnimationContainerElement*> Elements;
 
         ~AnimationContainer();
 
-        // Timerص.
-        void Run();
+        // AnimationFrameClockÿ֡. , |frame_time|ƽԪ.
+        void OnFrame(base::TimeTicks frame_time);
 
-        // min_timer_interval_ʱ.
-        void SetMinTimerInterval(base::TimeDelta delta);
+        // |current_time|ƽԪ.
+        void Run(base::TimeTicks current_time);
 
         // ʱӵСʱ.
         base::TimeDelta GetMinInterval();
@@ -69,11 +74,9 @@ namespace ui
         // Ԫ(animations).
         Elements elements_;
 
-        // ʱеСʱ.
+        // ԪصСʱ.
         base::TimeDelta min_timer_interval_;
 
-        base::RepeatingTimer<AnimationContainer> timer_;
-
         AnimationContainerObserver* observer_;
 
         DISALLOW_COPY_AND_ASSIGN(AnimationContainer);
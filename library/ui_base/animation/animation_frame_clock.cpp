@@ -0,0 +1,83 @@
+#include "animation_frame_clock.h"
+
+#include "base/metric/histogram.h"
+
+#include "animation_container.h"
+
+using base::TimeDelta;
+using base::TimeTicks;
+
+namespace ui
+{
+
+    // static
+    AnimationFrameClock* AnimationFrameClock::GetInstance()
+    {
+        return Singleton<AnimationFrameClock>::get();
+    }
+
+    // static
+    TimeDelta AnimationFrameClock::GetFrameInterval()
+    {
+        return TimeDelta::FromMicroseconds(1000000 / 60);
+    }
+
+    void AnimationFrameClock::AddContainer(AnimationContainer* container)
+    {
+        DCHECK(containers_.count(container) == 0);
+
+        if(containers_.empty())
+        {
+            last_tick_time_ = TimeTicks::Now();
+            timer_.Start(GetFrameInterval(), this, &AnimationFrameClock::Tick);
+        }
+        containers_.insert(container);
+    }
+
+    void AnimationFrameClock::RemoveContainer(AnimationContainer* container)
+    {
+        DCHECK(containers_.count(container) > 0);
+
+        containers_.erase(container);
+        if(containers_.empty())
+        {
+            timer_.Stop();
+        }
+    }
+
+    AnimationFrameClock::AnimationFrameClock()
+        : frame_count_(0), dropped_frame_count_(0) {}
+
+    AnimationFrameClock::~AnimationFrameClock() {}
+
+    void AnimationFrameClock::Tick()
+    {
+        TimeTicks frame_time = TimeTicks::Now();
+
+        // 뵽֡, ʱĶ.
+        const TimeDelta frame_interval = GetFrameInterval();
+        int64 frames = (frame_time - last_tick_time_ + frame_interval / 2) /
+            frame_interval;
+        int dropped_frames = frames>1 ? static_cast<int>(frames-1) : 0;
+        last_tick_time_ = frame_time;
+        ++frame_count_;
+        dropped_frame_count_ += dropped_frames;
+        UMA_HISTOGRAM_COUNTS_100("Animation.DroppedFrames", dropped_frames);
+
+        // ƽʱֹͣɾ, Աһ, ƽǰȷ
+        // .
+        Containers containers = containers_;
+        for(Containers::const_iterator i=containers.begin();
+            i!=containers.end(); ++i)
+        {
+            if(containers_.find(*i) != containers_.end())
+            {
+                (*i)->OnFrame(frame_time);
+            }
+        }
+
+        last_frame_time_ = TimeTicks::Now() - frame_time;
+        UMA_HISTOGRAM_TIMES("Animation.FrameTime", last_frame_time_);
+    }
+
+} //namespace ui
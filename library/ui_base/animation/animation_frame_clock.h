@@ -0,0 +1,71 @@
+#ifndef __ui_base_animation_frame_clock_h__
+#define __ui_base_animation_frame_clock_h__
+
+#pragma once
+
+#include <set>
+
+#include "base/memory/singleton.h"
+#include "base/timer.h"
+
+namespace ui
+{
+
+    class AnimationContainer;
+
+    // еAnimationContainerõ֡ʱ. ʱӰ̶֡, ÿ֡
+    // ͬһƽеڵ, õSchedulePaintϲͬ
+    // һλ, ԻUI̡߳Ի.
+    //
+    // ֻUI߳ʹ.
+    class AnimationFrameClock
+    {
+    public:
+        static AnimationFrameClock* GetInstance();
+
+        // ֡(60֡ÿ).
+        static base::TimeDelta GetFrameInterval();
+
+        // ʼʱ, ֹͣʱƳ. һʱʱ, һ
+        // Ƴʱֹͣʱ.
+        // ע: AnimationContainerԶ, Ҫֱӵ.
+        void AddContainer(AnimationContainer* container);
+        void RemoveContainer(AnimationContainer* container);
+
+        // ֡ͳ. ÿʱһ֡; һ֡ʱ, м֡
+        // ֡. ͬʱ¼"Animation.FrameTime""Animation.DroppedFrames"ֱͼ.
+        int frame_count() const { return frame_count_; }
+        int dropped_frame_count() const { return dropped_frame_count_; }
+
+        // һ֡ƽõʱ.
+        base::TimeDelta last_frame_time() const { return last_frame_time_; }
+
+    private:
+        friend struct DefaultSingletonTraits<AnimationFrameClock>;
+
+        typedef std::set<AnimationContainer*> Containers;
+
+        AnimationFrameClock();
+        ~AnimationFrameClock();
+
+        // ʱӻص.
+        void Tick();
+
+        // е.
+        Containers containers_;
+
+        // һʱ. ʱʱΪʱ.
+        base::TimeTicks last_tick_time_;
+
+        int frame_count_;
+        int dropped_frame_count_;
+        base::TimeDelta last_frame_time_;
+
+        base::RepeatingTimer<AnimationFrameClock> timer_;
+
+        DISALLOW_COPY_AND_ASSIGN(AnimationFrameClock);
+    };
+
+} //namespace ui
+
+#endif //__ui_base_animation_frame_clock_h__
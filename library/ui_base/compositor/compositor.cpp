@@ -1,12 +1,59 @@
 
 #include "compositor.h"
 
+#include <algorithm>
+
 #include "compositor_observer.h"
 #include "layer.h"
 
 namespace ui
 {
 
+    double LayerAnimationParams::GetStateAt(base::TimeTicks time) const
+    {
+        if(duration <= base::TimeDelta())
+        {
+            return 1.0;
+        }
+
+        double state = (time - start_time).InMillisecondsF() /
+            duration.InMillisecondsF();
+        state = std::max(0.0, std::min(state, 1.0));
+        return Tween::CalculateValue(tween_type, state);
+    }
+
+    gfx::Transform LayerAnimationParams::GetTransform(double state) const
+    {
+        if(state >= 1.0)
+        {
+            return target_transform;
+        }
+
+        gfx::Transform transform;
+        for(int row=0; row<4; ++row)
+        {
+            for(int col=0; col<4; ++col)
+            {
+                transform.matrix().set(row, col, static_cast<SkMScalar>(
+                    Tween::ValueBetween(state,
+                    start_transform.matrix().get(row, col),
+                    target_transform.matrix().get(row, col))));
+            }
+        }
+        return transform;
+    }
+
+    float LayerAnimationParams::GetOpacity(double state) const
+    {
+        if(state >= 1.0)
+        {
+            return target_opacity;
+        }
+
+        return static_cast<float>(
+            Tween::ValueBetween(state, start_opacity, target_opacity));
+    }
+
     Compositor::Compositor(CompositorDelegate* delegate, const gfx::Size& size)
         : delegate_(delegate),
         size_(size),
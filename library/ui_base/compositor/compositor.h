@@ -6,10 +6,13 @@
 
 #include "base/memory/ref_counted.h"
 #include "base/observer_list.h"
+#include "base/time.h"
 
 #include "ui_gfx/size.h"
 #include "ui_gfx/transform.h"
 
+#include "ui_base/animation/tween.h"
+
 class SkCanvas;
 
 namespace gfx
@@ -24,10 +27,12 @@ namespace ui
 
     class CompositorObserver;
     class Layer;
+    class TextureSkia;
 
     struct TextureDrawParams
     {
-        TextureDrawParams() : transform(), blend(false), compositor_size() {}
+        TextureDrawParams() : transform(), blend(false), opacity(1.0f),
+            compositor_size() {}
 
         // The transform to be applied to the texture.
         gfx::Transform transform;
@@ -36,18 +41,57 @@ namespace ui
         // Otherwise, the drawn pixels clobber the old pixels.
         bool blend;
 
+        // The opacity the texture is drawn with, in the range [0, 1]. Anything
+        // below 1 implies blending.
+        float opacity;
+
         // The size of the surface that the texture is drawn to.
         gfx::Size compositor_size;
 
         // Copy and assignment are allowed.
     };
 
+    // A transform or opacity animation of a layer that the compositor runs by
+    // itself. See Compositor::StartLayerAnimation().
+    struct LayerAnimationParams
+    {
+        enum Property
+        {
+            TRANSFORM,
+            OPACITY
+        };
+
+        LayerAnimationParams() : property(TRANSFORM), start_opacity(1.0f),
+            target_opacity(1.0f), tween_type(Tween::LINEAR) {}
+
+        // Returns the tweened progress, in the range [0, 1], at |time|.
+        double GetStateAt(base::TimeTicks time) const;
+
+        // Returns the value of the animated property at |state|.
+        gfx::Transform GetTransform(double state) const;
+        float GetOpacity(double state) const;
+
+        Property property;
+
+        gfx::Transform start_transform;
+        gfx::Transform target_transform;
+
+        float start_opacity;
+        float target_opacity;
+
+        base::TimeTicks start_time;
+        base::TimeDelta duration;
+        Tween::Type tween_type;
+
+        // Copy and assignment are allowed.
+    };
+
     // Textures are created by a Compositor for managing an accelerated view.
     // Any time a View with a texture needs to redraw itself it invokes SetCanvas().
     // When the view is ready to be drawn Draw() is invoked.
     //
-    // Texture is really a proxy to the gpu. Texture does not itself keep a copy of
-    // the bitmap.
+    // A gpu-backed Texture is only a proxy and keeps no copy of the bitmap. The
+    // software TextureSkia keeps its own copy of the pixels, split into tiles.
     //
     // Views own the Texture.
     class Texture : public base::RefCounted<Texture>
@@ -63,6 +107,10 @@ namespace ui
         virtual void Draw(const ui::TextureDrawParams& params,
             const gfx::Rect& bounds_in_texture) = 0;
 
+        // Returns the TextureSkia if this is one, NULL otherwise.
+        virtual TextureSkia* AsTextureSkia() { return NULL; }
+        virtual const TextureSkia* AsTextureSkia() const { return NULL; }
+
     protected:
         virtual ~Texture() {}
 
@@ -96,6 +144,22 @@ namespace ui
         // Blurs the specific region in the compositor.
         virtual void Blur(const gfx::Rect& bounds) = 0;
 
+        // Runs |params| for |layer| on the compositor's own thread, which composes
+        // the frames of the animation from a snapshot of the layer tree without
+        // waiting for the UI thread. The layer itself isn't changed: the caller
+        // sets the final value once the animation is over and then stops it.
+        // Returns an id for StopLayerAnimation(), or 0 if this compositor can't
+        // animate layers and the caller has to step the animation itself.
+        //
+        // The snapshot holds layers only, so Blur() does nothing while any such
+        // animation runs: blurred regions show unblurred until it stops.
+        virtual int StartLayerAnimation(const Layer* layer,
+            const LayerAnimationParams& params) { return 0; }
+
+        // Stops the animation |id| returned by StartLayerAnimation(). The layer is
+        // drawn with its own value again from the next frame on.
+        virtual void StopLayerAnimation(int id) {}
+
         // Schedules a paint on the widget this Compositor was created for.
         void SchedulePaint()
         {
@@ -144,6 +208,8 @@ namespace ui
 
         CompositorDelegate* delegate() { return delegate_; }
 
+        Layer* root_layer() { return root_layer_; }
+
     private:
         // Notifies the compositor that compositing is about to start. See Draw() for
         // notes about |force_clear|.
@@ -0,0 +1,1111 @@
+#include "compositor_skia.h"
+
+#include <algorithm>
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/logging.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/sys_info.h"
+#include "base/threading/thread.h"
+#include "base/threading/worker_pool.h"
+
+#include "SkCanvas.h"
+#include "SkDevice.h"
+
+#include "skia/ext/platform_canvas.h"
+
+#include "ui_gfx/canvas_skia.h"
+#include "ui_gfx/rect.h"
+#include "ui_gfx/skia_util.h"
+
+#include "layer.h"
+
+namespace
+{
+
+    // Blur() downsamples by this factor and scales back up with filtering.
+    const int kBlurDownsample = 4;
+
+    // Edge length of the backbuffer tiles rasterized by one job.
+    const int kRasterTileSize = 256;
+
+    // Time between the frames of layer animations on the compositor thread.
+    const int kAnimationFrameIntervalMs = 16;
+
+}
+
+namespace ui
+{
+
+    TextureSkia::TextureSkia(CompositorSkia* compositor)
+        : compositor_(compositor),
+        tiles_across_(0),
+        tiles_down_(0) {}
+
+    TextureSkia::~TextureSkia() {}
+
+    void TextureSkia::SetCanvas(const SkCanvas& canvas,
+        const gfx::Point& origin,
+        const gfx::Size& overall_size)
+    {
+        // The raster jobs of the last frame may still read the tiles.
+        compositor_->WaitForRaster();
+        base::AutoLock lock(compositor_->lock());
+        Resize(overall_size);
+
+        // Pictures queued before this paint have to land below it.
+        if(!pictures_.empty())
+        {
+            Pictures pictures;
+            std::vector<int> tiles;
+            TakePictures(&pictures, &tiles);
+            for(size_t i=0; i<tiles.size(); ++i)
+            {
+                PlayPictures(tiles[i], pictures);
+                compositor_->DidUpdateTile();
+            }
+        }
+
+        const SkBitmap& source =
+            const_cast<SkCanvas&>(canvas).getDevice()->accessBitmap(false);
+        SkAutoLockPixels source_lock(source);
+        if(!source.getPixels())
+        {
+            return;
+        }
+
+        gfx::Rect updated(origin.x(), origin.y(), source.width(), source.height());
+        updated = updated.Intersect(gfx::Rect(size_));
+        if(updated.IsEmpty())
+        {
+            return;
+        }
+
+        int first_x, last_x, first_y, last_y;
+        GetTileRange(updated, &first_x, &last_x, &first_y, &last_y);
+        for(int tile_y=first_y; tile_y<=last_y; ++tile_y)
+        {
+            for(int tile_x=first_x; tile_x<=last_x; ++tile_x)
+            {
+                gfx::Rect tile_bounds = GetTileBounds(tile_x, tile_y);
+                gfx::Rect copy = tile_bounds.Intersect(updated);
+                SkBitmap* tile = GetTile(tile_x, tile_y);
+                SkAutoLockPixels tile_lock(*tile);
+
+                size_t row_bytes = copy.width() * sizeof(uint32_t);
+                for(int y=copy.y(); y<copy.bottom(); ++y)
+                {
+                    memcpy(tile->getAddr32(copy.x() - tile_bounds.x(),
+                        y - tile_bounds.y()),
+                        source.getAddr32(copy.x() - origin.x(), y - origin.y()),
+                        row_bytes);
+                }
+                tile->notifyPixelsChanged();
+                compositor_->DidUpdateTile();
+            }
+        }
+    }
+
+    void TextureSkia::SetPicture(SkPicture* picture,
+        const gfx::Point& origin,
+        const gfx::Size& overall_size)
+    {
+        if(overall_size != size_)
+        {
+            // The raster jobs of the last frame may still read the tile grid.
+            compositor_->WaitForRaster();
+            base::AutoLock lock(compositor_->lock());
+            Resize(overall_size);
+        }
+
+        Picture entry;
+        entry.bounds = gfx::Rect(origin,
+            gfx::Size(picture->width(), picture->height())).Intersect(
+            gfx::Rect(size_));
+        if(entry.bounds.IsEmpty())
+        {
+            return;
+        }
+        entry.picture = picture;
+        entry.origin = origin;
+
+        if(pictures_.empty())
+        {
+            compositor_->DidQueuePictures(this);
+        }
+        pictures_.push_back(entry);
+    }
+
+    void TextureSkia::Draw(const ui::TextureDrawParams& params,
+        const gfx::Rect& bounds_in_texture)
+    {
+        gfx::Rect region = bounds_in_texture.Intersect(gfx::Rect(size_));
+        if(region.IsEmpty() || params.opacity<=0.0f)
+        {
+            return;
+        }
+
+        compositor_->RecordDraw(this, params, region);
+    }
+
+    void TextureSkia::Rasterize(SkCanvas* canvas,
+        const SkMatrix& matrix,
+        const gfx::Rect& region,
+        bool blend,
+        U8CPU alpha) const
+    {
+        canvas->save();
+        canvas->concat(matrix);
+        canvas->clipRect(gfx::RectToSkRect(region));
+
+        SkPaint paint;
+        paint.setXfermodeMode(blend ? SkXfermode::kSrcOver_Mode :
+            SkXfermode::kSrc_Mode);
+        paint.setAlpha(alpha);
+        // Only pay for filtering when pixels don't map one to one.
+        paint.setFilterBitmap(
+            (matrix.getType() & ~SkMatrix::kTranslate_Mask) != 0);
+
+        int first_x, last_x, first_y, last_y;
+        GetTileRange(region, &first_x, &last_x, &first_y, &last_y);
+        for(int tile_y=first_y; tile_y<=last_y; ++tile_y)
+        {
+            for(int tile_x=first_x; tile_x<=last_x; ++tile_x)
+            {
+                if(tiles_[tile_y * tiles_across_ + tile_x].isNull())
+                {
+                    continue;
+                }
+
+                // Drawing locks the bitmap's pixels, and SkBitmap counts its locks
+                // without synchronization. Each call draws from its own shallow
+                // copy; the pixel ref behind it locks under a mutex.
+                SkBitmap tile(tiles_[tile_y * tiles_across_ + tile_x]);
+                gfx::Rect tile_bounds = GetTileBounds(tile_x, tile_y);
+                canvas->drawBitmap(tile, SkIntToScalar(tile_bounds.x()),
+                    SkIntToScalar(tile_bounds.y()), &paint);
+            }
+        }
+
+        canvas->restore();
+    }
+
+    void TextureSkia::TakePictures(Pictures* pictures, std::vector<int>* tiles)
+    {
+        std::vector<bool> touched(tiles_.size(), false);
+        for(size_t i=0; i<pictures_.size(); ++i)
+        {
+            int first_x, last_x, first_y, last_y;
+            GetTileRange(pictures_[i].bounds, &first_x, &last_x, &first_y, &last_y);
+            for(int tile_y=first_y; tile_y<=last_y; ++tile_y)
+            {
+                for(int tile_x=first_x; tile_x<=last_x; ++tile_x)
+                {
+                    int index = tile_y * tiles_across_ + tile_x;
+                    if(!touched[index])
+                    {
+                        touched[index] = true;
+                        GetTile(tile_x, tile_y);
+                        tiles->push_back(index);
+                    }
+                }
+            }
+        }
+
+        pictures->swap(pictures_);
+        pictures_.clear();
+    }
+
+    void TextureSkia::PlayPictures(int tile_index, const Pictures& pictures)
+    {
+        gfx::Rect tile_bounds = GetTileBounds(tile_index % tiles_across_,
+            tile_index / tiles_across_);
+
+        // Drawn through a copy for the same reason as in Rasterize().
+        SkBitmap tile(tiles_[tile_index]);
+        SkCanvas canvas(tile);
+        canvas.translate(SkIntToScalar(-tile_bounds.x()),
+            SkIntToScalar(-tile_bounds.y()));
+        for(size_t i=0; i<pictures.size(); ++i)
+        {
+            const Picture& entry = pictures[i];
+            if(!entry.bounds.Intersects(tile_bounds))
+            {
+                continue;
+            }
+
+            canvas.save();
+            canvas.clipRect(gfx::RectToSkRect(entry.bounds));
+            // Like SetCanvas(), a picture replaces the pixels it covers.
+            canvas.drawColor(SK_ColorBLACK, SkXfermode::kClear_Mode);
+            canvas.translate(SkIntToScalar(entry.origin.x()),
+                SkIntToScalar(entry.origin.y()));
+            // Playback moves a read position kept in the picture, so every job
+            // plays its own copy.
+            SkPicture copy(*entry.picture);
+            copy.draw(&canvas);
+            canvas.restore();
+        }
+        tile.notifyPixelsChanged();
+    }
+
+    void TextureSkia::Resize(const gfx::Size& size)
+    {
+        if(size == size_)
+        {
+            return;
+        }
+
+        size_ = size;
+        tiles_across_ = (size.width() + kTileSize - 1) / kTileSize;
+        tiles_down_ = (size.height() + kTileSize - 1) / kTileSize;
+        tiles_.clear();
+        tiles_.resize(tiles_across_ * tiles_down_);
+        // They were recorded for the old size.
+        pictures_.clear();
+    }
+
+    gfx::Rect TextureSkia::GetTileBounds(int tile_x, int tile_y) const
+    {
+        gfx::Rect bounds(tile_x * kTileSize, tile_y * kTileSize,
+            kTileSize, kTileSize);
+        return bounds.Intersect(gfx::Rect(size_));
+    }
+
+    void TextureSkia::GetTileRange(const gfx::Rect& rect, int* first_x,
+        int* last_x, int* first_y, int* last_y) const
+    {
+        *first_x = rect.x() / kTileSize;
+        *last_x = (rect.right() - 1) / kTileSize;
+        *first_y = rect.y() / kTileSize;
+        *last_y = (rect.bottom() - 1) / kTileSize;
+    }
+
+    SkBitmap* TextureSkia::GetTile(int tile_x, int tile_y)
+    {
+        SkBitmap* tile = &tiles_[tile_y * tiles_across_ + tile_x];
+        if(tile->isNull())
+        {
+            gfx::Rect bounds = GetTileBounds(tile_x, tile_y);
+            tile->setConfig(SkBitmap::kARGB_8888_Config,
+                bounds.width(), bounds.height());
+            tile->allocPixels();
+            tile->eraseARGB(0, 0, 0, 0);
+        }
+        return tile;
+    }
+
+    // The work of one frame for the raster jobs: first the texture tiles to play
+    // pictures into, then the backbuffer tiles to composite.
+    struct CompositorSkia::RasterBatch
+    {
+        RasterBatch()
+            : clear(false),
+            composite(false),
+            submitted(false),
+            next_update(0),
+            pending_updates(0),
+            next_tile(0),
+            pending_jobs(0),
+            updates_done(true, false),
+            done(true, false) {}
+
+        struct TileUpdate
+        {
+            TextureSkia* texture;
+            int tile_index;
+            // Index into |pictures|.
+            size_t pictures_index;
+        };
+
+        std::vector<TextureSkia::Pictures> pictures;
+        std::vector<TileUpdate> updates;
+        std::vector<DrawOp> draw_ops;
+        std::vector<gfx::Rect> tiles;
+        // Clear the backbuffer tiles before compositing.
+        bool clear;
+        // The batch finishes a frame, which is presented and counted.
+        bool composite;
+        // Handed over by SubmitFrame(); nobody waits for the jobs.
+        bool submitted;
+        base::TimeTicks frame_start;
+
+        volatile base::subtle::Atomic32 next_update;
+        volatile base::subtle::Atomic32 pending_updates;
+        volatile base::subtle::Atomic32 next_tile;
+        volatile base::subtle::Atomic32 pending_jobs;
+        base::WaitableEvent updates_done;
+        base::WaitableEvent done;
+    };
+
+    CompositorSkia::CompositorSkia(CompositorDelegate* delegate,
+        HWND widget,
+        const gfx::Size& size)
+        : Compositor(delegate, size),
+        widget_(widget),
+        clear_pending_(false),
+        raster_pending_(false),
+        raster_idle_(true, true),
+        animation_tick_pending_(false),
+        next_animation_id_(1),
+        committing_(false),
+        frame_count_(0),
+        updated_tile_count_(0),
+        rasterized_tile_count_(0),
+        threaded_frame_count_(0)
+    {
+        OnWidgetSizeChanged();
+    }
+
+    CompositorSkia::~CompositorSkia()
+    {
+        // Pending ticks are dropped, not run, so nothing touches |this| once the
+        // thread is gone.
+        if(animation_thread_.get())
+        {
+            animation_thread_->Stop();
+        }
+
+        // The last job of a submitted frame still uses |this|.
+        WaitForRaster();
+    }
+
+    Texture* CompositorSkia::CreateTexture()
+    {
+        return new TextureSkia(this);
+    }
+
+    void CompositorSkia::Blur(const gfx::Rect& bounds)
+    {
+        gfx::Rect region = bounds.Intersect(gfx::Rect(size()));
+        if(region.IsEmpty() || committing_)
+        {
+            // Blurs aren't part of the snapshot the compositor thread draws.
+            return;
+        }
+
+        // The blur reads what has been drawn so far.
+        WaitForRaster();
+        base::AutoLock lock(lock_);
+        FlushDraws(true);
+
+        // Copy out the region, shrink it and stretch it back with bilinear
+        // filtering. Cheap, and good enough for the frosted backgrounds this is
+        // used for.
+        SkBitmap source;
+        SkIRect source_rect = { region.x(), region.y(),
+            region.right(), region.bottom() };
+        if(!backbuffer().extractSubset(&source, source_rect))
+        {
+            return;
+        }
+        SkBitmap copy;
+        source.copyTo(&copy, SkBitmap::kARGB_8888_Config);
+
+        int small_width = std::max(1, region.width() / kBlurDownsample);
+        int small_height = std::max(1, region.height() / kBlurDownsample);
+        gfx::CanvasSkia small_canvas(small_width, small_height, false);
+        SkPaint paint;
+        paint.setFilterBitmap(true);
+        paint.setXfermodeMode(SkXfermode::kSrc_Mode);
+        SkRect small_rect = { 0, 0,
+            SkIntToScalar(small_width), SkIntToScalar(small_height) };
+        small_canvas.drawBitmapRect(copy, NULL, small_rect, &paint);
+
+        SkRect dest_rect = gfx::RectToSkRect(region);
+        canvas_->drawBitmapRect(
+            small_canvas.getDevice()->accessBitmap(false), NULL, dest_rect, &paint);
+    }
+
+    int CompositorSkia::StartLayerAnimation(const Layer* layer,
+        const LayerAnimationParams& params)
+    {
+        if(!animation_thread_.get())
+        {
+            scoped_ptr<base::Thread> thread(
+                new base::Thread("CompositorAnimation"));
+            if(!thread->Start())
+            {
+                return 0;
+            }
+            animation_thread_.reset(thread.release());
+        }
+
+        LayerAnimation animation;
+        animation.id = next_animation_id_++;
+        animation.layer = layer;
+        animation.params = params;
+
+        bool first = false;
+        {
+            base::AutoLock lock(lock_);
+            first = animations_.empty();
+            animations_.push_back(animation);
+        }
+        if(first)
+        {
+            // Until now the UI thread composed the frames and never needed a
+            // snapshot.
+            TakeSnapshot();
+        }
+
+        base::AutoLock lock(lock_);
+        ScheduleAnimationTick(0);
+        return animation.id;
+    }
+
+    void CompositorSkia::StopLayerAnimation(int id)
+    {
+        {
+            base::AutoLock lock(lock_);
+            for(size_t i=0; i<animations_.size(); ++i)
+            {
+                if(animations_[i].id == id)
+                {
+                    animations_.erase(animations_.begin() + i);
+                    break;
+                }
+            }
+            if(animations_.empty())
+            {
+                snapshot_.clear();
+            }
+        }
+
+        // The UI thread composes the frames again once the last animation is
+        // gone, and either way the layer's own value has to be drawn.
+        SchedulePaint();
+    }
+
+    void CompositorSkia::RecordDraw(TextureSkia* texture,
+        const ui::TextureDrawParams& params,
+        const gfx::Rect& region)
+    {
+        if(committing_)
+        {
+            // The compositor thread draws the snapshot instead.
+            return;
+        }
+
+        base::AutoLock lock(lock_);
+        AddDrawOp(texture, params, region);
+    }
+
+    void CompositorSkia::AddDrawOp(const TextureSkia* texture,
+        const ui::TextureDrawParams& params,
+        const gfx::Rect& region)
+    {
+        DrawOp op;
+        op.texture = texture;
+        op.matrix = params.transform.matrix();
+        op.region = region;
+        op.blend = params.blend || params.opacity<1.0f;
+        op.alpha = static_cast<U8CPU>(
+            std::min(params.opacity, 1.0f) * 255.0f + 0.5f);
+        draw_ops_.push_back(op);
+    }
+
+    const SkBitmap& CompositorSkia::backbuffer() const
+    {
+        return canvas_->getDevice()->accessBitmap(false);
+    }
+
+    void CompositorSkia::WaitForRaster()
+    {
+        raster_idle_.Wait();
+    }
+
+    void CompositorSkia::DidQueuePictures(TextureSkia* texture)
+    {
+        picture_textures_.push_back(texture);
+    }
+
+    int CompositorSkia::frame_count() const
+    {
+        base::AutoLock lock(lock_);
+        return frame_count_;
+    }
+
+    int CompositorSkia::updated_tile_count() const
+    {
+        base::AutoLock lock(lock_);
+        return updated_tile_count_;
+    }
+
+    int CompositorSkia::rasterized_tile_count() const
+    {
+        base::AutoLock lock(lock_);
+        return rasterized_tile_count_;
+    }
+
+    base::TimeDelta CompositorSkia::last_frame_duration() const
+    {
+        base::AutoLock lock(lock_);
+        return last_frame_duration_;
+    }
+
+    base::TimeDelta CompositorSkia::total_frame_duration() const
+    {
+        base::AutoLock lock(lock_);
+        return total_frame_duration_;
+    }
+
+    int CompositorSkia::threaded_frame_count() const
+    {
+        base::AutoLock lock(lock_);
+        return threaded_frame_count_;
+    }
+
+    base::TimeDelta CompositorSkia::longest_threaded_frame_interval() const
+    {
+        base::AutoLock lock(lock_);
+        return longest_threaded_frame_interval_;
+    }
+
+    double CompositorSkia::GetFramesPerSecond() const
+    {
+        base::AutoLock lock(lock_);
+        double seconds = total_frame_duration_.InSecondsF();
+        return seconds>0.0 ? frame_count_/seconds : 0.0;
+    }
+
+    void CompositorSkia::ResetStatistics()
+    {
+        base::AutoLock lock(lock_);
+        frame_count_ = 0;
+        updated_tile_count_ = 0;
+        rasterized_tile_count_ = 0;
+        last_frame_duration_ = base::TimeDelta();
+        total_frame_duration_ = base::TimeDelta();
+        threaded_frame_count_ = 0;
+        longest_threaded_frame_interval_ = base::TimeDelta();
+    }
+
+    void CompositorSkia::OnNotifyStart(bool clear)
+    {
+        {
+            base::AutoLock lock(lock_);
+            committing_ = !animations_.empty();
+        }
+        if(committing_)
+        {
+            // The compositor thread clears the backbuffer for every frame.
+            return;
+        }
+
+        frame_start_ = base::TimeTicks::HighResNow();
+        if(clear)
+        {
+            // The last frame's jobs may still draw into the backbuffer, so this
+            // frame's jobs clear it.
+            base::AutoLock lock(lock_);
+            clear_pending_ = true;
+        }
+    }
+
+    void CompositorSkia::OnNotifyEnd()
+    {
+        if(committing_)
+        {
+            // The textures are up to date once their pictures are played; let
+            // the compositor thread show them. Its next tick waits for the jobs.
+            committing_ = false;
+            SubmitFrame(false);
+            TakeSnapshot();
+            base::AutoLock lock(lock_);
+            ScheduleAnimationTick(0);
+            return;
+        }
+
+        SubmitFrame(true);
+    }
+
+    void CompositorSkia::OnWidgetSizeChanged()
+    {
+        // The last frame's jobs may still draw into the old backbuffer.
+        WaitForRaster();
+        base::AutoLock lock(lock_);
+
+        // Draws recorded against the old backbuffer are meaningless now.
+        draw_ops_.clear();
+        clear_pending_ = false;
+
+        int width = std::max(1, size().width());
+        int height = std::max(1, size().height());
+        canvas_.reset(new gfx::CanvasSkia(width, height, false));
+        canvas_->drawColor(SK_ColorBLACK, SkXfermode::kClear_Mode);
+    }
+
+    CompositorSkia::RasterBatch* CompositorSkia::CreateBatch(bool take_pictures,
+        bool composite)
+    {
+        lock_.AssertAcquired();
+
+        RasterBatch* batch = new RasterBatch;
+        batch->composite = composite;
+        batch->frame_start = frame_start_;
+
+        if(take_pictures)
+        {
+            batch->pictures.resize(picture_textures_.size());
+            for(size_t i=0; i<picture_textures_.size(); ++i)
+            {
+                std::vector<int> tiles;
+                picture_textures_[i]->TakePictures(&batch->pictures[i], &tiles);
+                for(size_t j=0; j<tiles.size(); ++j)
+                {
+                    RasterBatch::TileUpdate update;
+                    update.texture = picture_textures_[i].get();
+                    update.tile_index = tiles[j];
+                    update.pictures_index = i;
+                    batch->updates.push_back(update);
+                }
+                raster_textures_.push_back(picture_textures_[i]);
+            }
+            picture_textures_.clear();
+
+            batch->pending_updates = static_cast<int>(batch->updates.size());
+            updated_tile_count_ += static_cast<int>(batch->updates.size());
+        }
+
+        if(!composite)
+        {
+            return batch;
+        }
+
+        batch->draw_ops.swap(draw_ops_);
+        batch->clear = clear_pending_;
+        clear_pending_ = false;
+
+        // Only the parts of the backbuffer some draw can touch need a job,
+        // unless the whole of it is cleared.
+        gfx::Rect dirty_bounds;
+        if(batch->clear)
+        {
+            dirty_bounds = gfx::Rect(size());
+        }
+        else if(!batch->draw_ops.empty())
+        {
+            SkRect dirty_rect;
+            dirty_rect.setEmpty();
+            for(size_t i=0; i<batch->draw_ops.size(); ++i)
+            {
+                SkRect mapped;
+                batch->draw_ops[i].matrix.mapRect(&mapped,
+                    gfx::RectToSkRect(batch->draw_ops[i].region));
+                dirty_rect.join(mapped);
+            }
+            SkIRect dirty;
+            dirty_rect.roundOut(&dirty);
+            dirty_bounds = gfx::Rect(dirty.fLeft, dirty.fTop,
+                dirty.width(), dirty.height()).Intersect(gfx::Rect(size()));
+        }
+
+        if(!dirty_bounds.IsEmpty())
+        {
+            int first_x = dirty_bounds.x() / kRasterTileSize;
+            int last_x = (dirty_bounds.right() - 1) / kRasterTileSize;
+            int first_y = dirty_bounds.y() / kRasterTileSize;
+            int last_y = (dirty_bounds.bottom() - 1) / kRasterTileSize;
+            for(int y=first_y; y<=last_y; ++y)
+            {
+                for(int x=first_x; x<=last_x; ++x)
+                {
+                    gfx::Rect tile(x*kRasterTileSize, y*kRasterTileSize,
+                        kRasterTileSize, kRasterTileSize);
+                    batch->tiles.push_back(tile.Intersect(dirty_bounds));
+                }
+            }
+        }
+        rasterized_tile_count_ += static_cast<int>(batch->tiles.size());
+
+        return batch;
+    }
+
+    void CompositorSkia::SubmitFrame(bool composite)
+    {
+        // The last frame's jobs read the textures and write the backbuffer this
+        // frame's jobs are about to change.
+        WaitForRaster();
+        raster_textures_.clear();
+
+        RasterBatch* batch = NULL;
+        {
+            base::AutoLock lock(lock_);
+            batch = CreateBatch(true, composite);
+            batch->submitted = true;
+            raster_pending_ = true;
+            raster_idle_.Reset();
+        }
+
+        // The layers may drop their textures before the jobs are done.
+        for(size_t i=0; i<batch->draw_ops.size(); ++i)
+        {
+            raster_textures_.push_back(batch->draw_ops[i].texture);
+        }
+
+        RunBatch(batch);
+    }
+
+    void CompositorSkia::FlushDraws(bool take_pictures)
+    {
+        lock_.AssertAcquired();
+        scoped_ptr<RasterBatch> batch(CreateBatch(take_pictures, true));
+        RunBatch(batch.get());
+    }
+
+    void CompositorSkia::RunBatch(RasterBatch* batch)
+    {
+        int work = static_cast<int>(std::max(batch->updates.size(),
+            batch->tiles.size()));
+        if(work == 0)
+        {
+            if(batch->submitted)
+            {
+                FinishSubmittedBatch(batch);
+            }
+            return;
+        }
+
+        if(!batch->tiles.empty())
+        {
+            // Keep the backbuffer's pixels locked while the jobs run so every
+            // tile's subset bitmap shares the same memory. Unlocked once the
+            // jobs are done.
+            backbuffer().lockPixels();
+        }
+
+        int jobs = std::min(base::SysInfo::NumberOfProcessors(), work);
+        jobs = std::max(jobs, 1);
+        batch->pending_jobs = jobs;
+
+        // A submitted batch is left to the pool entirely. Otherwise the calling
+        // thread runs one of the jobs itself and waits for the others. If a job
+        // can't be posted, run it here so |pending_jobs| still reaches zero.
+        const bool submitted = batch->submitted;
+        const int posted_jobs = submitted ? jobs : jobs-1;
+        for(int i=0; i<posted_jobs; ++i)
+        {
+            if(!base::WorkerPool::PostTask(
+                base::Bind(&CompositorSkia::RunRasterJob,
+                base::Unretained(this), batch), false))
+            {
+                RunRasterJob(this, batch);
+            }
+        }
+        if(submitted)
+        {
+            // |batch| may be gone already.
+            return;
+        }
+
+        RunRasterJob(this, batch);
+        batch->done.Wait();
+        if(!batch->tiles.empty())
+        {
+            backbuffer().unlockPixels();
+        }
+    }
+
+    void CompositorSkia::FinishSubmittedBatch(RasterBatch* batch)
+    {
+        if(!batch->tiles.empty())
+        {
+            backbuffer().unlockPixels();
+        }
+        if(batch->composite)
+        {
+            Present();
+        }
+
+        base::TimeTicks end = base::TimeTicks::HighResNow();
+        {
+            base::AutoLock lock(lock_);
+            if(batch->composite)
+            {
+                last_frame_duration_ = end - batch->frame_start;
+                total_frame_duration_ += last_frame_duration_;
+                ++frame_count_;
+            }
+            raster_pending_ = false;
+        }
+        delete batch;
+
+        // |this| may be destroyed as soon as this is signaled.
+        raster_idle_.Signal();
+    }
+
+    void CompositorSkia::RasterizeTile(const RasterBatch& batch,
+        const gfx::Rect& tile) const
+    {
+        SkBitmap subset;
+        SkIRect subset_rect = { tile.x(), tile.y(), tile.right(), tile.bottom() };
+        if(!backbuffer().extractSubset(&subset, subset_rect))
+        {
+            return;
+        }
+
+        SkCanvas canvas(subset);
+        if(batch.clear)
+        {
+            canvas.drawColor(SK_ColorBLACK, SkXfermode::kClear_Mode);
+        }
+        canvas.translate(SkIntToScalar(-tile.x()), SkIntToScalar(-tile.y()));
+        for(size_t i=0; i<batch.draw_ops.size(); ++i)
+        {
+            const DrawOp& op = batch.draw_ops[i];
+            op.texture->Rasterize(&canvas, op.matrix, op.region,
+                op.blend, op.alpha);
+        }
+    }
+
+    // static
+    void CompositorSkia::RunRasterJob(CompositorSkia* compositor,
+        RasterBatch* batch)
+    {
+        const int update_count = static_cast<int>(batch->updates.size());
+        for(;;)
+        {
+            int index = base::subtle::NoBarrier_AtomicIncrement(
+                &batch->next_update, 1) - 1;
+            if(index >= update_count)
+            {
+                break;
+            }
+            const RasterBatch::TileUpdate& update = batch->updates[index];
+            update.texture->PlayPictures(update.tile_index,
+                batch->pictures[update.pictures_index]);
+            if(base::subtle::Barrier_AtomicIncrement(
+                &batch->pending_updates, -1) == 0)
+            {
+                batch->updates_done.Signal();
+            }
+        }
+
+        const int tile_count = static_cast<int>(batch->tiles.size());
+        if(update_count>0 && tile_count>0)
+        {
+            // Every texture has to be complete before any tile composites it.
+            batch->updates_done.Wait();
+        }
+        for(;;)
+        {
+            int index = base::subtle::NoBarrier_AtomicIncrement(
+                &batch->next_tile, 1) - 1;
+            if(index >= tile_count)
+            {
+                break;
+            }
+            compositor->RasterizeTile(*batch, batch->tiles[index]);
+        }
+
+        if(base::subtle::Barrier_AtomicIncrement(&batch->pending_jobs, -1) == 0)
+        {
+            if(batch->submitted)
+            {
+                compositor->FinishSubmittedBatch(batch);
+            }
+            else
+            {
+                batch->done.Signal();
+            }
+        }
+    }
+
+    void CompositorSkia::TakeSnapshot()
+    {
+        std::vector<SnapshotLayer> snapshot;
+        if(root_layer())
+        {
+            AddToSnapshot(root_layer(), -1, &snapshot);
+        }
+
+        // The old snapshot is released below, after the lock.
+        base::AutoLock lock(lock_);
+        snapshot_.swap(snapshot);
+    }
+
+    void CompositorSkia::AddToSnapshot(Layer* layer, int parent,
+        std::vector<SnapshotLayer>* snapshot)
+    {
+        if(!layer->visible())
+        {
+            return;
+        }
+
+        SnapshotLayer entry;
+        entry.layer = layer;
+        entry.parent = parent;
+        // Other textures never draw into the backbuffer; keep the layer for its
+        // transform and opacity only.
+        entry.texture = layer->texture() ?
+            layer->texture()->AsTextureSkia() : NULL;
+        entry.transform = layer->transform();
+        entry.bounds = layer->bounds();
+        entry.opacity = layer->opacity();
+        entry.fills_bounds_opaquely = layer->fills_bounds_opaquely();
+        snapshot->push_back(entry);
+
+        int index = static_cast<int>(snapshot->size()) - 1;
+        const std::vector<Layer*>& children = layer->children();
+        for(size_t i=0; i<children.size(); ++i)
+        {
+            AddToSnapshot(children[i], index, snapshot);
+        }
+    }
+
+    void CompositorSkia::RecordSnapshotDraws(base::TimeTicks time)
+    {
+        lock_.AssertAcquired();
+
+        std::vector<gfx::Transform> transforms(snapshot_.size());
+        std::vector<float> opacities(snapshot_.size());
+        for(size_t i=0; i<snapshot_.size(); ++i)
+        {
+            const SnapshotLayer& layer = snapshot_[i];
+            gfx::Transform transform = layer.transform;
+            float opacity = layer.opacity;
+            for(size_t j=0; j<animations_.size(); ++j)
+            {
+                const LayerAnimation& animation = animations_[j];
+                if(animation.layer != layer.layer)
+                {
+                    continue;
+                }
+
+                double state = animation.params.GetStateAt(time);
+                if(animation.params.property == LayerAnimationParams::TRANSFORM)
+                {
+                    transform = animation.params.GetTransform(state);
+                }
+                else
+                {
+                    opacity = animation.params.GetOpacity(state);
+                }
+            }
+
+            // Composed in the same order as Layer::Draw() does.
+            transform.ConcatTranslate(static_cast<float>(layer.bounds.x()),
+                static_cast<float>(layer.bounds.y()));
+            if(layer.parent >= 0)
+            {
+                transform.ConcatTransform(transforms[layer.parent]);
+                opacity *= opacities[layer.parent];
+            }
+            transforms[i] = transform;
+            opacities[i] = opacity;
+
+            if(!layer.texture.get() || opacity<=0.0f)
+            {
+                continue;
+            }
+            gfx::Rect region = gfx::Rect(layer.bounds.size()).Intersect(
+                gfx::Rect(layer.texture->size()));
+            if(region.IsEmpty())
+            {
+                continue;
+            }
+
+            ui::TextureDrawParams params;
+            params.transform = transform;
+            params.opacity = opacity;
+            params.blend = layer.parent>=0 &&
+                (!layer.fills_bounds_opaquely || opacity<1.0f);
+            params.compositor_size = size();
+            AddDrawOp(layer.texture.get(), params, region);
+        }
+    }
+
+    void CompositorSkia::ScheduleAnimationTick(int64 delay_ms)
+    {
+        lock_.AssertAcquired();
+        if(animation_tick_pending_)
+        {
+            return;
+        }
+
+        animation_tick_pending_ = true;
+        animation_thread_->message_loop()->PostDelayedTask(
+            base::Bind(&CompositorSkia::AnimationTick, base::Unretained(this)),
+            delay_ms);
+    }
+
+    void CompositorSkia::AnimationTick()
+    {
+        base::AutoLock lock(lock_);
+
+        // The UI thread may have handed over pictures for the textures this
+        // frame draws. Its jobs take the lock when they finish.
+        while(raster_pending_)
+        {
+            base::AutoUnlock unlock(lock_);
+            WaitForRaster();
+        }
+
+        animation_tick_pending_ = false;
+        if(animations_.empty())
+        {
+            last_threaded_frame_ = base::TimeTicks();
+            return;
+        }
+
+        base::TimeTicks now = base::TimeTicks::HighResNow();
+        if(!last_threaded_frame_.is_null())
+        {
+            longest_threaded_frame_interval_ = std::max(
+                longest_threaded_frame_interval_, now-last_threaded_frame_);
+        }
+
+        canvas_->drawColor(SK_ColorBLACK, SkXfermode::kClear_Mode);
+        RecordSnapshotDraws(now);
+        FlushDraws(false);
+        Present();
+
+        base::TimeTicks end = base::TimeTicks::HighResNow();
+        last_frame_duration_ = end - now;
+        total_frame_duration_ += last_frame_duration_;
+        ++frame_count_;
+        ++threaded_frame_count_;
+
+        bool running = false;
+        for(size_t i=0; i<animations_.size(); ++i)
+        {
+            const LayerAnimationParams& params = animations_[i].params;
+            running |= params.start_time+params.duration > now;
+        }
+        if(!running)
+        {
+            // The last frame showed the final values; the UI thread stops the
+            // animations from here. A new run measures its intervals afresh.
+            last_threaded_frame_ = base::TimeTicks();
+            return;
+        }
+
+        last_threaded_frame_ = now;
+        int64 delay_ms = kAnimationFrameIntervalMs -
+            (end - now).InMilliseconds();
+        ScheduleAnimationTick(std::max(delay_ms, static_cast<int64>(0)));
+    }
+
+    void CompositorSkia::Present()
+    {
+        if(!widget_)
+        {
+            return;
+        }
+
+        HDC dc = GetDC(widget_);
+        skia::DrawToNativeContext(canvas_.get(), dc, 0, 0, NULL);
+        ReleaseDC(widget_, dc);
+    }
+
+    // static
+    Compositor* Compositor::Create(CompositorDelegate* delegate,
+        HWND widget, const gfx::Size& size)
+    {
+        return new CompositorSkia(delegate, widget, size);
+    }
+
+} //namespace ui
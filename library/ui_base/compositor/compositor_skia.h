@@ -0,0 +1,378 @@
+
+#ifndef __ui_base_compositor_skia_h__
+#define __ui_base_compositor_skia_h__
+
+#pragma once
+
+#include <vector>
+
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/synchronization/lock.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/time.h"
+
+#include "SkBitmap.h"
+#include "SkMatrix.h"
+#include "SkPicture.h"
+
+#include "ui_gfx/rect.h"
+
+#include "compositor.h"
+
+namespace base
+{
+    class Thread;
+}
+
+namespace gfx
+{
+    class CanvasSkia;
+}
+
+namespace ui
+{
+
+    class CompositorSkia;
+
+    // A Texture kept in main memory as a grid of tiles. SetCanvas() only copies
+    // into the tiles that the updated rect touches. SetPicture() queues a
+    // recorded paint that the compositor's raster jobs play into the tiles.
+    // Draw() records the draw with the compositor; the tiles that intersect the
+    // requested region are drawn later by Rasterize(), possibly on a worker
+    // thread.
+    class TextureSkia : public Texture
+    {
+    public:
+        // Edge length of a tile, in pixels.
+        static const int kTileSize = 256;
+
+        // A recorded paint waiting to be played into the tiles.
+        struct Picture
+        {
+            SkRefPtr<SkPicture> picture;
+            // Where the picture's origin lies in the texture.
+            gfx::Point origin;
+            // The part of the texture the picture replaces.
+            gfx::Rect bounds;
+        };
+        typedef std::vector<Picture> Pictures;
+
+        explicit TextureSkia(CompositorSkia* compositor);
+
+        // Texture:
+        virtual void SetCanvas(const SkCanvas& canvas,
+            const gfx::Point& origin,
+            const gfx::Size& overall_size);
+        virtual void Draw(const ui::TextureDrawParams& params,
+            const gfx::Rect& bounds_in_texture);
+        virtual TextureSkia* AsTextureSkia() { return this; }
+        virtual const TextureSkia* AsTextureSkia() const { return this; }
+
+        // Queues |picture| to replace the part of the texture it covers when
+        // |origin| is its top left corner. UI thread only. The tiles change once
+        // the compositor's next frame plays the picture.
+        void SetPicture(SkPicture* picture,
+            const gfx::Point& origin,
+            const gfx::Size& overall_size);
+
+        const gfx::Size& size() const { return size_; }
+
+        // Draws |region| of the texture to |canvas|. The tiles are only read, and
+        // are drawn through copies local to the call, so this may run on several
+        // threads at once. SetCanvas() waits for the compositor's raster jobs
+        // before it writes to the tiles.
+        void Rasterize(SkCanvas* canvas,
+            const SkMatrix& matrix,
+            const gfx::Rect& region,
+            bool blend,
+            U8CPU alpha) const;
+
+        // Hands the queued pictures to the compositor and allocates the tiles
+        // they touch, whose indices are appended to |tiles|. UI thread only,
+        // with no raster job running.
+        void TakePictures(Pictures* pictures, std::vector<int>* tiles);
+
+        // Plays |pictures| into tile |tile_index|. Jobs for different tiles may
+        // run at once.
+        void PlayPictures(int tile_index, const Pictures& pictures);
+
+    private:
+        virtual ~TextureSkia();
+
+        // Resizes the tile grid to cover |size|, dropping all tile contents when
+        // the size changes.
+        void Resize(const gfx::Size& size);
+
+        // Returns the bounds of the tile at |tile_x|, |tile_y| in texture space.
+        gfx::Rect GetTileBounds(int tile_x, int tile_y) const;
+
+        // Returns the tile at |tile_x|, |tile_y|, allocating it if needed.
+        SkBitmap* GetTile(int tile_x, int tile_y);
+
+        // Returns the index range of the tiles |rect| touches.
+        void GetTileRange(const gfx::Rect& rect, int* first_x, int* last_x,
+            int* first_y, int* last_y) const;
+
+        CompositorSkia* compositor_;
+
+        gfx::Size size_;
+        int tiles_across_;
+        int tiles_down_;
+
+        // Row-major tiles. A tile that was never written has no pixels and is
+        // skipped when drawing.
+        std::vector<SkBitmap> tiles_;
+
+        // Queued by SetPicture(), in order. UI thread only.
+        Pictures pictures_;
+
+        DISALLOW_COPY_AND_ASSIGN(TextureSkia);
+    };
+
+    // Compositor that rasterizes the layer tree with Skia on the CPU. Each layer's
+    // texture is a TextureSkia; drawing composites the textures, with their
+    // transforms and opacity, into a backbuffer that is then copied to the
+    // window.
+    //
+    // Rasterization is done by jobs on the worker pool, and the UI thread
+    // doesn't wait for it. While walking the layer tree the UI thread only
+    // records: texture draws are kept as a list, and layers whose delegates can
+    // record their paint (LayerDelegate::CanRecordLayer()) hand their textures
+    // display lists instead of pixels. At the end of the frame the jobs first
+    // play the display lists into the texture tiles they touch, then composite
+    // the backbuffer in tiles, each replaying the draws clipped to its tile, and
+    // the last job to finish presents the frame. The UI thread only waits for a
+    // frame's jobs when it is about to change what they read: before the next
+    // frame is handed over, and before a texture's pixels are replaced.
+    // CompositorObserver::OnCompositingEnded() is therefore called once a frame
+    // is handed over, possibly before it is presented.
+    //
+    // Delegates that paint through the platform canvas, which includes Views
+    // (text goes through GDI on the canvas's HDC), still paint into a bitmap on
+    // the UI thread in OnPaintLayer().
+    //
+    // Created by Compositor::Create(). With a NULL HWND it runs headless:
+    // nothing is presented and the result is only available through
+    // backbuffer(), which makes it usable for measuring frame rates of layer
+    // animations.
+    //
+    // Transform and opacity animations started with StartLayerAnimation() run on
+    // a compositor thread. While any is running, a Draw() on the UI thread only
+    // paints the layers' textures and takes a snapshot of the layer tree; the
+    // compositor thread composes every frame from the latest snapshot with the
+    // animated values applied, so a busy UI thread doesn't stall the animation.
+    class CompositorSkia : public Compositor
+    {
+    public:
+        CompositorSkia(CompositorDelegate* delegate,
+            HWND widget,
+            const gfx::Size& size);
+
+        // Compositor:
+        virtual Texture* CreateTexture();
+        virtual void Blur(const gfx::Rect& bounds);
+        virtual int StartLayerAnimation(const Layer* layer,
+            const LayerAnimationParams& params);
+        virtual void StopLayerAnimation(int id);
+
+        // Records a draw of |texture| for the current frame.
+        void RecordDraw(TextureSkia* texture,
+            const ui::TextureDrawParams& params,
+            const gfx::Rect& region);
+
+        // The result of the last frame. Only stable after WaitForRaster(), while
+        // no layer animation is running.
+        const SkBitmap& backbuffer() const;
+
+        // Guards the textures, the backbuffer and the animation state shared
+        // with the compositor thread.
+        base::Lock& lock() const { return lock_; }
+
+        // Waits until the raster jobs of the last frame handed over are done.
+        // lock() must not be held, since the last job takes it.
+        void WaitForRaster();
+
+        // Called by TextureSkia on the UI thread when it queues its first
+        // picture since the last frame.
+        void DidQueuePictures(TextureSkia* texture);
+
+        // Called by TextureSkia, with lock() held, each time a tile's contents
+        // are replaced.
+        void DidUpdateTile() { ++updated_tile_count_; }
+
+        // Frame statistics, accumulated since creation or the last
+        // ResetStatistics(). Frames composed on either thread are counted,
+        // once their raster jobs are done.
+        int frame_count() const;
+        int updated_tile_count() const;
+        int rasterized_tile_count() const;
+        base::TimeDelta last_frame_duration() const;
+        base::TimeDelta total_frame_duration() const;
+
+        // The frames the compositor thread composed for layer animations, and
+        // the longest time between two of them during an animation. Both stay
+        // the same however long the UI thread is busy.
+        int threaded_frame_count() const;
+        base::TimeDelta longest_threaded_frame_interval() const;
+
+        // Frames per second based on the time spent compositing, i.e. the rate
+        // the compositor could sustain if frames were requested back to back.
+        double GetFramesPerSecond() const;
+
+        void ResetStatistics();
+
+    protected:
+        virtual ~CompositorSkia();
+
+        // Compositor:
+        virtual void OnNotifyStart(bool clear);
+        virtual void OnNotifyEnd();
+        virtual void OnWidgetSizeChanged();
+
+    private:
+        // A recorded Texture::Draw().
+        struct DrawOp
+        {
+            // Kept alive by its layer, or by the snapshot, until the draws are
+            // flushed. Not a reference, which the compositor thread couldn't
+            // safely take.
+            const TextureSkia* texture;
+            SkMatrix matrix;
+            gfx::Rect region;
+            bool blend;
+            U8CPU alpha;
+        };
+
+        // A layer as it was when the snapshot was taken. Parents come before
+        // their children.
+        struct SnapshotLayer
+        {
+            // Only compared against LayerAnimation::layer, never dereferenced.
+            const Layer* layer;
+            // Index of the parent in the snapshot, -1 for the root.
+            int parent;
+            scoped_refptr<const TextureSkia> texture;
+            gfx::Transform transform;
+            gfx::Rect bounds;
+            float opacity;
+            bool fills_bounds_opaquely;
+        };
+
+        struct LayerAnimation
+        {
+            int id;
+            const Layer* layer;
+            LayerAnimationParams params;
+        };
+
+        struct RasterBatch;
+
+        // Appends a draw to the list; lock() must be held.
+        void AddDrawOp(const TextureSkia* texture,
+            const ui::TextureDrawParams& params,
+            const gfx::Rect& region);
+
+        // Moves the work recorded so far into a new batch: the queued pictures
+        // if |take_pictures| (UI thread only), and the draws and a pending clear
+        // if |composite|. lock() must be held, and no batch may be running.
+        RasterBatch* CreateBatch(bool take_pictures, bool composite);
+
+        // Hands the recorded work to the raster jobs without waiting for them.
+        // |composite| is false while the compositor thread composes the frames,
+        // so only the queued pictures are played. UI thread only.
+        void SubmitFrame(bool composite);
+
+        // Plays the queued pictures, if |take_pictures|, and replays the recorded
+        // draws into the backbuffer, waiting for the jobs. lock() must be held,
+        // and no batch may be running.
+        void FlushDraws(bool take_pictures);
+
+        // Replaces the snapshot with the current layer tree. UI thread only.
+        void TakeSnapshot();
+        void AddToSnapshot(Layer* layer, int parent,
+            std::vector<SnapshotLayer>* snapshot);
+
+        // Records the draws of the snapshot with the animations' values at
+        // |time|. Unlike Layer::Draw() no holes are left for opaque children,
+        // since an animated child may not cover them. lock() must be held.
+        void RecordSnapshotDraws(base::TimeTicks time);
+
+        // Posts AnimationTick() to the compositor thread, unless it's already
+        // pending; lock() must be held.
+        void ScheduleAnimationTick(int64 delay_ms);
+
+        // Composes and presents a frame on the compositor thread, and schedules
+        // the next one while any animation hasn't reached its end yet.
+        void AnimationTick();
+
+        // Replays the batch's draws clipped to |tile| of the backbuffer.
+        void RasterizeTile(const RasterBatch& batch, const gfx::Rect& tile) const;
+
+        // Copies the backbuffer to the window. Does nothing when headless.
+        void Present();
+
+        // Starts the batch's jobs. A submitted batch is left to the worker pool;
+        // otherwise the calling thread runs one of the jobs and waits for the
+        // others.
+        void RunBatch(RasterBatch* batch);
+
+        // Called by the last job of a submitted batch: presents the frame,
+        // counts it, deletes |batch| and wakes WaitForRaster().
+        void FinishSubmittedBatch(RasterBatch* batch);
+
+        static void RunRasterJob(CompositorSkia* compositor, RasterBatch* batch);
+
+        HWND widget_;
+
+        scoped_ptr<gfx::CanvasSkia> canvas_;
+
+        std::vector<DrawOp> draw_ops_;
+
+        // Set by a clearing OnNotifyStart(); the frame's jobs clear the
+        // backbuffer before compositing.
+        bool clear_pending_;
+
+        mutable base::Lock lock_;
+
+        // Set while a submitted batch runs, guarded by |lock_|. |raster_idle_|
+        // is signaled when none does.
+        bool raster_pending_;
+        base::WaitableEvent raster_idle_;
+
+        // Textures with queued pictures, and the textures the running batch
+        // reads. Their references are only taken and dropped on the UI thread.
+        std::vector<scoped_refptr<TextureSkia> > picture_textures_;
+        std::vector<scoped_refptr<const TextureSkia> > raster_textures_;
+
+        // Created with the first layer animation.
+        scoped_ptr<base::Thread> animation_thread_;
+
+        // Guarded by |lock_|. The snapshot's texture references are only taken
+        // and dropped on the UI thread.
+        std::vector<LayerAnimation> animations_;
+        std::vector<SnapshotLayer> snapshot_;
+        bool animation_tick_pending_;
+        base::TimeTicks last_threaded_frame_;
+
+        int next_animation_id_;
+
+        // Set during a Draw() that only updates the snapshot, because the
+        // compositor thread composes the frames. UI thread only.
+        bool committing_;
+
+        base::TimeTicks frame_start_;
+        int frame_count_;
+        int updated_tile_count_;
+        int rasterized_tile_count_;
+        base::TimeDelta last_frame_duration_;
+        base::TimeDelta total_frame_duration_;
+        int threaded_frame_count_;
+        base::TimeDelta longest_threaded_frame_interval_;
+
+        DISALLOW_COPY_AND_ASSIGN(CompositorSkia);
+    };
+
+} //namespace ui
+
+#endif //__ui_base_compositor_skia_h__
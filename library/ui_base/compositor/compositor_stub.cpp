@@ -1,14 +0,0 @@
-
-#include "compositor.h"
-
-namespace ui
-{
-
-    // static
-    Compositor* Compositor::Create(CompositorDelegate* delegate,
-        HWND widget, const gfx::Size& size)
-    {
-        return NULL;
-    }
-
-} //namespace ui
\ No newline at end of file
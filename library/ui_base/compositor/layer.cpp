@@ -6,10 +6,14 @@
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 
+#include "SkPicture.h"
+
 #include "ui_gfx/canvas_skia.h"
 #include "ui_gfx/point3.h"
+#include "ui_gfx/skia_util.h"
 
 #include "compositor.h"
+#include "compositor_skia.h"
 
 namespace ui
 {
@@ -18,6 +22,7 @@ namespace ui
         : compositor_(compositor),
         texture_(compositor->CreateTexture()),
         parent_(NULL),
+        opacity_(1.0f),
         visible_(true),
         fills_bounds_opaquely_(false),
         layer_updated_externally_(false),
@@ -96,6 +101,23 @@ namespace ui
         }
     }
 
+    void Layer::SetOpacity(float opacity)
+    {
+        opacity = std::max(0.0f, std::min(opacity, 1.0f));
+        if(opacity_ == opacity)
+        {
+            return;
+        }
+
+        opacity_ = opacity;
+
+        if(parent() && fills_bounds_opaquely_)
+        {
+            parent()->RecomputeHole();
+        }
+        compositor_->SchedulePaint();
+    }
+
     // static
     void Layer::ConvertPointToLayer(const Layer* source,
         const Layer* target,
@@ -173,11 +195,13 @@ namespace ui
             texture_draw_params.transform.ConcatTranslate(
                 static_cast<float>(layer->bounds_.x()),
                 static_cast<float>(layer->bounds_.y()));
+            texture_draw_params.opacity *= layer->opacity_;
         }
 
         // Only blend for transparent child layers.
         // The root layer will clobber the cleared bg.
-        texture_draw_params.blend = parent_!=NULL && !fills_bounds_opaquely_;
+        texture_draw_params.blend = parent_!=NULL &&
+            (!fills_bounds_opaquely_ || texture_draw_params.opacity<1.0f);
         texture_draw_params.compositor_size = compositor_->size();
 
         hole_rect_ = hole_rect_.Intersect(
@@ -256,6 +280,26 @@ namespace ui
             invalid_rect_ = gfx::Rect();
             return;
         }
+
+        TextureSkia* texture_skia = texture_->AsTextureSkia();
+        if(texture_skia && delegate_->CanRecordLayer())
+        {
+            // Only record the paint here; the compositor plays it into the
+            // texture on its raster threads.
+            SkPicture* picture = new SkPicture;
+            SkCanvas* recording_canvas = picture->beginRecording(
+                draw_rect.width(), draw_rect.height());
+            recording_canvas->translate(SkIntToScalar(-draw_rect.x()),
+                SkIntToScalar(-draw_rect.y()));
+            recording_canvas->clipRect(gfx::RectToSkRect(draw_rect));
+            delegate_->OnRecordLayer(recording_canvas);
+            picture->endRecording();
+            texture_skia->SetPicture(picture, draw_rect.origin(), bounds_.size());
+            picture->unref();
+            invalid_rect_ = gfx::Rect();
+            return;
+        }
+
         scoped_ptr<gfx::Canvas> canvas(gfx::Canvas::CreateCanvas(
             draw_rect.width(), draw_rect.height(), false));
         canvas->TranslateInt(-draw_rect.x(), -draw_rect.y());
@@ -268,6 +312,7 @@ namespace ui
         for(size_t i=0; i<children_.size(); ++i)
         {
             if(children_[i]->fills_bounds_opaquely() &&
+                children_[i]->opacity()==1.0f &&
                 !children_[i]->transform().HasChange())
             {
                 hole_rect_ = children_[i]->bounds();
@@ -60,6 +60,11 @@ namespace ui
         void SetBounds(const gfx::Rect& bounds);
         const gfx::Rect& bounds() const { return bounds_; }
 
+        // The opacity of the layer, in the range [0, 1]. The opacity of a layer
+        // is multiplied with the opacity of its ancestors when drawing.
+        void SetOpacity(float opacity);
+        float opacity() const { return opacity_; }
+
         // Sets |visible_|. The Layer is drawn by Draw() only when visible_ is true.
         bool visible() const { return visible_; }
         void set_visible(bool visible) { visible_ = visible; }
@@ -155,6 +160,8 @@ namespace ui
 
         gfx::Rect bounds_;
 
+        float opacity_;
+
         bool visible_;
 
         bool fills_bounds_opaquely_;
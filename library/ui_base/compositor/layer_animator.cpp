@@ -1,7 +1,10 @@
 
 #include "layer_animator.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
+#include "base/message_loop.h"
 #include "base/stl_utilinl.h"
 
 #include "ui_gfx/transform.h"
@@ -37,15 +40,15 @@ namespace ui
     LayerAnimator::LayerAnimator(Layer* layer)
         : layer_(layer),
         duration_in_ms_(200),
-        animation_type_(Tween::EASE_IN) {}
+        animation_type_(Tween::EASE_IN),
+        method_factory_(this) {}
 
     LayerAnimator::~LayerAnimator()
     {
-        for(Elements::iterator i=elements_.begin(); i!=elements_.end(); ++i)
+        while(!elements_.empty())
         {
-            delete i->second.animation;
+            StopAnimating(elements_.begin()->first);
         }
-        elements_.clear();
     }
 
     void LayerAnimator::SetAnimationDurationAndType(int duration,
@@ -90,7 +93,28 @@ namespace ui
             element.params.transform.target[i] =
                 GetMatrixElement(transform.matrix(), i);
         }
-        element.animation = CreateAndStartAnimation();
+        element.compositor_params.property = LayerAnimationParams::TRANSFORM;
+        element.compositor_params.start_transform = layer_transform;
+        element.compositor_params.target_transform = transform;
+        StartTransformOrOpacity(TRANSFORM, &element);
+    }
+
+    void LayerAnimator::AnimateOpacity(float opacity)
+    {
+        StopAnimating(OPACITY);
+        opacity = std::max(0.0f, std::min(opacity, 1.0f));
+        if(opacity == layer_->opacity())
+        {
+            return; // Already there.
+        }
+
+        Element& element = elements_[OPACITY];
+        element.params.opacity.start = layer_->opacity();
+        element.params.opacity.target = opacity;
+        element.compositor_params.property = LayerAnimationParams::OPACITY;
+        element.compositor_params.start_opacity = layer_->opacity();
+        element.compositor_params.target_opacity = opacity;
+        StartTransformOrOpacity(OPACITY, &element);
     }
 
     void LayerAnimator::AnimationProgressed(const Animation* animation)
@@ -128,6 +152,15 @@ namespace ui
                 break;
             }
 
+        case OPACITY:
+            {
+                layer_->SetOpacity(static_cast<float>(
+                    e->second.animation->CurrentValueBetween(
+                    e->second.params.opacity.start,
+                    e->second.params.opacity.target)));
+                break;
+            }
+
         default:
             NOTREACHED();
         }
@@ -163,6 +196,10 @@ namespace ui
                 break;
             }
 
+        case OPACITY:
+            layer_->SetOpacity(e->second.params.opacity.target);
+            break;
+
         default:
             NOTREACHED();
         }
@@ -174,15 +211,79 @@ namespace ui
 
     void LayerAnimator::StopAnimating(AnimationProperty property)
     {
-        if(elements_.count(property) == 0)
+        Elements::iterator e = elements_.find(property);
+        if(e == elements_.end())
         {
             return;
         }
 
-        // Reset the delegate so that we don't attempt to update the layer.
-        elements_[property].animation->set_delegate(NULL);
-        delete elements_[property].animation;
-        elements_.erase(property);
+        if(e->second.compositor_animation_id)
+        {
+            // The layer hasn't changed while the compositor ran the animation;
+            // catch it up with what is on screen.
+            const LayerAnimationParams& params = e->second.compositor_params;
+            SetCompositorValue(params,
+                params.GetStateAt(base::TimeTicks::HighResNow()));
+            layer_->compositor()->StopLayerAnimation(
+                e->second.compositor_animation_id);
+        }
+        else
+        {
+            // Reset the delegate so that we don't attempt to update the layer.
+            e->second.animation->set_delegate(NULL);
+            delete e->second.animation;
+        }
+        elements_.erase(e);
+    }
+
+    void LayerAnimator::StartTransformOrOpacity(AnimationProperty property,
+        Element* element)
+    {
+        LayerAnimationParams& params = element->compositor_params;
+        // The compositor thread reads the same clock.
+        params.start_time = base::TimeTicks::HighResNow();
+        params.duration = base::TimeDelta::FromMilliseconds(duration_in_ms_);
+        params.tween_type = animation_type_;
+        element->compositor_animation_id =
+            layer_->compositor()->StartLayerAnimation(layer_, params);
+        if(!element->compositor_animation_id)
+        {
+            element->animation = CreateAndStartAnimation();
+            return;
+        }
+
+        MessageLoop::current()->PostDelayedTask(
+            method_factory_.NewRunnableMethod(
+            &LayerAnimator::CompositorAnimationEnded, property,
+            element->compositor_animation_id),
+            duration_in_ms_);
+    }
+
+    void LayerAnimator::CompositorAnimationEnded(AnimationProperty property,
+        int id)
+    {
+        Elements::iterator e = elements_.find(property);
+        if(e==elements_.end() || e->second.compositor_animation_id!=id)
+        {
+            return; // Stopped or replaced since.
+        }
+
+        SetCompositorValue(e->second.compositor_params, 1.0);
+        layer_->compositor()->StopLayerAnimation(id);
+        elements_.erase(e);
+    }
+
+    void LayerAnimator::SetCompositorValue(const LayerAnimationParams& params,
+        double state)
+    {
+        if(params.property == LayerAnimationParams::TRANSFORM)
+        {
+            layer_->SetTransform(params.GetTransform(state));
+        }
+        else
+        {
+            layer_->SetOpacity(params.GetOpacity(state));
+        }
     }
 
     MultiAnimation* LayerAnimator::CreateAndStartAnimation()
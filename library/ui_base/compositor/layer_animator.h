@@ -7,6 +7,7 @@
 #include <map>
 
 #include "base/basic_types.h"
+#include "base/task.h"
 
 #include "SkScalar.h"
 #include "SkMatrix44.h"
@@ -16,10 +17,7 @@
 #include "ui_base/animation/animation_delegate.h"
 #include "ui_base/animation/tween.h"
 
-namespace gfx
-{
-    class Transform;
-}
+#include "compositor.h"
 
 namespace ui
 {
@@ -27,7 +25,9 @@ namespace ui
     class Layer;
     class MultiAnimation;
 
-    // LayerAnimator manages animating various properties of a Layer.
+    // LayerAnimator manages animating various properties of a Layer. Transform
+    // and opacity animations are handed to the compositor when it can run them
+    // on its own thread; the animator is then only called back once they end.
     class LayerAnimator : public AnimationDelegate
     {
     public:
@@ -55,6 +55,13 @@ namespace ui
             StopAnimating(TRANSFORM);
         }
 
+        // Animates the opacity from the current opacity to |opacity|.
+        void AnimateOpacity(float opacity);
+        void StopAnimatingOpacity()
+        {
+            StopAnimating(OPACITY);
+        }
+
         // AnimationDelegate:
         virtual void AnimationProgressed(const Animation* animation);
         virtual void AnimationEnded(const Animation* animation);
@@ -64,7 +71,8 @@ namespace ui
         enum AnimationProperty
         {
             LOCATION,
-            TRANSFORM
+            TRANSFORM,
+            OPACITY
         };
 
         // Parameters used when animating the location.
@@ -84,25 +92,52 @@ namespace ui
             SkMScalar target[16];
         };
 
+        // Parameters used when animating the opacity.
+        struct OpacityParams
+        {
+            float start;
+            float target;
+        };
+
         union Params
         {
             LocationParams location;
             TransformParams transform;
+            OpacityParams opacity;
         };
 
-        // Used for tracking the animation of a particular property.
+        // Used for tracking the animation of a particular property. Either
+        // |animation| steps it on this thread, or the compositor runs it as
+        // |compositor_animation_id| with |compositor_params|.
         struct Element
         {
+            Element() : animation(NULL), compositor_animation_id(0) {}
+
             Params params;
             MultiAnimation* animation;
+            int compositor_animation_id;
+            LayerAnimationParams compositor_params;
         };
 
         typedef std::map<AnimationProperty, Element> Elements;
 
         // Stops animating the specified property. This does not set the property
-        // being animated to its final value.
+        // being animated to its final value; the layer keeps the value it's shown
+        // with at the moment.
         void StopAnimating(AnimationProperty property);
 
+        // Starts |element|, animating TRANSFORM or OPACITY from its params, on the
+        // compositor if possible and with CreateAndStartAnimation() otherwise.
+        void StartTransformOrOpacity(AnimationProperty property,
+            Element* element);
+
+        // Called when the compositor animation |id| of |property| is over.
+        void CompositorAnimationEnded(AnimationProperty property, int id);
+
+        // Sets the value of |property| on the layer for compositor |params| at
+        // |state|.
+        void SetCompositorValue(const LayerAnimationParams& params, double state);
+
         // Creates an animation.
         MultiAnimation* CreateAndStartAnimation();
 
@@ -121,6 +156,8 @@ namespace ui
         // Type of animation for newly created animations.
         Tween::Type animation_type_;
 
+        ScopedRunnableMethodFactory<LayerAnimator> method_factory_;
+
         DISALLOW_COPY_AND_ASSIGN(LayerAnimator);
     };
 
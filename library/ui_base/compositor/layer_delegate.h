@@ -4,6 +4,8 @@
 
 #pragma once
 
+class SkCanvas;
+
 namespace gfx
 {
     class Canvas;
@@ -20,6 +22,17 @@ namespace ui
         // clipped to the Layer's invalid rect.
         virtual void OnPaintLayer(gfx::Canvas* canvas) = 0;
 
+        // Returns true if the delegate paints with Skia alone and never through
+        // the platform canvas (its HDC). Such a delegate is painted with
+        // OnRecordLayer() instead of OnPaintLayer(), into a display list that
+        // the compositor rasterizes on its worker threads.
+        virtual bool CanRecordLayer() const { return false; }
+
+        // Records content for the layer into |canvas|, a recording canvas with
+        // the same clip and origin OnPaintLayer() would get. Only called when
+        // CanRecordLayer() returns true.
+        virtual void OnRecordLayer(SkCanvas* canvas) {}
+
     protected:
         virtual ~LayerDelegate() {}
     };
@@ -0,0 +1,289 @@
+#include "batched_table_model_observer.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/message_loop.h"
+
+#include "table_model.h"
+
+namespace ui
+{
+
+    BatchedTableModelObserver::BatchedTableModelObserver(
+        TableModelObserver* observer)
+        : observer_(observer),
+        model_(NULL),
+        model_changed_(false),
+        flush_factory_(this)
+    {
+        DCHECK(observer);
+    }
+
+    BatchedTableModelObserver::~BatchedTableModelObserver() {}
+
+    void BatchedTableModelObserver::SetModel(TableModel* model)
+    {
+        model_ = model;
+        changes_.clear();
+        model_changed_ = false;
+        flush_factory_.RevokeAll();
+    }
+
+    void BatchedTableModelObserver::Flush()
+    {
+        flush_factory_.RevokeAll();
+        if(!HasPendingChanges())
+        {
+            return;
+        }
+
+        // The observer may change the model again while it's being notified;
+        // those changes start a new batch.
+        std::vector<Change> changes;
+        changes.swap(changes_);
+        bool model_changed = model_changed_;
+        model_changed_ = false;
+
+        if(model_changed)
+        {
+            observer_->OnModelChanged();
+            return;
+        }
+
+        // The observer reads rows from the model as it is now, not as it was
+        // after each change, so with more than one change some of the rows it
+        // read may have come from the wrong index. Those rows are read again.
+        int refresh_start = 0;
+        int refresh_end = 0;
+        if(changes.size() > 1)
+        {
+            GetRowsToRefresh(changes, &refresh_start, &refresh_end);
+        }
+
+        for(size_t i=0; i<changes.size(); ++i)
+        {
+            const Change& change = changes[i];
+            switch(change.type)
+            {
+            case ITEMS_CHANGED:
+                observer_->OnItemsChanged(change.start, change.length);
+                break;
+            case ITEMS_ADDED:
+                observer_->OnItemsAdded(change.start, change.length);
+                break;
+            case ITEMS_REMOVED:
+                observer_->OnItemsRemoved(change.start, change.length);
+                break;
+            }
+        }
+
+        if(refresh_end == -1)
+        {
+            observer_->OnItemsChanged(refresh_start, -1);
+        }
+        else if(refresh_start < refresh_end)
+        {
+            observer_->OnItemsChanged(refresh_start, refresh_end-refresh_start);
+        }
+    }
+
+    void BatchedTableModelObserver::OnModelChanged()
+    {
+        changes_.clear();
+        model_changed_ = true;
+        ScheduleFlush();
+    }
+
+    void BatchedTableModelObserver::OnItemsChanged(int start, int length)
+    {
+        if(length==-1 && model_)
+        {
+            DCHECK_GE(start, 0);
+            length = model_->RowCount() - start;
+        }
+        AddChange(ITEMS_CHANGED, start, length);
+    }
+
+    void BatchedTableModelObserver::OnItemsAdded(int start, int length)
+    {
+        AddChange(ITEMS_ADDED, start, length);
+    }
+
+    void BatchedTableModelObserver::OnItemsRemoved(int start, int length)
+    {
+        AddChange(ITEMS_REMOVED, start, length);
+    }
+
+    void BatchedTableModelObserver::AddChange(ChangeType type,
+        int start, int length)
+    {
+        if(model_changed_ || length==0)
+        {
+            // The observer reloads everything anyway.
+            return;
+        }
+
+        Change change(type, start, length);
+        if(changes_.empty() || !MergeWithLast(change))
+        {
+            changes_.push_back(change);
+        }
+        ScheduleFlush();
+    }
+
+    bool BatchedTableModelObserver::MergeWithLast(const Change& change)
+    {
+        Change& last = changes_.back();
+        const int last_end = last.start + last.length;
+        const int end = change.start + change.length;
+        if(change.length < 0)
+        {
+            return false;
+        }
+
+        if(last.type == ITEMS_ADDED)
+        {
+            if(change.type==ITEMS_ADDED &&
+                change.start>=last.start && change.start<=last_end)
+            {
+                // Rows inserted into or next to the added block extend it.
+                last.length += change.length;
+                return true;
+            }
+            if(change.start>=last.start && end<=last_end)
+            {
+                if(change.type == ITEMS_REMOVED)
+                {
+                    // Rows added and removed again were never seen.
+                    last.length -= change.length;
+                    if(last.length == 0)
+                    {
+                        changes_.pop_back();
+                    }
+                }
+                // Added rows are read in full when they're added.
+                return true;
+            }
+            return false;
+        }
+
+        if(last.type==ITEMS_REMOVED && change.type==ITEMS_REMOVED)
+        {
+            // The rows removed before sit at last.start now, so a removal
+            // reaching that point joins up with them.
+            if(change.start<=last.start && end>=last.start)
+            {
+                last.start = change.start;
+                last.length += change.length;
+                return true;
+            }
+            return false;
+        }
+
+        if(last.type==ITEMS_CHANGED && change.type==ITEMS_CHANGED &&
+            last.length>=0)
+        {
+            // Join changed ranges unless the rows between them would outnumber
+            // the rows that actually changed.
+            int gap = std::max(change.start, last.start) - std::min(end, last_end);
+            if(gap <= last.length+change.length)
+            {
+                int start = std::min(change.start, last.start);
+                last.length = std::max(end, last_end) - start;
+                last.start = start;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // static
+    void BatchedTableModelObserver::GetRowsToRefresh(
+        const std::vector<Change>& changes, int* start, int* end)
+    {
+        *start = 0;
+        *end = 0;
+        for(size_t i=0; i<changes.size(); ++i)
+        {
+            const Change& change = changes[i];
+            if(change.type == ITEMS_REMOVED)
+            {
+                continue;
+            }
+
+            // Follow the rows this change read through the changes after it,
+            // to where they are in the model now. An end of -1 is open. Rows
+            // that no later change moved were read from the right index.
+            int first = change.start;
+            int last = change.length<0 ? -1 : change.start+change.length;
+            bool moved = false;
+            for(size_t j=i+1; j<changes.size() && first!=last; ++j)
+            {
+                const Change& later = changes[j];
+                const int later_end = later.start + later.length;
+                moved |= later.type != ITEMS_CHANGED;
+                if(later.type == ITEMS_ADDED)
+                {
+                    if(first >= later.start)
+                    {
+                        first += later.length;
+                    }
+                    if(last!=-1 && last>later.start)
+                    {
+                        last += later.length;
+                    }
+                }
+                else if(later.type == ITEMS_REMOVED)
+                {
+                    if(first >= later_end)
+                    {
+                        first -= later.length;
+                    }
+                    else if(first > later.start)
+                    {
+                        first = later.start;
+                    }
+                    if(last!=-1 && last>=later_end)
+                    {
+                        last -= later.length;
+                    }
+                    else if(last > later.start)
+                    {
+                        last = later.start;
+                    }
+                }
+            }
+            if(!moved || first==last)
+            {
+                continue;
+            }
+
+            if(*start == *end)
+            {
+                *start = first;
+                *end = last;
+            }
+            else
+            {
+                *start = std::min(*start, first);
+                *end = (*end==-1 || last==-1) ? -1 : std::max(*end, last);
+            }
+        }
+    }
+
+    void BatchedTableModelObserver::ScheduleFlush()
+    {
+        if(!MessageLoop::current())
+        {
+            Flush();
+            return;
+        }
+        if(flush_factory_.empty())
+        {
+            MessageLoop::current()->PostTask(flush_factory_.NewRunnableMethod(
+                &BatchedTableModelObserver::Flush));
+        }
+    }
+
+} //namespace ui
@@ -0,0 +1,102 @@
+#ifndef __ui_base_batched_table_model_observer_h__
+#define __ui_base_batched_table_model_observer_h__
+
+#pragma once
+
+#include <vector>
+
+#include "base/task.h"
+
+#include "table_model_observer.h"
+
+namespace ui
+{
+
+    class TableModel;
+
+    // A TableModelObserver that collects the notifications of a model during a
+    // message loop turn and passes them on to another observer in one go from a
+    // posted task. Notifications that extend each other are coalesced on the
+    // way: rows added one at a time at the end of a list arrive as a single
+    // OnItemsAdded, and rows added and then removed or changed before the flush
+    // are never seen by the observer at all.
+    //
+    // The observer's view of the model lags until the flush, so an observer
+    // that is asked about model rows in the meantime should call Flush() first.
+    class BatchedTableModelObserver : public TableModelObserver
+    {
+    public:
+        // |observer| receives the coalesced notifications; it's not owned.
+        explicit BatchedTableModelObserver(TableModelObserver* observer);
+        virtual ~BatchedTableModelObserver();
+
+        // Sets the model being observed, used to resolve OnItemsChanged(start,
+        // -1) against the row count at the time of the notification. Pending
+        // notifications are dropped.
+        void SetModel(TableModel* model);
+
+        // Passes the pending notifications on now.
+        void Flush();
+
+        bool HasPendingChanges() const
+        {
+            return model_changed_ || !changes_.empty();
+        }
+
+        // TableModelObserver overrides.
+        virtual void OnModelChanged();
+        virtual void OnItemsChanged(int start, int length);
+        virtual void OnItemsAdded(int start, int length);
+        virtual void OnItemsRemoved(int start, int length);
+
+    private:
+        enum ChangeType
+        {
+            ITEMS_CHANGED,
+            ITEMS_ADDED,
+            ITEMS_REMOVED
+        };
+
+        struct Change
+        {
+            Change(ChangeType type, int start, int length)
+                : type(type), start(start), length(length) {}
+
+            ChangeType type;
+            int start;
+            int length;
+        };
+
+        // Appends a change, merging it into the last one where possible.
+        void AddChange(ChangeType type, int start, int length);
+
+        // Merges |change| into the last pending change. Returns false if the two
+        // can't be expressed as one.
+        bool MergeWithLast(const Change& change);
+
+        // Sets [start, end) to the rows, in the current model, that |changes|
+        // had the observer read from the model. |end| is -1 if the rows run to
+        // the end of the model, and |start| == |end| if there are none.
+        static void GetRowsToRefresh(const std::vector<Change>& changes,
+            int* start, int* end);
+
+        void ScheduleFlush();
+
+        TableModelObserver* observer_;
+        TableModel* model_;
+
+        // Changes in the order they happened, each in the row indices of the
+        // model as it was at the time.
+        std::vector<Change> changes_;
+
+        // Set when the whole model changed; later changes are subsumed by it.
+        bool model_changed_;
+
+        ScopedRunnableMethodFactory<BatchedTableModelObserver> flush_factory_;
+
+        DISALLOW_COPY_AND_ASSIGN(BatchedTableModelObserver);
+    };
+
+} //namespace ui
+
+#endif //__ui_base_batched_table_model_observer_h__
@@ -116,4 +116,28 @@ namespace ui
         return lstrcmpW(value1.c_str(), value2.c_str());
     }
 
+    bool TableModel::GetSortKey(int row, int column_id, std::string* key)
+    {
+        return false;
+    }
+
+    bool TableModel::GetTextSortKey(int row, int column_id, std::string* key)
+    {
+        DCHECK(row>=0 && row<RowCount());
+        string16 value = GetText(row, column_id);
+
+        // lstrcmpW compares with the user's locale and no flags; the sort key
+        // LCMapStringW builds with the same settings orders the same way.
+        int size = LCMapStringW(LOCALE_USER_DEFAULT, LCMAP_SORTKEY,
+            value.c_str(), -1, NULL, 0);
+        if(size <= 0)
+        {
+            return false;
+        }
+        key->resize(size);
+        LCMapStringW(LOCALE_USER_DEFAULT, LCMAP_SORTKEY, value.c_str(), -1,
+            reinterpret_cast<LPWSTR>(&(*key)[0]), size);
+        return true;
+    }
+
 } //namespace ui
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include "base/string16.h"
@@ -78,8 +79,22 @@ namespace ui
         // comparison.
         virtual int CompareValues(int row1, int row2, int column_id);
 
+        // Sets |key| to a sort key for the value in the column with id
+        // |column_id| of |row|. Comparing two keys byte by byte must order them
+        // the way CompareValues orders the rows. Returns false if the column can
+        // only be sorted through CompareValues.
+        //
+        // This implementation returns false. Models that keep the default
+        // CompareValues can return GetTextSortKey here; models that override
+        // CompareValues must only return keys that order the same way.
+        virtual bool GetSortKey(int row, int column_id, std::string* key);
+
     protected:
         virtual ~TableModel() {}
+
+        // Sets |key| to the collation key of GetText for the locale the default
+        // CompareValues compares in.
+        bool GetTextSortKey(int row, int column_id, std::string* key);
     };
 
     // TableColumn specifies the title, alignment and size of a particular column.
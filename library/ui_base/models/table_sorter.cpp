@@ -0,0 +1,285 @@
+#include "table_sorter.h"
+
+#include <algorithm>
+#include <string>
+
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/sys_info.h"
+#include "base/threading/worker_pool.h"
+
+#include "table_model.h"
+
+namespace
+{
+
+    // Each sort job gets at least this many rows; below that, handing rows to
+    // the worker pool costs more than sorting them on the calling thread.
+    const int kMinRowsPerJob = 16 * 1024;
+
+    // A row being sorted. The group and a prefix of the primary key are kept
+    // inline, which settles most comparisons without touching the key strings.
+    struct SortEntry
+    {
+        int group;
+        int key_row;
+        uint64 prefix;
+        int row;
+    };
+
+    // The first eight bytes of |key| as a big-endian number, zero padded. When
+    // two prefixes differ they order the same way as the keys themselves.
+    uint64 KeyPrefix(const std::string& key)
+    {
+        uint64 prefix = 0;
+        for(size_t i=0; i<8; ++i)
+        {
+            prefix <<= 8;
+            if(i < key.size())
+            {
+                prefix |= static_cast<uint8>(key[i]);
+            }
+        }
+        return prefix;
+    }
+
+    // The keys of every sort column, indexed by key row.
+    struct SortKeys
+    {
+        std::vector<std::vector<std::string> > keys;
+        std::vector<bool> ascending;
+    };
+
+    // Orders entries by group, then by each column's key, then by model row,
+    // so that no two rows compare equal.
+    class SortEntryLess
+    {
+    public:
+        explicit SortEntryLess(const SortKeys* keys) : keys_(keys) {}
+
+        bool operator()(const SortEntry& a, const SortEntry& b) const
+        {
+            if(a.group != b.group)
+            {
+                return a.group < b.group;
+            }
+            if(a.prefix != b.prefix)
+            {
+                return (a.prefix < b.prefix) == keys_->ascending[0];
+            }
+            if(a.key_row != b.key_row)
+            {
+                for(size_t i=0; i<keys_->keys.size(); ++i)
+                {
+                    int result = keys_->keys[i][a.key_row].compare(
+                        keys_->keys[i][b.key_row]);
+                    if(result != 0)
+                    {
+                        return (result < 0) == keys_->ascending[i];
+                    }
+                }
+            }
+            return a.row < b.row;
+        }
+
+    private:
+        const SortKeys* keys_;
+    };
+
+    // One pass of the parallel merge sort. With a |width| of 0 each task sorts
+    // one chunk of |src| (between consecutive |bounds|) in place; otherwise
+    // each task merges a pair of adjacent runs of |width| chunks from |src|
+    // into |dst|. Jobs pull tasks from |next_task|; the last job to finish
+    // signals |done|.
+    struct SortPass
+    {
+        SortPass(const SortEntryLess& l, SortEntry* s, SortEntry* d,
+            const std::vector<int>& b, int w, int tasks)
+            : less(l), src(s), dst(d), bounds(b), width(w), task_count(tasks),
+            next_task(0), pending_jobs(tasks), done(true, false) {}
+
+        const SortEntryLess& less;
+        SortEntry* src;
+        SortEntry* dst;
+        const std::vector<int>& bounds;
+        int width;
+        int task_count;
+        volatile base::subtle::Atomic32 next_task;
+        volatile base::subtle::Atomic32 pending_jobs;
+        base::WaitableEvent done;
+    };
+
+    void RunSortPassJob(SortPass* pass)
+    {
+        const int chunks = static_cast<int>(pass->bounds.size()) - 1;
+        for(;;)
+        {
+            int task = base::subtle::NoBarrier_AtomicIncrement(
+                &pass->next_task, 1) - 1;
+            if(task >= pass->task_count)
+            {
+                break;
+            }
+
+            if(pass->width == 0)
+            {
+                std::sort(pass->src+pass->bounds[task],
+                    pass->src+pass->bounds[task+1], pass->less);
+            }
+            else
+            {
+                int chunk = 2 * task * pass->width;
+                int begin = pass->bounds[chunk];
+                int middle = pass->bounds[std::min(chunk+pass->width, chunks)];
+                int end = pass->bounds[std::min(chunk+2*pass->width, chunks)];
+                std::merge(pass->src+begin, pass->src+middle,
+                    pass->src+middle, pass->src+end,
+                    pass->dst+begin, pass->less);
+            }
+        }
+
+        if(base::subtle::Barrier_AtomicIncrement(&pass->pending_jobs, -1) == 0)
+        {
+            pass->done.Signal();
+        }
+    }
+
+    // Runs one job per task of |pass|, one of them on the calling thread, and
+    // waits for all of them.
+    void RunSortPass(SortPass* pass)
+    {
+        // If a job can't be posted, run it here as well so |pending_jobs|
+        // still reaches zero.
+        for(int i=1; i<pass->task_count; ++i)
+        {
+            if(!base::WorkerPool::PostTask(
+                base::Bind(&RunSortPassJob, pass), false))
+            {
+                RunSortPassJob(pass);
+            }
+        }
+        RunSortPassJob(pass);
+
+        pass->done.Wait();
+    }
+
+    // Sorts |entries| with one chunk per processor, then merges the sorted
+    // chunks pairwise, each round of merges in parallel as well.
+    void ParallelSort(std::vector<SortEntry>* entries, const SortEntryLess& less)
+    {
+        const int count = static_cast<int>(entries->size());
+        int jobs = std::min(base::SysInfo::NumberOfProcessors(),
+            count / kMinRowsPerJob);
+        if(jobs <= 1)
+        {
+            std::sort(entries->begin(), entries->end(), less);
+            return;
+        }
+
+        std::vector<int> bounds(jobs+1);
+        for(int i=0; i<=jobs; ++i)
+        {
+            bounds[i] = static_cast<int>(static_cast<int64>(count) * i / jobs);
+        }
+
+        std::vector<SortEntry> scratch(count);
+        SortEntry* src = &(*entries)[0];
+        SortEntry* dst = &scratch[0];
+
+        SortPass sort_pass(less, src, NULL, bounds, 0, jobs);
+        RunSortPass(&sort_pass);
+
+        for(int width=1; width<jobs; width*=2)
+        {
+            int tasks = (jobs + 2 * width - 1) / (2 * width);
+            SortPass merge_pass(less, src, dst, bounds, width, tasks);
+            RunSortPass(&merge_pass);
+            std::swap(src, dst);
+        }
+
+        if(src != &(*entries)[0])
+        {
+            entries->swap(scratch);
+        }
+    }
+
+}
+
+namespace ui
+{
+
+    TableSorter::TableSorter(TableModel* model)
+        : model_(model), sort_by_group_(false)
+    {
+        DCHECK(model);
+    }
+
+    TableSorter::~TableSorter() {}
+
+    void TableSorter::AddColumn(int column_id, bool ascending)
+    {
+        Column column = { column_id, ascending };
+        columns_.push_back(column);
+    }
+
+    bool TableSorter::Sort(int row_count, std::vector<int>* view_to_model)
+    {
+        DCHECK(view_to_model);
+        DCHECK(!columns_.empty());
+        DCHECK(key_rows_.empty() ||
+            static_cast<int>(key_rows_.size())==row_count);
+
+        SortKeys keys;
+        keys.keys.resize(columns_.size());
+        for(size_t i=0; i<columns_.size(); ++i)
+        {
+            keys.keys[i].resize(row_count);
+            keys.ascending.push_back(columns_[i].ascending);
+        }
+
+        // Fetch the group and keys of each key row once, however many rows
+        // share it.
+        std::vector<int> groups(sort_by_group_ ? row_count : 0);
+        std::vector<bool> fetched(row_count, false);
+        std::vector<SortEntry> entries(row_count);
+        for(int row=0; row<row_count; ++row)
+        {
+            int key_row = key_rows_.empty() ? row : key_rows_[row];
+            DCHECK(key_row>=0 && key_row<row_count);
+            if(!fetched[key_row])
+            {
+                for(size_t i=0; i<columns_.size(); ++i)
+                {
+                    if(!model_->GetSortKey(key_row, columns_[i].column_id,
+                        &keys.keys[i][key_row]))
+                    {
+                        return false;
+                    }
+                }
+                if(sort_by_group_)
+                {
+                    groups[key_row] = model_->GetGroupID(key_row);
+                }
+                fetched[key_row] = true;
+            }
+
+            SortEntry& entry = entries[row];
+            entry.group = sort_by_group_ ? groups[key_row] : 0;
+            entry.prefix = KeyPrefix(keys.keys[0][key_row]);
+            entry.key_row = key_row;
+            entry.row = row;
+        }
+
+        ParallelSort(&entries, SortEntryLess(&keys));
+
+        view_to_model->resize(row_count);
+        for(int i=0; i<row_count; ++i)
+        {
+            (*view_to_model)[i] = entries[i].row;
+        }
+        return true;
+    }
+
+} //namespace ui
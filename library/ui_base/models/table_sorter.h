@@ -0,0 +1,68 @@
+#ifndef __ui_base_table_sorter_h__
+#define __ui_base_table_sorter_h__
+
+#pragma once
+
+#include <vector>
+
+#include "base/basic_types.h"
+
+namespace ui
+{
+
+    class TableModel;
+
+    // Orders the rows of a TableModel by precomputed sort keys. The key of
+    // every row is fetched once per sort column (TableModel::GetSortKey)
+    // instead of calling CompareValues, and so GetText, on every comparison.
+    // The keys are then merge sorted, with large tables split across worker
+    // threads. The sorter doesn't need a view, so it can be run headless.
+    class TableSorter
+    {
+    public:
+        explicit TableSorter(TableModel* model);
+        ~TableSorter();
+
+        // Adds a sort column. The first column added is the primary sort; each
+        // later one breaks the ties left by those before it.
+        void AddColumn(int column_id, bool ascending);
+
+        // When set, rows are first ordered by TableModel::GetGroupID, ascending
+        // whatever the direction of the columns.
+        void set_sort_by_group(bool sort_by_group)
+        {
+            sort_by_group_ = sort_by_group;
+        }
+
+        // Takes the group and keys of model row i from row key_rows[i] instead,
+        // so that a set of rows sorts as a unit. Must have an entry per row.
+        void set_key_rows(const std::vector<int>& key_rows)
+        {
+            key_rows_ = key_rows;
+        }
+
+        // Sorts the rows [0, row_count) and fills |view_to_model| with the model
+        // row shown at each view index. Rows that compare equal keep their model
+        // order. Returns false, leaving |view_to_model| untouched, if the model
+        // has no sort keys for one of the columns; the rows then have to be
+        // sorted through TableModel::CompareValues.
+        bool Sort(int row_count, std::vector<int>* view_to_model);
+
+    private:
+        struct Column
+        {
+            int column_id;
+            bool ascending;
+        };
+
+        TableModel* model_;
+        std::vector<Column> columns_;
+        bool sort_by_group_;
+        std::vector<int> key_rows_;
+
+        DISALLOW_COPY_AND_ASSIGN(TableSorter);
+    };
+
+} //namespace ui
+
+#endif //__ui_base_table_sorter_h__
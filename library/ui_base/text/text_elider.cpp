@@ -1,6 +1,10 @@
 
 #include "text_elider.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "base/i18n/rtl.h"
 #include "base/logging.h"
 #include "base/utf_string_conversions.h"
 
@@ -16,27 +20,42 @@ namespace ui
         // Cuts |text| to be |length| characters long.  If |cut_in_middle| is true, the
         // middle of the string is removed to leave equal-length pieces from the
         // beginning and end of the string; otherwise, the end of the string is removed
-        // and only the beginning remains.  If |insert_ellipsis| is true, then an
-        // ellipsis character will by inserted at the cut point.
+        // and only the beginning remains.  |insert| (e.g. an ellipsis) is inserted at
+        // the cut point.
         string16 CutString(const string16& text,
             size_t length,
             bool cut_in_middle,
-            bool insert_ellipsis)
+            const string16& insert)
         {
             // TODO(tony): This is wrong, it might split the string in the middle of a
             // surrogate pair.
-            const string16 kInsert = insert_ellipsis ? UTF8ToUTF16(kEllipsis) :
-                ASCIIToUTF16("");
             if(!cut_in_middle)
             {
-                return text.substr(0, length) + kInsert;
+                return text.substr(0, length) + insert;
             }
             // We put the extra character, if any, before the cut.
             const size_t half_length = length / 2;
-            return text.substr(0, length-half_length) + kInsert +
+            return text.substr(0, length-half_length) + insert +
                 text.substr(text.length()-half_length, half_length);
         }
 
+        // Returns the width CutString() leaves of the text, not counting what is
+        // inserted, from |prefix_widths|, the widths of the text's prefixes.
+        int GetCutWidth(const std::vector<int>& prefix_widths,
+            size_t length,
+            bool cut_in_middle)
+        {
+            if(!cut_in_middle)
+            {
+                return prefix_widths[length];
+            }
+            const size_t text_length = prefix_widths.size() - 1;
+            const size_t half_length = length / 2;
+            return prefix_widths[length-half_length] +
+                prefix_widths[text_length] -
+                prefix_widths[text_length-half_length];
+        }
+
     }
 
     // This function adds an ellipsis at the end of the text if the text
@@ -63,8 +82,8 @@ namespace ui
         // ridiculous), but we should check other widths for bogus values as well.
         if(current_text_pixel_width<=0 && !text.empty())
         {
-            return ElideText(CutString(text, text.length()/2, elide_in_middle, false),
-                font, available_pixel_width, false);
+            return ElideText(CutString(text, text.length()/2, elide_in_middle,
+                string16()), font, available_pixel_width, false);
         }
 
         if(current_text_pixel_width <= available_pixel_width)
@@ -72,26 +91,77 @@ namespace ui
             return text;
         }
 
-        if(font.GetStringWidth(UTF8ToUTF16(kEllipsis)) > available_pixel_width)
+        // In right-to-left text the mark keeps the ellipsis with the run it cuts,
+        // i.e. on the left of an RTL tail instead of at the far right.
+        string16 ellipsis = UTF8ToUTF16(kEllipsis);
+        if(base::i18n::StringContainsStrongRTLChars(text))
+        {
+            ellipsis.push_back(base::i18n::kRightToLeftMark);
+        }
+
+        // The advances come from a per-font cache, so after the measurement
+        // above the cut is found without measuring any more strings.
+        std::vector<int> widths;
+        font.GetCharacterWidths(ellipsis, &widths);
+        int ellipsis_width = 0;
+        for(size_t i=0; i<widths.size(); ++i)
+        {
+            ellipsis_width += widths[i];
+        }
+        if(ellipsis_width > available_pixel_width)
         {
             return string16();
         }
 
-        // Use binary search to compute the elided text.
+        font.GetCharacterWidths(text, &widths);
+        std::vector<int> prefix_widths(text.length()+1, 0);
+        for(size_t i=0; i<text.length(); ++i)
+        {
+            prefix_widths[i+1] = prefix_widths[i] + widths[i];
+        }
+
+        // Use binary search over the prefix widths to compute the elided text.
+        // The whole text doesn't fit, so |hi| never does.
+        const int available_text_width = available_pixel_width - ellipsis_width;
         size_t lo = 0;
-        size_t hi = text.length() - 1;
+        size_t hi = text.length();
+        for(size_t guess=(lo+hi)/2; guess!=lo; guess=(lo+hi)/2)
+        {
+            if(GetCutWidth(prefix_widths, guess, elide_in_middle) >
+                available_text_width)
+            {
+                hi = guess;
+            }
+            else
+            {
+                lo = guess;
+            }
+        }
+
+        // The advances know nothing of kerning, ligatures or shaping, so check
+        // the result with one real measurement.
+        string16 elided = CutString(text, lo, elide_in_middle, ellipsis);
+        int elided_width = font.GetStringWidth(elided);
+        if(elided_width>0 && elided_width<=available_pixel_width)
+        {
+            return elided;
+        }
+
+        // It didn't fit after all: search the shorter cuts by measuring them.
+        hi = lo;
+        lo = 0;
         for(size_t guess=(lo+hi)/2; guess!=lo; guess=(lo+hi)/2)
         {
             // We check the length of the whole desired string at once to ensure we
             // handle kerning/ligatures/etc. correctly.
             int guess_length = font.GetStringWidth(CutString(text, guess,
-                elide_in_middle, true));
+                elide_in_middle, ellipsis));
             // Check again that we didn't hit a Pango width overflow. If so, cut the
             // current string in half and start over.
             if(guess_length <= 0)
             {
-                return ElideText(CutString(text, guess/2, elide_in_middle, false),
-                    font, available_pixel_width, elide_in_middle);
+                return ElideText(CutString(text, guess/2, elide_in_middle,
+                    string16()), font, available_pixel_width, elide_in_middle);
             }
             if(guess_length > available_pixel_width)
             {
@@ -103,7 +173,7 @@ namespace ui
             }
         }
 
-        return CutString(text, lo, elide_in_middle, true);
+        return CutString(text, lo, elide_in_middle, ellipsis);
     }
 
     bool ElideString(const string16& input, int max_len, string16* output)
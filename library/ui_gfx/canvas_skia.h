@@ -136,6 +136,13 @@ namespace gfx
             int x, int y, int w, int h,
             int flags);
 
+        // DrawText()ĸʽ־|format|ڸı.
+        void DrawTextInt(const string16& text,
+            HFONT font,
+            const SkColor& color,
+            int x, int y, int w, int h,
+            int format);
+
         DISALLOW_COPY_AND_ASSIGN(CanvasSkia);
     };
 
@@ -11,6 +11,7 @@
 #include "color_utils.h"
 #include "font.h"
 #include "rect.h"
+#include "text_layout_cache.h"
 
 namespace
 {
@@ -43,6 +44,32 @@ namespace
         DrawText(hdc, string_ptr, string_size, text_bounds, flags);
     }
 
+    // Longest text that SizeStringInt() measures; see there.
+    const int kMaxMeasuredStringLength = 2048 - 1; // So the trailing \0 fits in 2K.
+
+    // Returns the cached layout that breaks multi-line |text| into lines of at
+    // most |width|, or NULL if DrawText() breaks it instead. Right-to-left
+    // reading changes where DrawText() puts the ellipsis and punctuation, so
+    // it's left to DrawText(), as is text the font can only draw through font
+    // linking. Measuring and painting both go through here, so they break the
+    // text the same way. The layout is valid until the cache is used again.
+    const gfx::TextLayout* GetMultiLineLayout(const string16& text,
+        const gfx::Font& font, int flags, int width)
+    {
+        if(!(flags & gfx::Canvas::MULTI_LINE) || text.empty() ||
+            static_cast<int>(text.length())>kMaxMeasuredStringLength ||
+            (flags & gfx::Canvas::FORCE_RTL_DIRECTIONALITY) ||
+            !gfx::TextLayoutCache::CanLayOut(text, flags))
+        {
+            return NULL;
+        }
+
+        const gfx::TextLayout& layout =
+            gfx::TextLayoutCache::GetInstance()->GetLayout(text, font, flags,
+            width);
+        return layout.has_all_glyphs ? &layout : NULL;
+    }
+
     // Compute the windows flags necessary to implement the provided text Canvas
     // flags.
     int ComputeFormatFlags(int flags, const string16& text)
@@ -331,8 +358,7 @@ namespace gfx
         // Clamp the max amount of text we'll measure to 2K.  When the string is
         // actually drawn, it will be clipped to whatever size box is provided, and
         // the time to do that doesn't depend on the length being clipped off.
-        const int kMaxStringLength = 2048 - 1; // So the trailing \0 fits in 2K.
-        string16 clamped_string(text.substr(0, kMaxStringLength));
+        string16 clamped_string(text.substr(0, kMaxMeasuredStringLength));
 
         if(*width == 0)
         {
@@ -354,6 +380,27 @@ namespace gfx
                 *width = 1;
             }
         }
+
+        // Multi-line text is measured with the layout DrawStringInt() paints.
+        const TextLayout* layout = GetMultiLineLayout(clamped_string, font,
+            flags, *width);
+        if(layout)
+        {
+            *width = layout->width;
+            *height = layout->height;
+            return;
+        }
+
+        // Labels and menus measure the same strings on every layout, and
+        // DrawText(DT_CALCRECT) is the expensive part, so its result is cached.
+        const int max_width = *width;
+        TextLayoutCache* cache = TextLayoutCache::GetInstance();
+        if(!clamped_string.empty() && cache->GetMeasuredSize(clamped_string,
+            font, flags, max_width, width, height))
+        {
+            return;
+        }
+
         RECT r = { 0, 0, *width, *height };
 
         HDC dc = GetDC(NULL);
@@ -365,6 +412,12 @@ namespace gfx
 
         *width = r.right;
         *height = r.bottom;
+
+        if(!clamped_string.empty())
+        {
+            cache->SetMeasuredSize(clamped_string, font, flags, max_width,
+                *width, *height);
+        }
     }
 
     void CanvasSkia::DrawStringInt(const string16& text,
@@ -372,6 +425,23 @@ namespace gfx
         const SkColor& color,
         int x, int y, int w, int h,
         int flags)
+    {
+        // Clamp the max amount of text we'll draw to 32K.  There seem to be bugs in
+        // DrawText() if you e.g. ask it to character-break a no-whitespace string of
+        // length > 43680 (for which it draws nothing), and since we clamped to 2K in
+        // SizeStringInt() we're unlikely to be able to display this much anyway.
+        const int kMaxStringLength = 32768 - 1; // So the trailing \0 fits in 32K.
+        string16 clamped_string(text.substr(0, kMaxStringLength));
+
+        DrawTextInt(clamped_string, font, color, x, y, w, h,
+            ComputeFormatFlags(flags, clamped_string));
+    }
+
+    void CanvasSkia::DrawTextInt(const string16& text,
+        HFONT font,
+        const SkColor& color,
+        int x, int y, int w, int h,
+        int format)
     {
         SkRect fclip;
         if(!getClipBounds(&fclip))
@@ -386,13 +456,6 @@ namespace gfx
             return;
         }
 
-        // Clamp the max amount of text we'll draw to 32K.  There seem to be bugs in
-        // DrawText() if you e.g. ask it to character-break a no-whitespace string of
-        // length > 43680 (for which it draws nothing), and since we clamped to 2K in
-        // SizeStringInt() we're unlikely to be able to display this much anyway.
-        const int kMaxStringLength = 32768 - 1; // So the trailing \0 fits in 32K.
-        string16 clamped_string(text.substr(0, kMaxStringLength));
-
         HDC dc;
         HFONT old_font;
         {
@@ -404,8 +467,7 @@ namespace gfx
                 SkColorGetB(color));
             SetTextColor(dc, brush_color);
 
-            int f = ComputeFormatFlags(flags, clamped_string);
-            DoDrawText(dc, clamped_string, &text_bounds, f);
+            DoDrawText(dc, text, &text_bounds, format);
         }
 
         // Restore the old font. This way we don't have to worry if the caller
@@ -424,6 +486,30 @@ namespace gfx
         int x, int y, int w, int h,
         int flags)
     {
+        const TextLayout* layout = GetMultiLineLayout(text, font, flags, w);
+        if(layout)
+        {
+            // Draw the lines as the layout broke them, one at a time, rather than
+            // have DrawText() break the text again on every paint. Each line keeps
+            // the format DrawText() would have used for the whole text, so the
+            // ellipsis flags apply as before and NO_ELLIPSIS lines are clipped.
+            // Like DrawText(), multi-line text always starts at the top.
+            const int line_height = font.GetHeight();
+            const int format = (ComputeFormatFlags(flags, text) &
+                ~(DT_WORDBREAK|DT_EDITCONTROL|DT_VCENTER|DT_BOTTOM)) |
+                DT_SINGLELINE | DT_TOP;
+            int line_y = y;
+            for(size_t i=0; i<layout->lines.size() && line_y<y+h; ++i)
+            {
+                const TextLine& line = layout->lines[i];
+                DrawTextInt(text.substr(line.start, line.length),
+                    font.GetNativeFont(), color, x, line_y, w,
+                    std::min(line_height, y+h-line_y), format);
+                line_y += line_height;
+            }
+            return;
+        }
+
         DrawStringInt(text, font.GetNativeFont(), color, x, y, w, h, flags);
     }
 
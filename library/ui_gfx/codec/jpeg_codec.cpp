@@ -9,6 +9,8 @@
 
 #include "SkBitmap.h"
 
+#include "skia/ext/image_operations.h"
+
 namespace gfx
 {
 
@@ -470,6 +472,14 @@ namespace gfx
 
     bool JPEGCodec::Decode(const unsigned char* input, size_t input_size,
         ColorFormat format, std::vector<unsigned char>* output, int* w, int* h)
+    {
+        return DecodeScaled(input, input_size, format, 0, 0, output, w, h);
+    }
+
+    // static
+    bool JPEGCodec::DecodeScaled(const unsigned char* input, size_t input_size,
+        ColorFormat format, int min_width, int min_height,
+        std::vector<unsigned char>* output, int* w, int* h)
     {
         jpeg_decompress_struct cinfo;
         DecompressDestroyer destroyer;
@@ -562,6 +572,25 @@ namespace gfx
         cinfo.output_components = 3;
 #endif
 
+        // Pick the smallest DCT scale (1/8, 1/4, 1/2) that still covers the
+        // requested size. The reduced IDCTs in jidctred.c only compute the low
+        // frequency coefficients, so the full-size image is never produced.
+        if(min_width>0 || min_height>0)
+        {
+            for(unsigned int denom=8; denom>1; denom/=2)
+            {
+                cinfo.scale_num = 1;
+                cinfo.scale_denom = denom;
+                jpeg_calc_output_dimensions(&cinfo);
+                if(static_cast<int>(cinfo.output_width)>=min_width &&
+                    static_cast<int>(cinfo.output_height)>=min_height)
+                {
+                    break;
+                }
+                cinfo.scale_denom = 1;
+            }
+        }
+
         jpeg_calc_output_dimensions(&cinfo);
         *w = cinfo.output_width;
         *h = cinfo.output_height;
@@ -667,4 +696,37 @@ namespace gfx
         return bitmap;
     }
 
+    // static
+    SkBitmap* JPEGCodec::DecodeToSize(const unsigned char* input,
+        size_t input_size, int width, int height)
+    {
+        if(width<=0 || height<=0)
+        {
+            return NULL;
+        }
+
+        int w, h;
+        std::vector<unsigned char> data_vector;
+        if(!DecodeScaled(input, input_size, FORMAT_SkBitmap, width, height,
+            &data_vector, &w, &h))
+        {
+            return NULL;
+        }
+
+        SkBitmap decoded;
+        decoded.setConfig(SkBitmap::kARGB_8888_Config, w, h);
+        decoded.allocPixels();
+        memcpy(decoded.getAddr32(0, 0), &data_vector[0], w*h*4);
+        decoded.setIsOpaque(true);
+        if(w==width && h==height)
+        {
+            return new SkBitmap(decoded);
+        }
+
+        // DCT scaling already did most of the reduction, so a cheap filter is
+        // enough for the rest.
+        return new SkBitmap(skia::ImageOperations::Resize(decoded,
+            skia::ImageOperations::RESIZE_GOOD, width, height));
+    }
+
 } //namespace gfx
\ No newline at end of file
@@ -58,10 +58,26 @@ namespace gfx
             ColorFormat format, std::vector<unsigned char>* output,
             int* w, int* h);
 
+        // Same as Decode() above, but lets libjpeg scale the image down in the
+        // DCT domain (by 1/2, 1/4 or 1/8) as far as it can while both sides stay
+        // at least min_width x min_height. *w and *h receive the scaled size.
+        // Passing 0 for both limits decodes at full resolution.
+        static bool DecodeScaled(const unsigned char* input, size_t input_size,
+            ColorFormat format, int min_width, int min_height,
+            std::vector<unsigned char>* output, int* w, int* h);
+
         // Decodes the JPEG data contained in input of length input_size. If
         // successful, a SkBitmap is created and returned. It is up to the caller
         // to delete the returned bitmap.
         static SkBitmap* Decode(const unsigned char* input, size_t input_size);
+
+        // Decodes the JPEG data into a width x height bitmap. The image is
+        // decoded at the smallest DCT scale that is not below the target and the
+        // remainder is done with a cheap resize, which is much faster and needs
+        // far less memory than decoding at full size for thumbnails. Returns NULL
+        // on failure; the caller owns the returned bitmap.
+        static SkBitmap* DecodeToSize(const unsigned char* input,
+            size_t input_size, int width, int height);
     };
 
 } //namespace gfx
@@ -1,10 +1,19 @@
 
 #include "png_codec.h"
 
+#include <limits.h>
+
+#include <algorithm>
+
 #include "base/algorithm/libpng/png.h"
+#include "base/atomicops.h"
+#include "base/bind.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/string_util.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/sys_info.h"
+#include "base/threading/worker_pool.h"
 
 #include "SkBitmap.h"
 #include "SkUnPreMultiply.h"
@@ -162,6 +171,28 @@ namespace gfx
                 row_converter(NULL),
                 width(0),
                 height(0),
+                max_pixels(0),
+                sample_step(1),
+                output_width(0),
+                output_height(0),
+                done(false) {}
+
+            // Output is a vector<unsigned char> holding at most |max| pixels. The
+            // image is decimated by an integral step when it is larger than that.
+            PngDecoderState(PNGCodec::ColorFormat ofmt, int max,
+                std::vector<unsigned char>* o)
+                : output_format(ofmt),
+                output_channels(0),
+                bitmap(NULL),
+                is_opaque(true),
+                output(o),
+                row_converter(NULL),
+                width(0),
+                height(0),
+                max_pixels(max),
+                sample_step(1),
+                output_width(0),
+                output_height(0),
                 done(false) {}
 
             // Output is an SkBitmap.
@@ -174,6 +205,10 @@ namespace gfx
                 row_converter(NULL),
                 width(0),
                 height(0),
+                max_pixels(0),
+                sample_step(1),
+                output_width(0),
+                output_height(0),
                 done(false) {}
 
             PNGCodec::ColorFormat output_format;
@@ -199,6 +234,23 @@ namespace gfx
             int width;
             int height;
 
+            // When non-zero, the output is decimated so that it holds no more than
+            // this many pixels. Only supported when writing to |output|.
+            int max_pixels;
+
+            // Only every |sample_step|-th row and column is kept. 1 means no
+            // decimation.
+            int sample_step;
+
+            // Size of the data written to the output, which is the image size
+            // divided by |sample_step| (rounded up).
+            int output_width;
+            int output_height;
+
+            // Full-width scratch row used when decimating, so converted pixels of
+            // skipped columns never reach the output buffer.
+            std::vector<unsigned char> sample_row;
+
             // Set to true when we've found the end of the data.
             bool done;
 
@@ -261,6 +313,24 @@ namespace gfx
             state->width = static_cast<int>(w);
             state->height = static_cast<int>(h);
 
+            // Pick the smallest integral step that brings the output under the
+            // requested pixel budget.
+            state->sample_step = 1;
+            if(state->max_pixels>0 && !state->bitmap)
+            {
+                while(static_cast<unsigned long long>(
+                    (state->width + state->sample_step - 1) / state->sample_step) *
+                    ((state->height + state->sample_step - 1) / state->sample_step) >
+                    static_cast<unsigned long long>(state->max_pixels))
+                {
+                    ++state->sample_step;
+                }
+            }
+            state->output_width =
+                (state->width + state->sample_step - 1) / state->sample_step;
+            state->output_height =
+                (state->height + state->sample_step - 1) / state->sample_step;
+
             // Expand to ensure we use 24-bit for RGB and 32-bit for RGBA.
             if(color_type==PNG_COLOR_TYPE_PALETTE ||
                 (color_type==PNG_COLOR_TYPE_GRAY && bit_depth<8))
@@ -378,8 +448,12 @@ namespace gfx
             }
             else if(state->output)
             {
-                state->output->resize(state->width *
-                    state->output_channels * state->height);
+                state->output->resize(state->output_width *
+                    state->output_channels * state->output_height);
+                if(state->sample_step > 1)
+                {
+                    state->sample_row.resize(state->width * state->output_channels);
+                }
             }
         }
 
@@ -407,6 +481,36 @@ namespace gfx
                 base = &state->output->front();
             }
 
+            if(state->sample_step > 1)
+            {
+                if(row_num % state->sample_step)
+                {
+                    return;
+                }
+
+                // Convert the whole row into scratch space, then keep every
+                // |sample_step|-th pixel.
+                unsigned char* row = &state->sample_row.front();
+                if(state->row_converter)
+                {
+                    state->row_converter(new_row, state->width, row, &state->is_opaque);
+                }
+                else
+                {
+                    memcpy(row, new_row, state->width * state->output_channels);
+                }
+
+                const int channels = state->output_channels;
+                unsigned char* dest = &base[state->output_width * channels *
+                    (row_num / state->sample_step)];
+                for(int x=0; x<state->output_width; ++x)
+                {
+                    memcpy(&dest[x * channels],
+                        &row[x * state->sample_step * channels], channels);
+                }
+                return;
+            }
+
             unsigned char* dest = &base[state->width * state->output_channels * row_num];
             if(state->row_converter)
             {
@@ -519,6 +623,45 @@ namespace gfx
             return true;
     }
 
+    // static
+    bool PNGCodec::DecodeSubsampled(const unsigned char* input,
+        size_t input_size, ColorFormat format, int max_pixels,
+        std::vector<unsigned char>* output, int* w, int* h)
+    {
+        DCHECK(max_pixels > 0);
+        png_struct* png_ptr = NULL;
+        png_info* info_ptr = NULL;
+        if(!BuildPNGStruct(input, input_size, &png_ptr, &info_ptr))
+        {
+            return false;
+        }
+
+        PngReadStructDestroyer destroyer(&png_ptr, &info_ptr);
+        if(setjmp(png_jmpbuf(png_ptr)))
+        {
+            return false;
+        }
+
+        PngDecoderState state(format, max_pixels, output);
+
+        png_set_progressive_read_fn(png_ptr, &state, &DecodeInfoCallback,
+            &DecodeRowCallback, &DecodeEndCallback);
+        png_process_data(png_ptr,
+            info_ptr,
+            const_cast<unsigned char*>(input),
+            input_size);
+
+        if(!state.done)
+        {
+            output->clear();
+            return false;
+        }
+
+        *w = state.output_width;
+        *h = state.output_height;
+        return true;
+    }
+
     // static
     bool PNGCodec::Decode(const unsigned char* input, size_t input_size,
         SkBitmap* bitmap)
@@ -699,6 +842,431 @@ namespace gfx
         typedef void (*FormatConverter)(const unsigned char* in, int w,
             unsigned char* out, bool* is_opaque);
 
+        // Strip encoder ----------------------------------------------------------
+        //
+        // libpng filters and deflates the rows one after another on the calling
+        // thread, which takes a long time for large images. For those we filter
+        // the rows ourselves and cut the filtered data into strips that are
+        // deflated in parallel on the worker pool. Each strip is a raw deflate
+        // stream primed with the 32K of data in front of it and closed with a
+        // sync flush (the last one with Z_FINISH), so the strips join into a
+        // single zlib stream that any decoder reads as usual.
+
+        // Amount of filtered data deflated by one job.
+        const size_t kStripSize = 256 * 1024;
+
+        // Images with less filtered data than this go through libpng directly.
+        const size_t kMinStripEncodeSize = 2 * kStripSize;
+
+        // Size of the deflate window, and so of the useful preset dictionary.
+        const size_t kDictionarySize = 32 * 1024;
+
+        // PNGCodec::PRESET_SPEED settings. UI snapshots are mostly flat colors
+        // where None, Sub or Up already remove almost everything, so the filter
+        // is chosen from every kSpeedSampleStep-th pixel of the row and zlib runs
+        // at a low level.
+        const int kSpeedCompressionLevel = 2;
+        const int kSpeedSampleStep = 4;
+
+        inline unsigned char PaethPredictor(int a, int b, int c)
+        {
+            int p = a + b - c;
+            int pa = abs(p - a);
+            int pb = abs(p - b);
+            int pc = abs(p - c);
+            if(pa<=pb && pa<=pc)
+            {
+                return static_cast<unsigned char>(a);
+            }
+            return static_cast<unsigned char>(pb<=pc ? b : c);
+        }
+
+        // Applies PNG filter |filter| to |row|. |prev| is the unfiltered row
+        // above (all zeros for the first row).
+        void FilterRow(int filter, const unsigned char* row,
+            const unsigned char* prev, int bpp, int row_bytes,
+            unsigned char* out)
+        {
+            switch(filter)
+            {
+            case PNG_FILTER_VALUE_NONE:
+                memcpy(out, row, row_bytes);
+                break;
+            case PNG_FILTER_VALUE_SUB:
+                memcpy(out, row, bpp);
+                for(int i=bpp; i<row_bytes; ++i)
+                {
+                    out[i] = row[i] - row[i-bpp];
+                }
+                break;
+            case PNG_FILTER_VALUE_UP:
+                for(int i=0; i<row_bytes; ++i)
+                {
+                    out[i] = row[i] - prev[i];
+                }
+                break;
+            case PNG_FILTER_VALUE_AVG:
+                for(int i=0; i<bpp; ++i)
+                {
+                    out[i] = row[i] - (prev[i]>>1);
+                }
+                for(int i=bpp; i<row_bytes; ++i)
+                {
+                    out[i] = row[i] - ((row[i-bpp]+prev[i])>>1);
+                }
+                break;
+            case PNG_FILTER_VALUE_PAETH:
+                for(int i=0; i<bpp; ++i)
+                {
+                    out[i] = row[i] - prev[i];
+                }
+                for(int i=bpp; i<row_bytes; ++i)
+                {
+                    out[i] = row[i] - PaethPredictor(row[i-bpp], prev[i],
+                        prev[i-bpp]);
+                }
+                break;
+            default:
+                NOTREACHED();
+            }
+        }
+
+        // Sum of the filtered bytes taken as signed values, the measure libpng
+        // uses to pick a filter. Stops early once the sum reaches |limit|.
+        unsigned int FilteredRowCost(const unsigned char* data, int length,
+            unsigned int limit)
+        {
+            unsigned int sum = 0;
+            for(int i=0; i<length && sum<limit; ++i)
+            {
+                sum += abs(static_cast<signed char>(data[i]));
+            }
+            return sum;
+        }
+
+        // Tries all five filters on the whole row and leaves the cheapest result
+        // in |out|. |scratch| holds |row_bytes| bytes.
+        int FilterRowFull(const unsigned char* row, const unsigned char* prev,
+            int bpp, int row_bytes, unsigned char* scratch, unsigned char* out)
+        {
+            int best_filter = PNG_FILTER_VALUE_NONE;
+            unsigned int best_cost = FilteredRowCost(row, row_bytes, UINT_MAX);
+            memcpy(out, row, row_bytes);
+            for(int filter=PNG_FILTER_VALUE_SUB; filter<PNG_FILTER_VALUE_LAST;
+                ++filter)
+            {
+                FilterRow(filter, row, prev, bpp, row_bytes, scratch);
+                unsigned int cost = FilteredRowCost(scratch, row_bytes,
+                    best_cost);
+                if(cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_filter = filter;
+                    memcpy(out, scratch, row_bytes);
+                }
+            }
+            return best_filter;
+        }
+
+        // Estimates None, Sub and Up from a sample of the pixels in the row.
+        int ChooseFilterSampled(const unsigned char* row,
+            const unsigned char* prev, int bpp, int row_bytes)
+        {
+            unsigned int cost[3] = { 0, 0, 0 };
+            const int step = kSpeedSampleStep * bpp;
+            for(int x=0; x<row_bytes; x+=step)
+            {
+                for(int i=x; i<x+bpp; ++i)
+                {
+                    int left = i>=bpp ? row[i-bpp] : 0;
+                    cost[0] += abs(static_cast<signed char>(row[i]));
+                    cost[1] += abs(static_cast<signed char>(row[i]-left));
+                    cost[2] += abs(static_cast<signed char>(row[i]-prev[i]));
+                }
+            }
+
+            int best_filter = PNG_FILTER_VALUE_NONE;
+            if(cost[1] < cost[best_filter])
+            {
+                best_filter = PNG_FILTER_VALUE_SUB;
+            }
+            if(cost[2] < cost[best_filter])
+            {
+                best_filter = PNG_FILTER_VALUE_UP;
+            }
+            return best_filter;
+        }
+
+        // Shared state of one strip encode. Jobs pull strip indices from
+        // |next_index| and run |step| on them; the last job to finish signals
+        // |done|.
+        struct PngStripBatch
+        {
+            PngStripBatch(const unsigned char* in, int w, int h, int stride,
+                int components, FormatConverter conv, int level, bool sampled)
+                : input(in), width(w), height(h), row_byte_width(stride),
+                output_color_components(components), converter(conv),
+                compression_level(level), sampled_filters(sampled),
+                step(NULL), next_index(0), pending_jobs(0), failed(0),
+                done(true, false)
+            {
+                row_bytes = width * output_color_components;
+                rows_per_strip = std::max(1,
+                    static_cast<int>(kStripSize / (row_bytes+1)));
+                strip_count = (height + rows_per_strip - 1) / rows_per_strip;
+                filtered.resize(static_cast<size_t>(height) * (row_bytes+1));
+                compressed.resize(strip_count);
+                adlers.resize(strip_count);
+            }
+
+            // Byte range of |strip| in |filtered|.
+            size_t StripBegin(int strip) const
+            {
+                return static_cast<size_t>(strip) * rows_per_strip * (row_bytes+1);
+            }
+            size_t StripEnd(int strip) const
+            {
+                return std::min(StripBegin(strip+1), filtered.size());
+            }
+
+            const unsigned char* input;
+            int width;
+            int height;
+            int row_byte_width;
+            int output_color_components;
+            FormatConverter converter;
+            int compression_level;
+            bool sampled_filters;
+
+            int row_bytes;
+            int rows_per_strip;
+            int strip_count;
+
+            // Filtered rows, each prefixed with its filter type byte.
+            std::vector<unsigned char> filtered;
+            // Raw deflate data and Adler-32 of each strip.
+            std::vector<std::vector<unsigned char> > compressed;
+            std::vector<uLong> adlers;
+
+            void (*step)(PngStripBatch* batch, int strip);
+            volatile base::subtle::Atomic32 next_index;
+            volatile base::subtle::Atomic32 pending_jobs;
+            volatile base::subtle::Atomic32 failed;
+            base::WaitableEvent done;
+        };
+
+        // Returns row |y| in the output format, converting it into |buffer| if
+        // needed.
+        const unsigned char* GetOutputRow(const PngStripBatch* batch, int y,
+            unsigned char* buffer)
+        {
+            const unsigned char* row = &batch->input[y*batch->row_byte_width];
+            if(!batch->converter)
+            {
+                return row;
+            }
+            batch->converter(row, batch->width, buffer, NULL);
+            return buffer;
+        }
+
+        void FilterStrip(PngStripBatch* batch, int strip)
+        {
+            const int bpp = batch->output_color_components;
+            const int row_bytes = batch->row_bytes;
+            const int first_row = strip * batch->rows_per_strip;
+            const int last_row = std::min(first_row+batch->rows_per_strip,
+                batch->height);
+
+            // Two converted rows (current and previous), a row of zeros that
+            // the first row of the image is filtered against, and filter scratch.
+            std::vector<unsigned char> buffer(4*row_bytes, 0);
+            unsigned char* rows[2] = { &buffer[0], &buffer[row_bytes] };
+            const unsigned char* zero_row = &buffer[2*row_bytes];
+            unsigned char* scratch = &buffer[3*row_bytes];
+
+            const unsigned char* prev = zero_row;
+            if(first_row > 0)
+            {
+                prev = GetOutputRow(batch, first_row-1, rows[(first_row-1)&1]);
+            }
+
+            unsigned char* out = &batch->filtered[batch->StripBegin(strip)];
+            for(int y=first_row; y<last_row; ++y)
+            {
+                const unsigned char* row = GetOutputRow(batch, y, rows[y&1]);
+                int filter;
+                if(batch->sampled_filters)
+                {
+                    filter = ChooseFilterSampled(row, prev, bpp, row_bytes);
+                    FilterRow(filter, row, prev, bpp, row_bytes, out+1);
+                }
+                else
+                {
+                    filter = FilterRowFull(row, prev, bpp, row_bytes, scratch,
+                        out+1);
+                }
+                out[0] = static_cast<unsigned char>(filter);
+                out += row_bytes + 1;
+                prev = row;
+            }
+        }
+
+        void DeflateStrip(PngStripBatch* batch, int strip)
+        {
+            const size_t begin = batch->StripBegin(strip);
+            const size_t length = batch->StripEnd(strip) - begin;
+            unsigned char* data = &batch->filtered[begin];
+            batch->adlers[strip] = adler32(adler32(0L, Z_NULL, 0), data,
+                static_cast<uInt>(length));
+
+            z_stream stream;
+            memset(&stream, 0, sizeof(stream));
+            if(deflateInit2(&stream, batch->compression_level, Z_DEFLATED,
+                -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            {
+                base::subtle::NoBarrier_Store(&batch->failed, 1);
+                return;
+            }
+            if(begin > 0)
+            {
+                size_t dictionary = std::min(begin, kDictionarySize);
+                deflateSetDictionary(&stream, data-dictionary,
+                    static_cast<uInt>(dictionary));
+            }
+
+            std::vector<unsigned char>& out = batch->compressed[strip];
+            out.resize(deflateBound(&stream, static_cast<uLong>(length)) + 16);
+            stream.next_in = data;
+            stream.avail_in = static_cast<uInt>(length);
+            stream.next_out = &out[0];
+            stream.avail_out = static_cast<uInt>(out.size());
+
+            const int flush = (strip == batch->strip_count-1) ?
+                Z_FINISH : Z_SYNC_FLUSH;
+            bool success = false;
+            for(;;)
+            {
+                int result = deflate(&stream, flush);
+                if(result==Z_STREAM_END ||
+                    (flush==Z_SYNC_FLUSH && result==Z_OK && stream.avail_out!=0))
+                {
+                    success = true;
+                    break;
+                }
+                if(result!=Z_OK && result!=Z_BUF_ERROR)
+                {
+                    break;
+                }
+                // Out of space, which deflateBound() should prevent.
+                size_t used = stream.total_out;
+                out.resize(out.size() * 2);
+                stream.next_out = &out[used];
+                stream.avail_out = static_cast<uInt>(out.size() - used);
+            }
+            out.resize(stream.total_out);
+            deflateEnd(&stream);
+            if(!success)
+            {
+                base::subtle::NoBarrier_Store(&batch->failed, 1);
+            }
+        }
+
+        void RunPngStripJob(PngStripBatch* batch)
+        {
+            for(;;)
+            {
+                int index = base::subtle::NoBarrier_AtomicIncrement(
+                    &batch->next_index, 1) - 1;
+                if(index >= batch->strip_count)
+                {
+                    break;
+                }
+                batch->step(batch, index);
+            }
+
+            if(base::subtle::Barrier_AtomicIncrement(&batch->pending_jobs, -1) == 0)
+            {
+                batch->done.Signal();
+            }
+        }
+
+        // Runs |step| on every strip of |batch| and waits for all of them.
+        void RunPngStripStep(PngStripBatch* batch,
+            void (*step)(PngStripBatch*, int))
+        {
+            int jobs = std::min(base::SysInfo::NumberOfProcessors(),
+                batch->strip_count);
+            jobs = std::max(jobs, 1);
+            batch->step = step;
+            batch->next_index = 0;
+            batch->pending_jobs = jobs;
+            batch->done.Reset();
+
+            // The calling thread runs one of the jobs itself. If a job can't be
+            // posted, run it here as well so |pending_jobs| still reaches zero.
+            for(int i=1; i<jobs; ++i)
+            {
+                if(!base::WorkerPool::PostTask(
+                    base::Bind(&RunPngStripJob, batch), false))
+                {
+                    RunPngStripJob(batch);
+                }
+            }
+            RunPngStripJob(batch);
+
+            batch->done.Wait();
+        }
+
+        // Filters and deflates the image in parallel strips. On success the
+        // zlib stream for the IDAT chunks is left in |idat|, one piece per strip.
+        bool EncodeStrips(PngStripBatch* batch,
+            std::vector<std::vector<unsigned char> >* idat)
+        {
+            // Filtering a strip needs the unfiltered row above it, which every
+            // job can convert on its own, but deflating needs the filtered data
+            // in front of the strip as dictionary. Hence two passes.
+            RunPngStripStep(batch, &FilterStrip);
+            RunPngStripStep(batch, &DeflateStrip);
+            if(base::subtle::Acquire_Load(&batch->failed))
+            {
+                return false;
+            }
+
+            // zlib header, using the same FLEVEL bits as deflate() would.
+            int level = batch->compression_level;
+            if(level == Z_DEFAULT_COMPRESSION)
+            {
+                level = 6;
+            }
+            int level_flags = (level < 2) ? 0 : (level < 6 ? 1 : (level == 6 ? 2 : 3));
+            unsigned int header = (0x78 << 8) | (level_flags << 6);
+            header += 31 - (header % 31);
+
+            uLong adler = batch->adlers[0];
+            for(int i=1; i<batch->strip_count; ++i)
+            {
+                size_t length = batch->StripEnd(i) - batch->StripBegin(i);
+                adler = adler32_combine(adler, batch->adlers[i],
+                    static_cast<z_off_t>(length));
+            }
+
+            idat->swap(batch->compressed);
+            std::vector<unsigned char>& first = idat->front();
+            unsigned char zlib_header[2] = {
+                static_cast<unsigned char>(header >> 8),
+                static_cast<unsigned char>(header & 0xFF) };
+            first.insert(first.begin(), zlib_header, zlib_header+2);
+            std::vector<unsigned char>& last = idat->back();
+            for(int shift=24; shift>=0; shift-=8)
+            {
+                last.push_back(static_cast<unsigned char>(adler >> shift));
+            }
+            return true;
+        }
+
+        const png_byte kIDATChunkName[5] = { 'I', 'D', 'A', 'T', '\0' };
+        const png_byte kIENDChunkName[5] = { 'I', 'E', 'N', 'D', '\0' };
+
         // libpng uses a wacky setjmp-based API, which makes the compiler nervous.
         // We constrain all of the calls we make to libpng where the setjmp() is in
         // place to this function.
@@ -709,7 +1277,8 @@ namespace gfx
             const unsigned char* input, int compression_level,
             int png_output_color_type, int output_color_components,
             FormatConverter converter,
-            const std::vector<PNGCodec::Comment>& comments)
+            const std::vector<PNGCodec::Comment>& comments,
+            const std::vector<std::vector<unsigned char> >* idat)
         {
             // Make sure to not declare any locals here -- locals in the presence
             // of setjmp() in C++ code makes gcc complain.
@@ -739,7 +1308,21 @@ namespace gfx
 
             png_write_info(png_ptr, info_ptr);
 
-            if(!converter)
+            if(idat)
+            {
+                // Already compressed by EncodeStrips(). The comments went out with
+                // the header, so only IEND is left after the data.
+                for(size_t i=0; i<idat->size(); ++i)
+                {
+                    png_write_chunk(png_ptr, const_cast<png_bytep>(kIDATChunkName),
+                        const_cast<unsigned char*>(&(*idat)[i][0]),
+                        (*idat)[i].size());
+                }
+                png_write_chunk(png_ptr, const_cast<png_bytep>(kIENDChunkName),
+                    NULL, 0);
+                return true;
+            }
+            else if(!converter)
             {
                 // No conversion needed, give the data directly to libpng.
                 for(int y=0; y<height; ++y)
@@ -764,6 +1347,130 @@ namespace gfx
             return true;
         }
 
+        // Shared by the public encoders. |fast_filters| selects the sampled filter
+        // heuristic of PNGCodec::PRESET_SPEED.
+        bool EncodeWithOptions(const unsigned char* input,
+            PNGCodec::ColorFormat format, const Size& size,
+            int row_byte_width,
+            bool discard_transparency,
+            const std::vector<PNGCodec::Comment>& comments,
+            int compression_level,
+            bool fast_filters,
+            std::vector<unsigned char>* output)
+        {
+            // Run to convert an input row into the output row format, NULL means no
+            // conversion is necessary.
+            FormatConverter converter = NULL;
+
+            int input_color_components, output_color_components;
+            int png_output_color_type;
+            switch(format)
+            {
+            case PNGCodec::FORMAT_RGB:
+                input_color_components = 3;
+                output_color_components = 3;
+                png_output_color_type = PNG_COLOR_TYPE_RGB;
+                discard_transparency = false;
+                break;
+
+            case PNGCodec::FORMAT_RGBA:
+                input_color_components = 4;
+                if(discard_transparency)
+                {
+                    output_color_components = 3;
+                    png_output_color_type = PNG_COLOR_TYPE_RGB;
+                    converter = ConvertRGBAtoRGB;
+                }
+                else
+                {
+                    output_color_components = 4;
+                    png_output_color_type = PNG_COLOR_TYPE_RGB_ALPHA;
+                    converter = NULL;
+                }
+                break;
+
+            case PNGCodec::FORMAT_BGRA:
+                input_color_components = 4;
+                if(discard_transparency)
+                {
+                    output_color_components = 3;
+                    png_output_color_type = PNG_COLOR_TYPE_RGB;
+                    converter = ConvertBGRAtoRGB;
+                }
+                else
+                {
+                    output_color_components = 4;
+                    png_output_color_type = PNG_COLOR_TYPE_RGB_ALPHA;
+                    converter = ConvertBetweenBGRAandRGBA;
+                }
+                break;
+
+            case PNGCodec::FORMAT_SkBitmap:
+                input_color_components = 4;
+                if(discard_transparency)
+                {
+                    output_color_components = 3;
+                    png_output_color_type = PNG_COLOR_TYPE_RGB;
+                    converter = ConvertSkiatoRGB;
+                }
+                else
+                {
+                    output_color_components = 4;
+                    png_output_color_type = PNG_COLOR_TYPE_RGB_ALPHA;
+                    converter = ConvertSkiatoRGBA;
+                }
+                break;
+
+            default:
+                NOTREACHED() << "Unknown pixel format";
+                return false;
+            }
+
+            // Row stride should be at least as long as the length of the data.
+            DCHECK(input_color_components*size.width() <= row_byte_width);
+
+            png_struct* png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING,
+                NULL, NULL, NULL);
+            if(!png_ptr)
+            {
+                return false;
+            }
+            png_info* info_ptr = png_create_info_struct(png_ptr);
+            if(!info_ptr)
+            {
+                png_destroy_write_struct(&png_ptr, NULL);
+                return false;
+            }
+
+            // Large images, and everything encoded with the fast filters, are
+            // compressed up front in parallel strips.
+            std::vector<std::vector<unsigned char> > idat;
+            size_t filtered_size = static_cast<size_t>(size.height()) *
+                (size.width()*output_color_components+1);
+            if(size.width()>0 && size.height()>0 &&
+                (fast_filters || filtered_size>=kMinStripEncodeSize))
+            {
+                PngStripBatch batch(input, size.width(), size.height(),
+                    row_byte_width, output_color_components, converter,
+                    compression_level, fast_filters);
+                if(!EncodeStrips(&batch, &idat))
+                {
+                    png_destroy_write_struct(&png_ptr, &info_ptr);
+                    return false;
+                }
+            }
+
+            PngEncoderState state(output);
+            bool success = DoLibpngWrite(png_ptr, info_ptr, &state,
+                size.width(), size.height(), row_byte_width,
+                input, compression_level, png_output_color_type,
+                output_color_components, converter, comments,
+                idat.empty() ? NULL : &idat);
+            png_destroy_write_struct(&png_ptr, &info_ptr);
+
+            return success;
+        }
+
     }
 
     // static
@@ -790,98 +1497,27 @@ namespace gfx
         int compression_level,
         std::vector<unsigned char>* output)
     {
-        // Run to convert an input row into the output row format, NULL means no
-        // conversion is necessary.
-        FormatConverter converter = NULL;
-
-        int input_color_components, output_color_components;
-        int png_output_color_type;
-        switch(format)
-        {
-        case FORMAT_RGB:
-            input_color_components = 3;
-            output_color_components = 3;
-            png_output_color_type = PNG_COLOR_TYPE_RGB;
-            discard_transparency = false;
-            break;
-
-        case FORMAT_RGBA:
-            input_color_components = 4;
-            if(discard_transparency)
-            {
-                output_color_components = 3;
-                png_output_color_type = PNG_COLOR_TYPE_RGB;
-                converter = ConvertRGBAtoRGB;
-            }
-            else
-            {
-                output_color_components = 4;
-                png_output_color_type = PNG_COLOR_TYPE_RGB_ALPHA;
-                converter = NULL;
-            }
-            break;
-
-        case FORMAT_BGRA:
-            input_color_components = 4;
-            if(discard_transparency)
-            {
-                output_color_components = 3;
-                png_output_color_type = PNG_COLOR_TYPE_RGB;
-                converter = ConvertBGRAtoRGB;
-            }
-            else
-            {
-                output_color_components = 4;
-                png_output_color_type = PNG_COLOR_TYPE_RGB_ALPHA;
-                converter = ConvertBetweenBGRAandRGBA;
-            }
-            break;
-
-        case FORMAT_SkBitmap:
-            input_color_components = 4;
-            if(discard_transparency)
-            {
-                output_color_components = 3;
-                png_output_color_type = PNG_COLOR_TYPE_RGB;
-                converter = ConvertSkiatoRGB;
-            }
-            else
-            {
-                output_color_components = 4;
-                png_output_color_type = PNG_COLOR_TYPE_RGB_ALPHA;
-                converter = ConvertSkiatoRGBA;
-            }
-            break;
-
-        default:
-            NOTREACHED() << "Unknown pixel format";
-            return false;
-        }
-
-        // Row stride should be at least as long as the length of the data.
-        DCHECK(input_color_components*size.width() <= row_byte_width);
+        return EncodeWithOptions(input, format, size, row_byte_width,
+            discard_transparency, comments, compression_level, false, output);
+    }
 
-        png_struct* png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING,
-            NULL, NULL, NULL);
-        if(!png_ptr)
-        {
-            return false;
-        }
-        png_info* info_ptr = png_create_info_struct(png_ptr);
-        if(!info_ptr)
+    // static
+    bool PNGCodec::EncodeWithPreset(const unsigned char* input,
+        ColorFormat format, const Size& size,
+        int row_byte_width,
+        bool discard_transparency,
+        const std::vector<Comment>& comments,
+        EncodePreset preset,
+        std::vector<unsigned char>* output)
+    {
+        if(preset == PRESET_SPEED)
         {
-            png_destroy_write_struct(&png_ptr, NULL);
-            return false;
+            return EncodeWithOptions(input, format, size, row_byte_width,
+                discard_transparency, comments, kSpeedCompressionLevel, true,
+                output);
         }
-
-        PngEncoderState state(output);
-        bool success = DoLibpngWrite(png_ptr, info_ptr, &state,
-            size.width(), size.height(), row_byte_width,
-            input, compression_level, png_output_color_type,
-            output_color_components, converter, comments);
-        png_destroy_write_struct(&png_ptr, &info_ptr);
-
-        return success;
+        return EncodeWithCompressionLevel(input, format, size, row_byte_width,
+            discard_transparency, comments, Z_DEFAULT_COMPRESSION, output);
     }
 
     // static
@@ -1,9 +1,19 @@
 
 #include "color_analysis.h"
 
+#include <emmintrin.h>
+
 #include <algorithm>
 #include <vector>
 
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/cpu.h"
+#include "base/logging.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/sys_info.h"
+#include "base/threading/worker_pool.h"
+
 #include "ui_gfx/codec/png_codec.h"
 
 namespace
@@ -15,6 +25,11 @@ namespace
     const uint32_t kMaxBrightness = 600;
     const uint32_t kMinDarkness = 100;
 
+    // The decoded image is decimated to at most this many pixels before
+    // clustering. The dominant color of a 128x128 sample is indistinguishable
+    // from that of the full image, and large images are never fully expanded.
+    const int kMaxSampledPixels = 128 * 128;
+
     // Background Color Modification Constants
     const SkColor kDefaultBgColor = SK_ColorWHITE;
 
@@ -115,6 +130,10 @@ namespace
             return weight;
         }
 
+        inline int GetCentroidR() const { return centroid[0]; }
+        inline int GetCentroidG() const { return centroid[1]; }
+        inline int GetCentroidB() const { return centroid[2]; }
+
         static bool SortKMeanClusterByWeight(const KMeanCluster& a,
             const KMeanCluster& b)
         {
@@ -134,6 +153,168 @@ namespace
         uint32_t weight;
     };
 
+    // Adds the pixel at |pixel| (BGRA) to the cluster whose centroid is closest
+    // in RGB space. Ties go to the cluster that comes first.
+    inline void AddPixelToClosestCluster(const uint8_t* pixel,
+        std::vector<KMeanCluster>& clusters)
+    {
+        uint8_t b = pixel[0];
+        uint8_t g = pixel[1];
+        uint8_t r = pixel[2];
+
+        uint32_t distance_sqr_to_closest_cluster = UINT_MAX;
+        std::vector<KMeanCluster>::iterator closest_cluster = clusters.begin();
+
+        // Figure out which cluster this color is closest to in RGB space.
+        for(std::vector<KMeanCluster>::iterator cluster=clusters.begin();
+            cluster!=clusters.end(); ++cluster)
+        {
+            uint32_t distance_sqr = cluster->GetDistanceSqr(r, g, b);
+
+            if(distance_sqr < distance_sqr_to_closest_cluster)
+            {
+                distance_sqr_to_closest_cluster = distance_sqr;
+                closest_cluster = cluster;
+            }
+        }
+
+        closest_cluster->AddPoint(r, g, b);
+    }
+
+    // Scalar assignment step: places each of the |pixel_count| BGRA pixels in
+    // the closest cluster.
+    void AssignPixelsToClusters(const uint8_t* pixels, int pixel_count,
+        std::vector<KMeanCluster>& clusters)
+    {
+        for(int i=0; i<pixel_count; ++i)
+        {
+            AddPixelToClosestCluster(pixels + i * 4, clusters);
+        }
+    }
+
+    // base::CPU runs cpuid each time it's constructed, so the answer is kept.
+    // Racing first calls from the batch workers compute the same value.
+    bool CPUHasSSE2()
+    {
+        static const bool has_sse2 = base::CPU().has_sse2() != 0;
+        return has_sse2;
+    }
+
+    // SSE2 assignment step. Four pixels are handled per iteration: the squared
+    // distances from all four pixels to one centroid are computed at once with
+    // 16-bit multiply-adds, and the running minimum and its cluster index are
+    // kept in vector registers. Only the final accumulation into the chosen
+    // cluster is scalar. Produces exactly the same assignment as
+    // AssignPixelsToClusters().
+    void AssignPixelsToClustersSSE2(const uint8_t* pixels, int pixel_count,
+        std::vector<KMeanCluster>& clusters)
+    {
+        DCHECK(clusters.size() <= kNumberOfClusters);
+
+        // Centroids laid out as two BGR0 pixels of 16-bit lanes, matching the
+        // unpacked pixel data below.
+        __m128i centroids[kNumberOfClusters];
+        const int cluster_count = static_cast<int>(clusters.size());
+        for(int c=0; c<cluster_count; ++c)
+        {
+            const KMeanCluster& cluster = clusters[c];
+            centroids[c] = _mm_setr_epi16(
+                cluster.GetCentroidB(), cluster.GetCentroidG(),
+                cluster.GetCentroidR(), 0,
+                cluster.GetCentroidB(), cluster.GetCentroidG(),
+                cluster.GetCentroidR(), 0);
+        }
+
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+        int indices[4];
+
+        int i = 0;
+        for(; i+4<=pixel_count; i+=4)
+        {
+            __m128i quad = _mm_and_si128(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(pixels + i * 4)), rgb_mask);
+            __m128i lo = _mm_unpacklo_epi8(quad, zero);
+            __m128i hi = _mm_unpackhi_epi8(quad, zero);
+
+            __m128i best_distance = _mm_set1_epi32(INT_MAX);
+            __m128i best_index = zero;
+            for(int c=0; c<cluster_count; ++c)
+            {
+                __m128i diff_lo = _mm_sub_epi16(lo, centroids[c]);
+                __m128i diff_hi = _mm_sub_epi16(hi, centroids[c]);
+                // Each pixel yields two 32-bit lanes: b*b+g*g and r*r.
+                diff_lo = _mm_madd_epi16(diff_lo, diff_lo);
+                diff_hi = _mm_madd_epi16(diff_hi, diff_hi);
+                diff_lo = _mm_add_epi32(diff_lo, _mm_srli_epi64(diff_lo, 32));
+                diff_hi = _mm_add_epi32(diff_hi, _mm_srli_epi64(diff_hi, 32));
+                __m128i distance = _mm_castps_si128(_mm_shuffle_ps(
+                    _mm_castsi128_ps(diff_lo), _mm_castsi128_ps(diff_hi),
+                    _MM_SHUFFLE(2, 0, 2, 0)));
+
+                __m128i closer = _mm_cmplt_epi32(distance, best_distance);
+                best_distance = _mm_or_si128(_mm_and_si128(closer, distance),
+                    _mm_andnot_si128(closer, best_distance));
+                best_index = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(c)),
+                    _mm_andnot_si128(closer, best_index));
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), best_index);
+            for(int k=0; k<4; ++k)
+            {
+                const uint8_t* pixel = pixels + (i + k) * 4;
+                clusters[indices[k]].AddPoint(pixel[2], pixel[1], pixel[0]);
+            }
+        }
+
+        AssignPixelsToClusters(pixels + i * 4, pixel_count - i, clusters);
+    }
+
+    // Shared state of one CalculateKMeanColorsOfPNGs() call. Jobs pull image
+    // indices from |next_index| until all images are taken; the last job to
+    // finish signals |done|.
+    struct KMeanBatch
+    {
+        KMeanBatch(const std::vector<scoped_refptr<RefCountedMemory> >& p,
+            uint32_t darkness, uint32_t brightness, std::vector<SkColor>* c,
+            int jobs)
+            : pngs(p), darkness_limit(darkness), brightness_limit(brightness),
+            colors(c), next_index(0), pending_jobs(jobs), done(true, false) {}
+
+        const std::vector<scoped_refptr<RefCountedMemory> >& pngs;
+        uint32_t darkness_limit;
+        uint32_t brightness_limit;
+        std::vector<SkColor>* colors;
+        volatile base::subtle::Atomic32 next_index;
+        volatile base::subtle::Atomic32 pending_jobs;
+        base::WaitableEvent done;
+    };
+
+    void RunKMeanBatchJob(KMeanBatch* batch)
+    {
+        // Each job owns its sampler; RandomSampler uses the CRT's per-thread
+        // rand() state.
+        gfx::RandomSampler sampler;
+        const int count = static_cast<int>(batch->pngs.size());
+        for(;;)
+        {
+            int index = base::subtle::NoBarrier_AtomicIncrement(
+                &batch->next_index, 1) - 1;
+            if(index >= count)
+            {
+                break;
+            }
+            (*batch->colors)[index] = gfx::CalculateKMeanColorOfPNG(
+                batch->pngs[index], batch->darkness_limit,
+                batch->brightness_limit, sampler);
+        }
+
+        if(base::subtle::Barrier_AtomicIncrement(&batch->pending_jobs, -1) == 0)
+        {
+            batch->done.Signal();
+        }
+    }
+
 }
 
 namespace gfx
@@ -201,12 +382,13 @@ namespace gfx
         SkColor color = kDefaultBgColor;
 
         if(png.get() && png->size() &&
-            gfx::PNGCodec::Decode(png->front(),
+            gfx::PNGCodec::DecodeSubsampled(png->front(),
             png->size(),
             gfx::PNGCodec::FORMAT_BGRA,
+            kMaxSampledPixels,
             &decoded_data,
             &img_width,
-            &img_height))
+            &img_height) && !decoded_data.empty())
         {
             std::vector<KMeanCluster> clusters;
             clusters.resize(kNumberOfClusters, KMeanCluster());
@@ -264,6 +446,9 @@ namespace gfx
                 }
             }
 
+            const int pixel_count = static_cast<int>(decoded_data.size() / 4);
+            const bool use_sse2 = CPUHasSSE2();
+
             bool convergence = false;
             for(int iteration=0;
                 iteration<kNumberOfIterations && !convergence && !clusters.empty();
@@ -271,43 +456,14 @@ namespace gfx
             {
 
                 // Loop through each pixel so we can place it in the appropriate cluster.
-                std::vector<uint8_t>::iterator pixel = decoded_data.begin();
-                while(pixel != decoded_data.end())
+                if(use_sse2)
                 {
-                    uint8_t b = *(pixel++);
-                    if(pixel == decoded_data.end())
-                    {
-                        continue;
-                    }
-                    uint8_t g = *(pixel++);
-                    if(pixel == decoded_data.end())
-                    {
-                        continue;
-                    }
-                    uint8_t r = *(pixel++);
-                    if(pixel == decoded_data.end())
-                    {
-                        continue;
-                    }
-                    ++pixel; // Ignore the alpha channel.
-
-                    uint32_t distance_sqr_to_closest_cluster = UINT_MAX;
-                    std::vector<KMeanCluster>::iterator closest_cluster = clusters.begin();
-
-                    // Figure out which cluster this color is closest to in RGB space.
-                    for(std::vector<KMeanCluster>::iterator cluster=clusters.begin();
-                        cluster!=clusters.end(); ++cluster)
-                    {
-                        uint32_t distance_sqr = cluster->GetDistanceSqr(r, g, b);
-
-                        if(distance_sqr < distance_sqr_to_closest_cluster)
-                        {
-                            distance_sqr_to_closest_cluster = distance_sqr;
-                            closest_cluster = cluster;
-                        }
-                    }
-
-                    closest_cluster->AddPoint(r, g, b);
+                    AssignPixelsToClustersSSE2(&decoded_data[0], pixel_count,
+                        clusters);
+                }
+                else
+                {
+                    AssignPixelsToClusters(&decoded_data[0], pixel_count, clusters);
                 }
 
                 // Calculate the new cluster centers and see if we've converged or not.
@@ -358,4 +514,37 @@ namespace gfx
         return color;
     }
 
+    void CalculateKMeanColorsOfPNGs(
+        const std::vector<scoped_refptr<RefCountedMemory> >& pngs,
+        uint32_t darkness_limit,
+        uint32_t brightness_limit,
+        std::vector<SkColor>* colors)
+    {
+        DCHECK(colors);
+        colors->assign(pngs.size(), kDefaultBgColor);
+        if(pngs.empty())
+        {
+            return;
+        }
+
+        int jobs = std::min(base::SysInfo::NumberOfProcessors(),
+            static_cast<int>(pngs.size()));
+        jobs = std::max(jobs, 1);
+        KMeanBatch batch(pngs, darkness_limit, brightness_limit, colors, jobs);
+
+        // The calling thread runs one of the jobs itself. If a job can't be
+        // posted, run it here as well so |pending_jobs| still reaches zero.
+        for(int i=1; i<jobs; ++i)
+        {
+            if(!base::WorkerPool::PostTask(
+                base::Bind(&RunKMeanBatchJob, &batch), false))
+            {
+                RunKMeanBatchJob(&batch);
+            }
+        }
+        RunKMeanBatchJob(&batch);
+
+        batch.done.Wait();
+    }
+
 } //namespace gfx
\ No newline at end of file
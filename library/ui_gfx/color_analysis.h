@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "base/memory/ref_counted.h"
 #include "base/memory/ref_counted_memory.h"
 
@@ -64,7 +66,8 @@ namespace gfx
 
     // Returns an SkColor that represents the calculated dominant color in the png.
     // This uses a KMean clustering algorithm to find clusters of pixel colors in
-    // RGB space.
+    // RGB space. Images with more than 128*128 pixels are decimated while
+    // decoding, so only a bounded sample of pixels is ever expanded and clustered.
     // |png| represents the data of a png encoded image.
     // |darkness_limit| represents the minimum sum of the RGB components that is
     // acceptable as a color choice. This can be from 0 to 765.
@@ -108,6 +111,17 @@ namespace gfx
         uint32_t brightness_limit,
         KMeanImageSampler& sampler);
 
+    // Runs CalculateKMeanColorOfPNG on each image in |pngs| and stores the
+    // results in |colors| (same order, resized to match). The images are spread
+    // across worker threads, one per processor; the calling thread takes part
+    // and the function returns when all images are done. Each worker uses its
+    // own RandomSampler.
+    void CalculateKMeanColorsOfPNGs(
+        const std::vector<scoped_refptr<RefCountedMemory> >& pngs,
+        uint32_t darkness_limit,
+        uint32_t brightness_limit,
+        std::vector<SkColor>* colors);
+
 } //namespace gfx
 
 #endif //__ui_gfx_color_analysis_h__
\ No newline at end of file
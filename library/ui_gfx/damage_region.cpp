@@ -0,0 +1,150 @@
+#include "damage_region.h"
+
+#include "base/logging.h"
+
+#include "rect.h"
+
+namespace gfx
+{
+
+    namespace
+    {
+
+        int64 RectArea(const SkIRect& rect)
+        {
+            return static_cast<int64>(rect.width()) * rect.height();
+        }
+
+        int64 RegionArea(const SkRegion& region)
+        {
+            int64 area = 0;
+            for(SkRegion::Iterator iter(region); !iter.done(); iter.next())
+            {
+                area += RectArea(iter.rect());
+            }
+            return area;
+        }
+
+    }
+
+    DamageRegion::DamageRegion() : max_rects_(kDefaultMaxRects) {}
+
+    DamageRegion::DamageRegion(int max_rects) : max_rects_(max_rects)
+    {
+        DCHECK_GT(max_rects, 0);
+    }
+
+    DamageRegion::~DamageRegion() {}
+
+    void DamageRegion::Add(const Rect& rect)
+    {
+        if(rect.IsEmpty())
+        {
+            return;
+        }
+
+        SkIRect sk_rect;
+        sk_rect.set(rect.x(), rect.y(), rect.right(), rect.bottom());
+        if(region_.contains(sk_rect))
+        {
+            return;
+        }
+
+        // Drop the old rects the new one covers.
+        for(size_t i=rects_.size(); i>0; --i)
+        {
+            if(sk_rect.contains(rects_[i-1]))
+            {
+                rects_.erase(rects_.begin() + (i - 1));
+            }
+        }
+        rects_.push_back(sk_rect);
+
+        region_.op(sk_rect, SkRegion::kUnion_Op);
+        EnforceRectLimit();
+    }
+
+    void DamageRegion::Clear()
+    {
+        rects_.clear();
+        region_.setEmpty();
+    }
+
+    bool DamageRegion::Intersects(const Rect& rect) const
+    {
+        if(rect.IsEmpty())
+        {
+            return false;
+        }
+
+        SkIRect sk_rect;
+        sk_rect.set(rect.x(), rect.y(), rect.right(), rect.bottom());
+        return region_.intersects(sk_rect);
+    }
+
+    Rect DamageRegion::GetBounds() const
+    {
+        const SkIRect& bounds = region_.getBounds();
+        return Rect(bounds.fLeft, bounds.fTop, bounds.width(), bounds.height());
+    }
+
+    void DamageRegion::GetRects(std::vector<Rect>* rects) const
+    {
+        DCHECK(rects);
+        rects->clear();
+        for(SkRegion::Iterator iter(region_); !iter.done(); iter.next())
+        {
+            const SkIRect& r = iter.rect();
+            rects->push_back(Rect(r.fLeft, r.fTop, r.width(), r.height()));
+        }
+    }
+
+    int64 DamageRegion::GetArea() const
+    {
+        return RegionArea(region_);
+    }
+
+    void DamageRegion::EnforceRectLimit()
+    {
+        if(static_cast<int>(rects_.size()) <= max_rects_)
+        {
+            return;
+        }
+
+        // Greedy merge: each step merges the pair whose bounding box adds the
+        // least area. The rect limit is small, so the O(n^3) cost is acceptable.
+        while(static_cast<int>(rects_.size()) > max_rects_)
+        {
+            size_t best_i = 0, best_j = 1;
+            int64 best_waste = 0;
+            bool found = false;
+            for(size_t i=0; i<rects_.size(); ++i)
+            {
+                for(size_t j=i+1; j<rects_.size(); ++j)
+                {
+                    SkIRect merged = rects_[i];
+                    merged.join(rects_[j]);
+                    int64 waste = RectArea(merged) -
+                        RectArea(rects_[i]) - RectArea(rects_[j]);
+                    if(!found || waste<best_waste)
+                    {
+                        found = true;
+                        best_waste = waste;
+                        best_i = i;
+                        best_j = j;
+                    }
+                }
+            }
+
+            rects_[best_i].join(rects_[best_j]);
+            rects_.erase(rects_.begin() + best_j);
+        }
+
+        region_.setEmpty();
+        for(size_t i=0; i<rects_.size(); ++i)
+        {
+            region_.op(rects_[i], SkRegion::kUnion_Op);
+        }
+    }
+
+} //namespace gfx
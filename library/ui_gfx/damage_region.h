@@ -0,0 +1,75 @@
+
+#ifndef __ui_gfx_damage_region_h__
+#define __ui_gfx_damage_region_h__
+
+#pragma once
+
+#include <vector>
+
+#include "base/basic_types.h"
+
+#include "SkRegion.h"
+
+namespace gfx
+{
+
+    class Rect;
+
+    // Records every area of a frame that needs repainting (the damage). Unlike
+    // merging all rects into one bounding box, two small rects in opposite
+    // corners of a window repaint only themselves.
+    //
+    // Added rects are kept in a list and their union in an SkRegion, which is
+    // used for queries and clipping. To bound the cost of clipping while painting
+    // the list has a maximum size: when it is exceeded, the two rects whose
+    // merge wastes the least area are merged until the list fits again. The
+    // repainted area grows a little, but never degrades to the bounding box.
+    class DamageRegion
+    {
+    public:
+        // Default maximum number of rects.
+        static const int kDefaultMaxRects = 8;
+
+        DamageRegion();
+        explicit DamageRegion(int max_rects);
+        ~DamageRegion();
+
+        // Adds a damaged rect. Empty rects are ignored.
+        void Add(const Rect& rect);
+
+        // Empties the region, typically once painting is done.
+        void Clear();
+
+        bool IsEmpty() const { return region_.isEmpty(); }
+
+        // Returns true if |rect| intersects the region.
+        bool Intersects(const Rect& rect) const;
+
+        // Returns the bounding box of the region.
+        Rect GetBounds() const;
+
+        // Returns the disjoint rects that make up the region.
+        void GetRects(std::vector<Rect>* rects) const;
+
+        // Returns the number of pixels the region covers.
+        int64 GetArea() const;
+
+        const SkRegion& region() const { return region_; }
+        int max_rects() const { return max_rects_; }
+
+    private:
+        // Merges rects while there are more than |max_rects_|, then rebuilds
+        // |region_|.
+        void EnforceRectLimit();
+
+        // The added rects, possibly overlapping. At most |max_rects_| of them.
+        std::vector<SkIRect> rects_;
+
+        // The union of |rects_|.
+        SkRegion region_;
+        int max_rects_;
+    };
+
+} //namespace gfx
+
+#endif //__ui_gfx_damage_region_h__
@@ -57,6 +57,12 @@ namespace gfx
         return platform_font_->GetStringWidth(text);
     }
 
+    bool Font::GetCharacterWidths(const string16& text,
+        std::vector<int>* widths) const
+    {
+        return platform_font_->GetCharacterWidths(text, widths);
+    }
+
     int Font::GetExpectedTextWidth(int length) const
     {
         return platform_font_->GetExpectedTextWidth(length);
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "base/memory/ref_counted.h"
 #include "base/string16.h"
 
@@ -64,6 +66,13 @@ namespace gfx
         // ʾıˮƽ.
         int GetStringWidth(const string16& text) const;
 
+        // |text|ÿUTF-16Ԫǰ, ԵĿȼ׵Ԫ. 
+        // 建, ۼӼõǰ׺Ŀ(־α任). 
+        // ȱĳַʱfalse, ƽ̨úЩַ, 
+        // |widths|Ĳͬ.
+        bool GetCharacterWidths(const string16& text,
+            std::vector<int>* widths) const;
+
         // ʾַָˮƽ. GetStringWidth()ȡʵĿ.
         int GetExpectedTextWidth(int length) const;
 
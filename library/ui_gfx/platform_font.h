@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "base/memory/ref_counted.h"
 #include "base/string16.h"
 
@@ -46,6 +48,15 @@ namespace gfx
         // string.
         virtual int GetStringWidth(const string16& text) const = 0;
 
+        // Fills |widths| with the advance of each UTF-16 unit of |text|. A
+        // surrogate pair's advance is given to its lead unit. Summing the
+        // advances gives prefix widths without kerning or shaping, which
+        // GetStringWidth() takes into account. Returns false if the font itself
+        // lacks a glyph for some character; the platform draws those with a
+        // fallback font, whose advances aren't the ones in |widths|.
+        virtual bool GetCharacterWidths(const string16& text,
+            std::vector<int>* widths) const = 0;
+
         // Returns the expected number of horizontal pixels needed to display the
         // specified length of characters. Call GetStringWidth() to retrieve the
         // actual number.
@@ -10,6 +10,8 @@
 #include "base/string_util.h"
 #include "base/win/win_util.h"
 
+#include "third_party/icu_base/icu_utf.h"
+
 #include "canvas_skia.h"
 #include "font.h"
 
@@ -123,6 +125,31 @@ namespace gfx
         return width;
     }
 
+    bool PlatformFontWin::GetCharacterWidths(const string16& text,
+        std::vector<int>* widths) const
+    {
+        bool has_all_glyphs = true;
+        widths->assign(text.length(), 0);
+        for(size_t i=0; i<text.length(); ++i)
+        {
+            if(CBU16_IS_LEAD(text[i]) && i+1<text.length() &&
+                CBU16_IS_TRAIL(text[i+1]))
+            {
+                // Outside the cached pages; rare enough to measure each time.
+                (*widths)[i] = GetStringWidth(text.substr(i, 2));
+                ++i;
+                continue;
+            }
+            bool has_glyph;
+            (*widths)[i] = font_ref_->GetCharacterWidth(text[i], &has_glyph);
+            if(!has_glyph)
+            {
+                has_all_glyphs = false;
+            }
+        }
+        return has_all_glyphs;
+    }
+
     int PlatformFontWin::GetExpectedTextWidth(int length) const
     {
         return length * std::min(font_ref_->dlu_base_x(), GetAverageCharacterWidth());
@@ -277,6 +304,53 @@ namespace gfx
         DeleteObject(hfont_);
     }
 
+    int PlatformFontWin::HFontRef::GetCharacterWidth(char16 c, bool* has_glyph)
+    {
+        if(advance_pages_.empty())
+        {
+            advance_pages_.resize(256);
+            missing_glyph_pages_.resize(256);
+        }
+        std::vector<int>& page = advance_pages_[c >> 8];
+        if(page.empty())
+        {
+            page.resize(256, ave_char_width_);
+            const UINT first = c & 0xFF00;
+            HDC screen_dc = GetDC(NULL);
+            HFONT previous_font = static_cast<HFONT>(SelectObject(screen_dc, hfont_));
+            if(!GetCharWidth32(screen_dc, first, first+255, &page[0]))
+            {
+                // Keep the average width; callers check the final width anyway.
+                page.assign(256, ave_char_width_);
+            }
+            // Latin-1 is always drawn with the font itself.
+            if(first != 0)
+            {
+                WCHAR chars[256];
+                WORD glyphs[256];
+                for(int i=0; i<256; ++i)
+                {
+                    chars[i] = static_cast<WCHAR>(first + i);
+                }
+                std::vector<bool>& missing = missing_glyph_pages_[c >> 8];
+                missing.assign(256, true);
+                if(GetGlyphIndicesW(screen_dc, chars, 256, glyphs,
+                    GGI_MARK_NONEXISTING_GLYPHS) != GDI_ERROR)
+                {
+                    for(int i=0; i<256; ++i)
+                    {
+                        missing[i] = glyphs[i] == 0xFFFF;
+                    }
+                }
+            }
+            SelectObject(screen_dc, previous_font);
+            ReleaseDC(NULL, screen_dc);
+        }
+        const std::vector<bool>& missing = missing_glyph_pages_[c >> 8];
+        *has_glyph = missing.empty() || !missing[c & 0xFF];
+        return page[c & 0xFF];
+    }
+
     ////////////////////////////////////////////////////////////////////////////////
     // PlatformFont, public:
 
@@ -46,6 +46,8 @@ namespace gfx
         virtual int GetBaseline() const;
         virtual int GetAverageCharacterWidth() const;
         virtual int GetStringWidth(const string16& text) const;
+        virtual bool GetCharacterWidths(const string16& text,
+            std::vector<int>* widths) const;
         virtual int GetExpectedTextWidth(int length) const;
         virtual int GetStyle() const;
         virtual string16 GetFontName() const;
@@ -84,6 +86,12 @@ namespace gfx
             int dlu_base_x() const { return dlu_base_x_; }
             const string16& font_name() const { return font_name_; }
 
+            // Returns the advance of |c|, and in |has_glyph| whether the font
+            // itself has a glyph for |c|; GDI draws the others with a linked
+            // font. Both are fetched from GDI a page of 256 characters at a time
+            // and kept for the font's lifetime.
+            int GetCharacterWidth(char16 c, bool* has_glyph);
+
         private:
             friend class  base::RefCounted<HFontRef>;
 
@@ -98,6 +106,11 @@ namespace gfx
             const int dlu_base_x_;
             string16 font_name_;
 
+            // Indexed by the high byte of the character; empty until used.
+            std::vector<std::vector<int> > advance_pages_;
+            // Same indexing; empty for Latin-1, which the font always covers.
+            std::vector<std::vector<bool> > missing_glyph_pages_;
+
             DISALLOW_COPY_AND_ASSIGN(HFontRef);
         };
 
@@ -0,0 +1,425 @@
+#include "text_layout_cache.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/memory/singleton.h"
+
+#include "canvas.h"
+#include "font.h"
+
+namespace gfx
+{
+
+    namespace
+    {
+
+        // ӰŰı־.
+        const int kLayoutFlags = Canvas::MULTI_LINE | Canvas::CHARACTER_BREAK;
+
+        bool IsLineBreak(char16 c)
+        {
+            return c==L'\n' || c==L'\r';
+        }
+
+        // պ, ÿַǰ󶼿.
+        bool IsCJK(char16 c)
+        {
+            return (c>=0x2E80 && c<0xA000) || (c>=0xAC00 && c<0xD7A4) ||
+                (c>=0xF900 && c<0xFB00) || (c>=0xFF00 && c<0xFFF0);
+        }
+
+        // ַ֮;ʾȵַ: Ҫα任, Ҳ˫.
+        bool IsSimpleCharacter(char16 c)
+        {
+            return (c>=0x20 && c<0x7F) || (c>=0xA0 && c<0x0250) ||
+                (c>=0x2010 && c<0x2028) || (c>=0x2030 && c<0x205F) ||
+                IsCJK(c);
+        }
+
+        // text[start, end)ųһл, ׷ӵ|lines|.
+        void BreakParagraph(const string16& text,
+            const std::vector<int>& widths,
+            size_t start, size_t end,
+            int max_width,
+            bool character_break,
+            std::vector<TextLine>* lines)
+        {
+            size_t line_start = start;
+            for(;;)
+            {
+                // һеλ: |break_end|, |break_width|.
+                size_t break_end = 0;
+                int break_width = 0;
+                bool has_break = false;
+
+                size_t end_of_line = end;
+                int line_width = 0;
+                // βոĿ.
+                int visible_width = 0;
+                for(size_t i=line_start; i<end; ++i)
+                {
+                    const char16 c = text[i];
+                    if(c == L' ')
+                    {
+                        if(i > line_start)
+                        {
+                            break_end = i;
+                            break_width = visible_width;
+                            has_break = true;
+                        }
+                        // βĿոԳ.
+                        line_width += widths[i];
+                        continue;
+                    }
+                    if(i>line_start && text[i-1]!=L' ' &&
+                        (IsCJK(c) || IsCJK(text[i-1])))
+                    {
+                        break_end = i;
+                        break_width = visible_width;
+                        has_break = true;
+                    }
+
+                    if(line_width+widths[i] > max_width)
+                    {
+                        if(has_break)
+                        {
+                            end_of_line = break_end;
+                            visible_width = break_width;
+                            break;
+                        }
+                        if(character_break && i>line_start)
+                        {
+                            end_of_line = i;
+                            break;
+                        }
+                        // ʷŲֲ۶, .
+                    }
+                    line_width += widths[i];
+                    visible_width = line_width;
+                }
+
+                TextLine line;
+                line.start = line_start;
+                line.length = end_of_line - line_start;
+                line.width = visible_width;
+                lines->push_back(line);
+
+                // дĿոʾ.
+                line_start = end_of_line;
+                while(line_start<end && text[line_start]==L' ')
+                {
+                    ++line_start;
+                }
+                if(line_start >= end)
+                {
+                    return;
+                }
+            }
+        }
+
+    }
+
+    bool TextLayoutCache::Key::operator<(const Key& other) const
+    {
+        if(width != other.width)
+        {
+            return width < other.width;
+        }
+        if(flags != other.flags)
+        {
+            return flags < other.flags;
+        }
+        if(font_height != other.font_height)
+        {
+            return font_height < other.font_height;
+        }
+        if(font_baseline != other.font_baseline)
+        {
+            return font_baseline < other.font_baseline;
+        }
+        if(font_style != other.font_style)
+        {
+            return font_style < other.font_style;
+        }
+        if(font_average_width != other.font_average_width)
+        {
+            return font_average_width < other.font_average_width;
+        }
+        if(text != other.text)
+        {
+            return text < other.text;
+        }
+        if(font_name != other.font_name)
+        {
+            return font_name < other.font_name;
+        }
+        return measured < other.measured;
+    }
+
+    // static
+    TextLayoutCache* TextLayoutCache::GetInstance()
+    {
+        return Singleton<TextLayoutCache>::get();
+    }
+
+    // static
+    bool TextLayoutCache::CanLayOut(const string16& text, int flags)
+    {
+        const bool multi_line = (flags & Canvas::MULTI_LINE) != 0;
+        const bool prefix = (flags & (Canvas::SHOW_PREFIX|Canvas::HIDE_PREFIX)) != 0;
+        for(size_t i=0; i<text.length(); ++i)
+        {
+            const char16 c = text[i];
+            if(IsLineBreak(c))
+            {
+                // ʱзַͨʾ.
+                if(!multi_line)
+                {
+                    return false;
+                }
+                continue;
+            }
+            if(!IsSimpleCharacter(c) || (prefix && c==L'&'))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // static
+    void TextLayoutCache::LayOut(const string16& text, const Font& font,
+        int flags, int width, TextLayout* layout)
+    {
+        DCHECK(CanLayOut(text, flags));
+        layout->lines.clear();
+
+        std::vector<int> widths;
+        layout->has_all_glyphs = font.GetCharacterWidths(text, &widths);
+
+        if(!(flags & Canvas::MULTI_LINE))
+        {
+            TextLine line;
+            line.length = text.length();
+            for(size_t i=0; i<widths.size(); ++i)
+            {
+                line.width += widths[i];
+            }
+            layout->lines.push_back(line);
+        }
+        else
+        {
+            const bool character_break = (flags & Canvas::CHARACTER_BREAK) != 0;
+            size_t start = 0;
+            for(;;)
+            {
+                size_t end = start;
+                while(end<text.length() && !IsLineBreak(text[end]))
+                {
+                    ++end;
+                }
+                BreakParagraph(text, widths, start, end, width, character_break,
+                    &layout->lines);
+                if(end == text.length())
+                {
+                    break;
+                }
+
+                // "\r\n"һ.
+                start = end + 1;
+                if(text[end]==L'\r' && start<text.length() && text[start]==L'\n')
+                {
+                    ++start;
+                }
+            }
+        }
+
+        layout->width = 0;
+        for(size_t i=0; i<layout->lines.size(); ++i)
+        {
+            layout->width = std::max(layout->width, layout->lines[i].width);
+        }
+        layout->height = font.GetHeight() *
+            static_cast<int>(layout->lines.size());
+    }
+
+    const TextLayout& TextLayoutCache::GetLayout(const string16& text,
+        const Font& font, int flags, int width)
+    {
+        // еŰ޹.
+        const Key key = MakeKey(text, font, flags & kLayoutFlags,
+            (flags & Canvas::MULTI_LINE) ? width : 0, false);
+        Entry* entry = Find(key);
+        if(!entry)
+        {
+            entry = Insert(key);
+            LayOut(text, font, flags, key.width, &entry->layout);
+        }
+        return entry->layout;
+    }
+
+    bool TextLayoutCache::GetMeasuredSize(const string16& text,
+        const Font& font, int flags, int width,
+        int* measured_width, int* measured_height)
+    {
+        Entry* entry = Find(MakeKey(text, font, flags, width, true));
+        if(!entry)
+        {
+            return false;
+        }
+        *measured_width = entry->layout.width;
+        *measured_height = entry->layout.height;
+        return true;
+    }
+
+    void TextLayoutCache::SetMeasuredSize(const string16& text,
+        const Font& font, int flags, int width,
+        int measured_width, int measured_height)
+    {
+        const Key key = MakeKey(text, font, flags, width, true);
+        Index::iterator found = index_.find(key);
+        Entry* entry = found!=index_.end() ? &*found->second : Insert(key);
+        entry->layout.width = measured_width;
+        entry->layout.height = measured_height;
+    }
+
+    void TextLayoutCache::Clear()
+    {
+        index_.clear();
+        probation_.clear();
+        protected_.clear();
+        ghosts_.clear();
+        ghost_index_.clear();
+    }
+
+    void TextLayoutCache::ResetCounts()
+    {
+        hit_count_ = 0;
+        miss_count_ = 0;
+    }
+
+    TextLayoutCache::TextLayoutCache() : hit_count_(0), miss_count_(0) {}
+
+    TextLayoutCache::~TextLayoutCache() {}
+
+    // static
+    TextLayoutCache::Key TextLayoutCache::MakeKey(const string16& text,
+        const Font& font, int flags, int width, bool measured)
+    {
+        Key key;
+        key.text = text;
+        key.font_name = font.GetFontName();
+        key.font_height = font.GetHeight();
+        key.font_baseline = font.GetBaseline();
+        key.font_style = font.GetStyle();
+        key.font_average_width = font.GetAverageCharacterWidth();
+        key.flags = flags;
+        key.width = width;
+        key.measured = measured;
+        return key;
+    }
+
+    // static
+    size_t TextLayoutCache::HashKey(const Key& key)
+    {
+        // FNV-1a.
+        size_t hash = 2166136261u;
+        const int values[] = { key.font_height, key.font_baseline,
+            key.font_style, key.font_average_width, key.flags, key.width,
+            key.measured };
+        for(size_t i=0; i<arraysize(values); ++i)
+        {
+            hash = (hash ^ static_cast<size_t>(values[i])) * 16777619u;
+        }
+        for(size_t i=0; i<key.text.length(); ++i)
+        {
+            hash = (hash ^ key.text[i]) * 16777619u;
+        }
+        for(size_t i=0; i<key.font_name.length(); ++i)
+        {
+            hash = (hash ^ key.font_name[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    TextLayoutCache::Entry* TextLayoutCache::Find(const Key& key)
+    {
+        Index::iterator found = index_.find(key);
+        if(found == index_.end())
+        {
+            ++miss_count_;
+            return NULL;
+        }
+
+        ++hit_count_;
+        Promote(found->second);
+        return &protected_.front();
+    }
+
+    TextLayoutCache::Entry* TextLayoutCache::Insert(const Key& key)
+    {
+        std::map<size_t, Ghosts::iterator>::iterator ghost =
+            ghost_index_.find(HashKey(key));
+        if(ghost != ghost_index_.end())
+        {
+            ghosts_.erase(ghost->second);
+            ghost_index_.erase(ghost);
+            protected_.push_front(Entry());
+            protected_.front().key = key;
+            protected_.front().promoted = true;
+            index_[key] = protected_.begin();
+            Promote(protected_.begin());
+            return &protected_.front();
+        }
+
+        while(probation_.size() >= kMaxProbationEntries)
+        {
+            const size_t hash = HashKey(probation_.back().key);
+            std::map<size_t, Ghosts::iterator>::iterator ghost =
+                ghost_index_.find(hash);
+            if(ghost != ghost_index_.end())
+            {
+                // ɢֵͬļ, ֻѼ¼Ƶǰ.
+                ghosts_.splice(ghosts_.begin(), ghosts_, ghost->second);
+            }
+            else
+            {
+                ghosts_.push_front(hash);
+                ghost_index_[hash] = ghosts_.begin();
+                if(ghost_index_.size() > kMaxGhosts)
+                {
+                    ghost_index_.erase(ghosts_.back());
+                    ghosts_.pop_back();
+                }
+            }
+            index_.erase(probation_.back().key);
+            probation_.pop_back();
+        }
+        probation_.push_front(Entry());
+        probation_.front().key = key;
+        index_[key] = probation_.begin();
+        return &probation_.front();
+    }
+
+    void TextLayoutCache::Promote(Entries::iterator entry)
+    {
+        if(entry->promoted)
+        {
+            protected_.splice(protected_.begin(), protected_, entry);
+        }
+        else
+        {
+            entry->promoted = true;
+            protected_.splice(protected_.begin(), probation_, entry);
+        }
+        index_[protected_.front().key] = protected_.begin();
+
+        if(protected_.size() > kMaxEntries-kMaxProbationEntries)
+        {
+            index_.erase(protected_.back().key);
+            protected_.pop_back();
+        }
+    }
+
+} //namespace gfx
@@ -0,0 +1,174 @@
+
+#ifndef __ui_gfx_text_layout_cache_h__
+#define __ui_gfx_text_layout_cache_h__
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include "base/basic_types.h"
+#include "base/string16.h"
+
+template<typename T> struct DefaultSingletonTraits;
+
+namespace gfx
+{
+
+    class Font;
+
+    // Űһ: text[start, start+length)ַ, Ȳβ۶ϴĿո.
+    struct TextLine
+    {
+        TextLine() : start(0), length(0), width(0) {}
+
+        size_t start;
+        size_t length;
+        int width;
+    };
+
+    // һı塢־ͿŰĽ.
+    struct TextLayout
+    {
+        TextLayout() : width(0), height(0), has_all_glyphs(true) {}
+
+        // һеĿȺеĸ߶.
+        int width;
+        int height;
+
+        // 屾ÿַ. Ϊfalseʱƽ̨úһЩַ,
+        // ǵĿŰõĲͬ, Ű.
+        bool has_all_glyphs;
+
+        std::vector<TextLine> lines;
+    };
+
+    // ıĲŰ, Ϊ(ı, , ־, ). ǩ˵ͱǩҳ
+    // ÿβֺͻƶַͬ, лȲٲ, Ҳ
+    // . ֽ:
+    //   - ƽ̨(DrawText())õĳߴ, ɵ÷, SetMeasuredSize().
+    //   - ıĻλúÿп. ŰֻFont::GetCharacterWidths()
+    //     صַ, ƽ̨޹; ֻCanLayOut()Ͽɵı. ÷
+    //     ͻͬһıʱҪͬһֽ, пܲͬ.
+    //
+    // Ŀ̭(2Q): ĿȽСö, ڶٴ, 򱻼
+    // öκ󲻾ֱõ(ֻסɢֵ), Ž. ʡıʱԲ
+    // ַֻһ, ֻἷöĿ, ̭ʹõ. ֻUI߳
+    // ʹ.
+    class TextLayoutCache
+    {
+    public:
+        // Ŀ.
+        static const size_t kMaxEntries = 512;
+
+        // öεĿ.
+        static const size_t kMaxProbationEntries = 128;
+
+        // סļöεļĸ.
+        static const size_t kMaxGhosts = 4 * kMaxEntries;
+
+        static TextLayoutCache* GetInstance();
+
+        // ıͱ־ܰĹŰʱtrue. |flags|gfx::Canvası־.
+        static bool CanLayOut(const string16& text, int flags);
+
+        // Ű|text|. (MULTI_LINE)ʱڿո񴦺պ֮, ʹÿв
+        // |width|; ޷۶ϵĴʶռһ, ָCHARACTER_BREAKʱַ۶.
+        // зһ. ʱ|width|.
+        static void LayOut(const string16& text, const Font& font, int flags,
+            int width, TextLayout* layout);
+
+        // |text|Ű, δʱŰ沢. صһεǰЧ.
+        const TextLayout& GetLayout(const string16& text, const Font& font,
+            int flags, int width);
+
+        // ȡSetMeasuredSize()ĳߴ. δʱfalse.
+        bool GetMeasuredSize(const string16& text, const Font& font, int flags,
+            int width, int* measured_width, int* measured_height);
+
+        // ƽ̨|flags||width|õ|text|ĳߴ.
+        void SetMeasuredSize(const string16& text, const Font& font, int flags,
+            int width, int measured_width, int measured_height);
+
+        void Clear();
+
+        // кδеĴ, ԴϴResetCounts().
+        int hit_count() const { return hit_count_; }
+        int miss_count() const { return miss_count_; }
+        void ResetCounts();
+
+        size_t size() const { return probation_.size() + protected_.size(); }
+
+    private:
+        friend struct DefaultSingletonTraits<TextLayoutCache>;
+
+        struct Key
+        {
+            Key() : font_height(0), font_baseline(0), font_style(0),
+                font_average_width(0), flags(0), width(0), measured(false) {}
+
+            bool operator<(const Key& other) const;
+
+            string16 text;
+            string16 font_name;
+            int font_height;
+            int font_baseline;
+            int font_style;
+            int font_average_width;
+            int flags;
+            int width;
+            // true: ƽ̨õĳߴ; false: Ű.
+            bool measured;
+        };
+
+        // õĳߴֻ|layout|widthheight.
+        struct Entry
+        {
+            Entry() : promoted(false) {}
+
+            Key key;
+            TextLayout layout;
+            // .
+            bool promoted;
+        };
+
+        typedef std::list<Entry> Entries;
+        typedef std::map<Key, Entries::iterator> Index;
+
+        TextLayoutCache();
+        ~TextLayoutCache();
+
+        static Key MakeKey(const string16& text, const Font& font, int flags,
+            int width, bool measured);
+        static size_t HashKey(const Key& key);
+
+        // |key|. ʱĿƵǰ.
+        Entry* Find(const Key& key);
+
+        // |key|ĿĿ: öεĽ, ö.
+        Entry* Insert(const Key& key);
+
+        // |entry|Ƶǰ, ʱ̭δõ.
+        void Promote(Entries::iterator entry);
+
+        // θʹõǰ.
+        Entries probation_;
+        Entries protected_;
+        Index index_;
+
+        // öεļɢֵ, ǰ. |ghost_index_|ɢֵ
+        // |ghosts_|Ľڵ, ÿɢֵֻһ.
+        typedef std::list<size_t> Ghosts;
+        Ghosts ghosts_;
+        std::map<size_t, Ghosts::iterator> ghost_index_;
+
+        int hit_count_;
+        int miss_count_;
+
+        DISALLOW_COPY_AND_ASSIGN(TextLayoutCache);
+    };
+
+} //namespace gfx
+
+#endif //__ui_gfx_text_layout_cache_h__
@@ -0,0 +1,239 @@
+#include "child_hit_test_index.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+#include "view.h"
+
+namespace
+{
+
+    // Cells are never smaller than this, so a host full of tiny children
+    // doesn't get an equally fine grid.
+    const int kMinCellSize = 16;
+
+    // Large hosts get larger cells rather than more of them.
+    const int64 kMaxCellCount = 16384;
+
+}
+
+namespace view
+{
+    namespace internal
+    {
+
+        ChildHitTestIndex::ChildHitTestIndex(View* host)
+            : host_(host),
+            dirty_(true),
+            cell_width_(0),
+            cell_height_(0),
+            columns_(0),
+            rows_(0) {}
+
+        ChildHitTestIndex::~ChildHitTestIndex() {}
+
+        void ChildHitTestIndex::Invalidate()
+        {
+            dirty_ = true;
+        }
+
+        void ChildHitTestIndex::ChildBoundsChanged(View* child,
+            const gfx::Rect& previous_bounds)
+        {
+            if(dirty_ || child->transform())
+            {
+                return;
+            }
+
+            gfx::Rect previous_mirrored_bounds(previous_bounds);
+            previous_mirrored_bounds.set_x(
+                host_->GetMirroredXForRect(previous_bounds));
+            RemoveFromCells(child, previous_mirrored_bounds);
+            AddToCells(child, child->GetMirroredBounds());
+        }
+
+        bool ChildHitTestIndex::GetChildForPoint(const gfx::Point& point,
+            View** child)
+        {
+            if(dirty_)
+            {
+                Rebuild();
+            }
+
+            int column, row;
+            if(!GetCellRange(gfx::Rect(point.x(), point.y(), 1, 1),
+                &column, &column, &row, &row))
+            {
+                return false;
+            }
+
+            std::vector<View*> hits;
+            const std::vector<View*>& cell = cells_[row*columns_+column];
+            for(int pass=0; pass<2; ++pass)
+            {
+                const std::vector<View*>& candidates = pass==0 ? cell : unindexed_;
+                for(size_t i=0; i<candidates.size(); ++i)
+                {
+                    View* candidate = candidates[i];
+                    if(!candidate->IsVisible())
+                    {
+                        continue;
+                    }
+
+                    gfx::Point point_in_child_coords(point);
+                    View::ConvertPointToView(host_, candidate, &point_in_child_coords);
+                    if(candidate->HitTest(point_in_child_coords))
+                    {
+                        hits.push_back(candidate);
+                    }
+                }
+            }
+
+            *child = NULL;
+            if(hits.size() == 1)
+            {
+                *child = hits[0];
+            }
+            else if(hits.size() > 1)
+            {
+                // Overlapping children: the one painted last is on top.
+                for(int i=host_->child_count()-1; i>=0 && !*child; --i)
+                {
+                    if(std::find(hits.begin(), hits.end(),
+                        host_->child_at(i)) != hits.end())
+                    {
+                        *child = host_->child_at(i);
+                    }
+                }
+                DCHECK(*child);
+            }
+            return true;
+        }
+
+        void ChildHitTestIndex::Rebuild()
+        {
+            dirty_ = false;
+            cells_.clear();
+            unindexed_.clear();
+            columns_ = 0;
+            rows_ = 0;
+
+            const gfx::Rect host_bounds = host_->GetLocalBounds();
+            if(host_bounds.IsEmpty())
+            {
+                return;
+            }
+
+            // Size the cells after the children, so a typical child covers about
+            // one cell.
+            int64 total_width = 0;
+            int64 total_height = 0;
+            int count = 0;
+            for(int i=0; i<host_->child_count(); ++i)
+            {
+                View* child = host_->child_at(i);
+                if(child->transform())
+                {
+                    unindexed_.push_back(child);
+                    continue;
+                }
+                gfx::Rect rect = child->GetMirroredBounds().Intersect(host_bounds);
+                if(!rect.IsEmpty())
+                {
+                    total_width += rect.width();
+                    total_height += rect.height();
+                    ++count;
+                }
+            }
+            cell_width_ = count ? static_cast<int>(total_width/count) :
+                host_bounds.width();
+            cell_height_ = count ? static_cast<int>(total_height/count) :
+                host_bounds.height();
+            cell_width_ = std::max(kMinCellSize, cell_width_);
+            cell_height_ = std::max(kMinCellSize, cell_height_);
+            for(;;)
+            {
+                columns_ = (host_bounds.width() + cell_width_ - 1) / cell_width_;
+                rows_ = (host_bounds.height() + cell_height_ - 1) / cell_height_;
+                if(static_cast<int64>(columns_)*rows_ <= kMaxCellCount)
+                {
+                    break;
+                }
+                cell_width_ *= 2;
+                cell_height_ *= 2;
+            }
+
+            cells_.resize(columns_*rows_);
+            for(int i=0; i<host_->child_count(); ++i)
+            {
+                View* child = host_->child_at(i);
+                if(!child->transform())
+                {
+                    AddToCells(child, child->GetMirroredBounds());
+                }
+            }
+        }
+
+        void ChildHitTestIndex::AddToCells(View* child, const gfx::Rect& rect)
+        {
+            int first_column, last_column, first_row, last_row;
+            if(!GetCellRange(rect, &first_column, &last_column,
+                &first_row, &last_row))
+            {
+                return;
+            }
+
+            for(int row=first_row; row<=last_row; ++row)
+            {
+                for(int column=first_column; column<=last_column; ++column)
+                {
+                    cells_[row*columns_+column].push_back(child);
+                }
+            }
+        }
+
+        void ChildHitTestIndex::RemoveFromCells(View* child, const gfx::Rect& rect)
+        {
+            int first_column, last_column, first_row, last_row;
+            if(!GetCellRange(rect, &first_column, &last_column,
+                &first_row, &last_row))
+            {
+                return;
+            }
+
+            for(int row=first_row; row<=last_row; ++row)
+            {
+                for(int column=first_column; column<=last_column; ++column)
+                {
+                    std::vector<View*>& cell = cells_[row*columns_+column];
+                    std::vector<View*>::iterator i =
+                        std::find(cell.begin(), cell.end(), child);
+                    DCHECK(i != cell.end());
+                    if(i != cell.end())
+                    {
+                        cell.erase(i);
+                    }
+                }
+            }
+        }
+
+        bool ChildHitTestIndex::GetCellRange(const gfx::Rect& rect,
+            int* first_column, int* last_column,
+            int* first_row, int* last_row) const
+        {
+            gfx::Rect grid_rect = rect.Intersect(host_->GetLocalBounds());
+            if(grid_rect.IsEmpty() || columns_==0)
+            {
+                return false;
+            }
+
+            *first_column = grid_rect.x() / cell_width_;
+            *last_column = (grid_rect.right() - 1) / cell_width_;
+            *first_row = grid_rect.y() / cell_height_;
+            *last_row = (grid_rect.bottom() - 1) / cell_height_;
+            return true;
+        }
+
+    } //namespace internal
+} //namespace view
@@ -0,0 +1,84 @@
+#ifndef __view_child_hit_test_index_h__
+#define __view_child_hit_test_index_h__
+
+#pragma once
+
+#include <vector>
+
+#include "base/basic_types.h"
+
+#include "ui_gfx/rect.h"
+
+namespace gfx
+{
+    class Point;
+}
+
+namespace view
+{
+
+    class View;
+
+    // This is a views-internal API and should not be used externally. View uses
+    // this class to find the child under a point without hit testing every child.
+    namespace internal
+    {
+
+        // Buckets the children of a view into a uniform grid of cells over the
+        // view's local bounds, by their mirrored bounds. A point only has to be
+        // hit tested against the children in its cell. Children with a transform
+        // can't be placed by their bounds and are tested for every point.
+        class ChildHitTestIndex
+        {
+        public:
+            explicit ChildHitTestIndex(View* host);
+            ~ChildHitTestIndex();
+
+            // Rebuilds the grid on the next query. Called when children are added,
+            // removed, reordered or transformed, and when the host is resized.
+            void Invalidate();
+
+            // Moves |child| from the cells it had at |previous_bounds| to the cells
+            // of its current bounds.
+            void ChildBoundsChanged(View* child, const gfx::Rect& previous_bounds);
+
+            // Sets |child| to the topmost visible child hit by |point| (in host
+            // coordinates), or NULL if there is none. Returns false if |point| is
+            // outside the grid; the caller has to walk the children itself then.
+            bool GetChildForPoint(const gfx::Point& point, View** child);
+
+        private:
+            void Rebuild();
+
+            // Adds |child| to, or removes it from, every cell |rect| overlaps.
+            void AddToCells(View* child, const gfx::Rect& rect);
+            void RemoveFromCells(View* child, const gfx::Rect& rect);
+
+            // Returns the range of cells |rect| overlaps, false if there is none.
+            bool GetCellRange(const gfx::Rect& rect, int* first_column,
+                int* last_column, int* first_row, int* last_row) const;
+
+            View* host_;
+
+            // True if the grid no longer matches the children.
+            bool dirty_;
+
+            int cell_width_;
+            int cell_height_;
+            int columns_;
+            int rows_;
+
+            // The children overlapping each cell, row by row, in no particular
+            // order.
+            std::vector<std::vector<View*> > cells_;
+
+            // Children with a transform.
+            std::vector<View*> unindexed_;
+
+            DISALLOW_COPY_AND_ASSIGN(ChildHitTestIndex);
+        };
+
+    } //namespace internal
+} //namespace view
+
+#endif //__view_child_hit_test_index_h__
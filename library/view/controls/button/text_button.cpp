@@ -711,6 +711,8 @@ namespace view
     void TextButton::SetIcon(const SkBitmap& icon)
     {
         icon_ = icon;
+        // The preferred size includes the icon.
+        PreferredSizeChanged();
     }
 
     void TextButton::SetHoverIcon(const SkBitmap& icon)
@@ -71,6 +71,7 @@ namespace view
     void ImageView::ResetImageSize()
     {
         image_size_set_ = false;
+        PreferredSizeChanged();
     }
 
     gfx::Size ImageView::GetPreferredSize()
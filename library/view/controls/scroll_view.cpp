@@ -3,6 +3,8 @@
 
 #include "base/logging.h"
 
+#include "view/paint_lock.h"
+
 #include "scrollbar/native_scroll_bar.h"
 
 namespace view
@@ -365,11 +367,36 @@ namespace view
         const int new_y =
             (vis_rect.y()>y) ? y : std::max(0, max_y-viewport_->height());
 
-        contents_->SetX(-new_x);
-        contents_->SetY(-new_y);
+        MoveContentsTo(-new_x, -new_y);
         UpdateScrollBarPositions();
     }
 
+    void ScrollView::MoveContentsTo(int x, int y)
+    {
+        const gfx::Rect old_bounds = contents_->bounds();
+        const gfx::Rect new_bounds(x, y, old_bounds.width(), old_bounds.height());
+        const gfx::Rect viewport_bounds = viewport_->GetLocalBounds();
+        if(new_bounds==old_bounds || !contents_->IsVisible() ||
+            !contents_->fills_bounds_opaquely() ||
+            !old_bounds.Contains(viewport_bounds) ||
+            !new_bounds.Contains(viewport_bounds))
+        {
+            // The viewport background shows through, or gets uncovered.
+            contents_->SetBoundsRect(new_bounds);
+            return;
+        }
+
+        {
+            PaintLock lock(contents_);
+            contents_->SetBoundsRect(new_bounds);
+        }
+        if(!viewport_->ScrollPaintedRect(viewport_bounds,
+            x-old_bounds.x(), y-old_bounds.y()))
+        {
+            contents_->SchedulePaintInRect(contents_->GetVisibleBounds());
+        }
+    }
+
     void ScrollView::UpdateScrollBarPositions()
     {
         if(!contents_)
@@ -393,7 +420,6 @@ namespace view
         }
     }
 
-    // TODO(ACW): We should really use ScrollWindowEx as needed
     void ScrollView::ScrollToPosition(ScrollBar* source, int position)
     {
         if(!contents_)
@@ -417,8 +443,7 @@ namespace view
                 {
                     position = max_pos;
                 }
-                contents_->SetX(-position);
-                contents_->SchedulePaintInRect(contents_->GetVisibleBounds());
+                MoveContentsTo(-position, contents_->y());
             }
         }
         else if(source==vert_sb_ && vert_sb_->IsVisible())
@@ -437,8 +462,7 @@ namespace view
                 {
                     position = max_pos;
                 }
-                contents_->SetY(-position);
-                contents_->SchedulePaintInRect(contents_->GetVisibleBounds());
+                MoveContentsTo(contents_->x(), -position);
             }
         }
     }
@@ -103,6 +103,12 @@ namespace view
         // Update the scrollbars positions given viewport and content sizes.
         void UpdateScrollBarPositions();
 
+        // Moves the contents to |x|, |y| in the viewport. When the contents are
+        // opaque and cover the viewport before and after the move, the pixels
+        // already on screen are moved along and only the strips scrolled into
+        // view are painted.
+        void MoveContentsTo(int x, int y);
+
         // Make sure the content is not scrolled out of bounds
         void CheckScrollBounds();
 
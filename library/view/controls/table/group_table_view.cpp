@@ -173,6 +173,13 @@ namespace view
         return TableView::CompareRows(range1, range2);
     }
 
+    int GroupTableView::GetSortKeyRow(int model_row)
+    {
+        // Rows sharing a group start share their keys, and rows with equal keys
+        // stay in model order, so each group stays together and in order.
+        return model_index_to_range_start_map_[model_row];
+    }
+
     void GroupTableView::OnSelectedStateChanged()
     {
         // The goal is to make sure all items for a same group are in a consistent
@@ -66,9 +66,16 @@ namespace view
         // Overriden to make sure rows in the same group stay grouped together.
         virtual int CompareRows(int model_row1, int model_row2);
 
+        // Sorts each row by the first row of its group, see CompareRows.
+        virtual int GetSortKeyRow(int model_row);
+
         // Updates model_index_to_range_start_map_ from the model.
         virtual void PrepareForSort();
 
+        // Rows added at the start of a group change the row the whole group
+        // sorts by, so added rows always resort the table.
+        virtual bool CanInsertSorted() { return false; }
+
     private:
         // Make the selection of group consistent.
         void SyncSelection();
@@ -0,0 +1,152 @@
+#include "table_selection_ranges.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace view
+{
+
+    TableSelectionRanges::TableSelectionRanges() {}
+
+    TableSelectionRanges::~TableSelectionRanges() {}
+
+    int TableSelectionRanges::GetCount() const
+    {
+        int count = 0;
+        for(size_t i=0; i<ranges_.size(); ++i)
+        {
+            count += ranges_[i].end - ranges_[i].start;
+        }
+        return count;
+    }
+
+    int TableSelectionRanges::GetFirst() const
+    {
+        return ranges_.empty() ? -1 : ranges_[0].start;
+    }
+
+    bool TableSelectionRanges::Contains(int row) const
+    {
+        size_t index = FindRange(row);
+        return index<ranges_.size() && ranges_[index].start<=row;
+    }
+
+    void TableSelectionRanges::Clear()
+    {
+        ranges_.clear();
+    }
+
+    void TableSelectionRanges::Add(int start, int end)
+    {
+        if(start >= end)
+        {
+            return;
+        }
+
+        // Merge with every range that overlaps or touches [start, end).
+        size_t first = FindRange(start - 1);
+        size_t last = first;
+        while(last<ranges_.size() && ranges_[last].start<=end)
+        {
+            start = std::min(start, ranges_[last].start);
+            end = std::max(end, ranges_[last].end);
+            ++last;
+        }
+        ranges_.erase(ranges_.begin()+first, ranges_.begin()+last);
+        ranges_.insert(ranges_.begin()+first, Range(start, end));
+    }
+
+    void TableSelectionRanges::Remove(int start, int end)
+    {
+        if(start >= end)
+        {
+            return;
+        }
+
+        size_t first = FindRange(start);
+        size_t last = first;
+        Ranges pieces;
+        while(last<ranges_.size() && ranges_[last].start<end)
+        {
+            // Keep the parts of the range on either side of [start, end).
+            if(ranges_[last].start < start)
+            {
+                pieces.push_back(Range(ranges_[last].start, start));
+            }
+            if(ranges_[last].end > end)
+            {
+                pieces.push_back(Range(end, ranges_[last].end));
+            }
+            ++last;
+        }
+        ranges_.erase(ranges_.begin()+first, ranges_.begin()+last);
+        ranges_.insert(ranges_.begin()+first, pieces.begin(), pieces.end());
+    }
+
+    void TableSelectionRanges::ItemsAdded(int start, int length)
+    {
+        DCHECK_GE(length, 0);
+        if(length == 0)
+        {
+            return;
+        }
+
+        size_t index = FindRange(start);
+        if(index<ranges_.size() && ranges_[index].start<start)
+        {
+            // The new rows split this range.
+            Range tail(start, ranges_[index].end);
+            ranges_[index].end = start;
+            ranges_.insert(ranges_.begin()+index+1, tail);
+            ++index;
+        }
+        for(; index<ranges_.size(); ++index)
+        {
+            ranges_[index].start += length;
+            ranges_[index].end += length;
+        }
+    }
+
+    void TableSelectionRanges::ItemsRemoved(int start, int length)
+    {
+        DCHECK_GE(length, 0);
+        Remove(start, start+length);
+
+        // A range ending at |start| and one starting right after the removed rows
+        // now touch.
+        size_t index = FindRange(start);
+        bool merge = index>0 && index<ranges_.size() &&
+            ranges_[index-1].end==start && ranges_[index].start==start+length;
+        for(size_t i=index; i<ranges_.size(); ++i)
+        {
+            ranges_[i].start -= length;
+            ranges_[i].end -= length;
+        }
+        if(merge)
+        {
+            ranges_[index-1].end = ranges_[index].end;
+            ranges_.erase(ranges_.begin()+index);
+        }
+    }
+
+    size_t TableSelectionRanges::FindRange(int row) const
+    {
+        size_t low = 0;
+        size_t high = ranges_.size();
+        while(low < high)
+        {
+            size_t middle = (low + high) / 2;
+            if(ranges_[middle].end <= row)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+} //namespace view
@@ -0,0 +1,68 @@
+#ifndef __view_table_selection_ranges_h__
+#define __view_table_selection_ranges_h__
+
+#pragma once
+
+#include <vector>
+
+#include "base/basic_types.h"
+
+namespace view
+{
+
+    // A set of rows kept as sorted, disjoint [start, end) ranges. Selecting a
+    // span of rows, testing a row and shifting rows as the model changes cost
+    // the number of ranges, not the number of rows they cover.
+    class TableSelectionRanges
+    {
+    public:
+        struct Range
+        {
+            Range(int start, int end) : start(start), end(end) {}
+
+            int start;
+            int end;
+        };
+        typedef std::vector<Range> Ranges;
+
+        TableSelectionRanges();
+        ~TableSelectionRanges();
+
+        bool empty() const { return ranges_.empty(); }
+        const Ranges& ranges() const { return ranges_; }
+
+        // Returns the number of rows in the set.
+        int GetCount() const;
+
+        // Returns the first row in the set, or -1 if it's empty.
+        int GetFirst() const;
+
+        // Returns true if |row| is in the set.
+        bool Contains(int row) const;
+
+        void Clear();
+
+        // Adds or removes the rows [start, end).
+        void Add(int start, int end);
+        void Remove(int start, int end);
+
+        // Updates the rows for |length| rows inserted into the model at |start|.
+        // The inserted rows are not in the set.
+        void ItemsAdded(int start, int length);
+
+        // Updates the rows for the rows [start, start + length) being removed
+        // from the model.
+        void ItemsRemoved(int start, int length);
+
+    private:
+        // Returns the index of the first range ending after |row|.
+        size_t FindRange(int row) const;
+
+        Ranges ranges_;
+
+        DISALLOW_COPY_AND_ASSIGN(TableSelectionRanges);
+    };
+
+} //namespace view
+
+#endif //__view_table_selection_ranges_h__
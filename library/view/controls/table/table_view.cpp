@@ -22,6 +22,7 @@
 #include "ui_base/l10n/l10n_util.h"
 #include "ui_base/l10n/l10n_util_win.h"
 #include "ui_base/models/table_model.h"
+#include "ui_base/models/table_sorter.h"
 #include "ui_base/resource/resource_bundle.h"
 #include "ui_base/win/hwnd_util.h"
 
@@ -76,7 +77,8 @@ namespace view
         original_handler_(NULL),
         table_view_wrapper_(this),
         custom_cell_font_(NULL),
-        content_offset_(0)
+        content_offset_(0),
+        model_changes_(this)
     {
         for(std::vector<ui::TableColumn>::const_iterator i=columns.begin();
             i!=columns.end(); ++i)
@@ -113,9 +115,10 @@ namespace view
             model_->SetObserver(NULL);
         }
         model_ = model;
+        model_changes_.SetModel(model_);
         if(list_view_ && model_)
         {
-            model_->SetObserver(this);
+            model_->SetObserver(&model_changes_);
         }
         if(list_view_)
         {
@@ -125,6 +128,8 @@ namespace view
 
     void TableView::SetSortDescriptors(const SortDescriptors& sort_descriptors)
     {
+        model_changes_.Flush();
+
         if(!sort_descriptors_.empty())
         {
             ResetColumnSortImage(sort_descriptors_[0].column_id, NO_SORT);
@@ -166,6 +171,9 @@ namespace view
         {
             return 0;
         }
+
+        model_changes_.Flush();
+
         return ListView_GetSelectedCount(list_view_);
     }
 
@@ -176,6 +184,8 @@ namespace view
             return;
         }
 
+        model_changes_.Flush();
+
         DCHECK(model_row >= 0 && model_row < RowCount());
         SendMessage(list_view_, WM_SETREDRAW, static_cast<WPARAM>(FALSE), 0);
         ignore_listview_change_ = true;
@@ -205,6 +215,8 @@ namespace view
             return;
         }
 
+        model_changes_.Flush();
+
         DCHECK(model_row>=0 && model_row<RowCount());
 
         ignore_listview_change_ = true;
@@ -223,6 +235,8 @@ namespace view
             return;
         }
 
+        model_changes_.Flush();
+
         DCHECK(model_row>=0 && model_row<RowCount());
 
         ignore_listview_change_ = true;
@@ -241,6 +255,8 @@ namespace view
             return -1;
         }
 
+        model_changes_.Flush();
+
         int view_row = ListView_GetNextItem(list_view_, -1,
             LVNI_ALL|LVIS_SELECTED);
         return view_row==-1 ? -1 : ViewToModel(view_row);
@@ -253,6 +269,8 @@ namespace view
             return false;
         }
 
+        model_changes_.Flush();
+
         DCHECK(model_row>=0 && model_row<RowCount());
         return (ListView_GetItemState(list_view_, ModelToView(model_row),
             LVIS_SELECTED) == LVIS_SELECTED);
@@ -265,6 +283,8 @@ namespace view
             return false;
         }
 
+        model_changes_.Flush();
+
         DCHECK(model_row>=0 && model_row<RowCount());
         return (ListView_GetItemState(list_view_, ModelToView(model_row),
             LVIS_FOCUSED) == LVIS_FOCUSED);
@@ -272,6 +292,8 @@ namespace view
 
     TableView::iterator TableView::SelectionBegin()
     {
+        model_changes_.Flush();
+
         return TableView::iterator(this, LastSelectedViewIndex());
     }
 
@@ -384,7 +406,7 @@ namespace view
             // Only a portion of the data was removed.
             if(is_sorted())
             {
-                int new_row_count = model_->RowCount();
+                int new_row_count = old_row_count - length;
                 std::vector<int> view_items_to_remove;
                 view_items_to_remove.reserve(length);
                 // Iterate through the elements, updating the view_to_model_ mapping
@@ -988,7 +1010,8 @@ namespace view
 
         if(model_)
         {
-            model_->SetObserver(this);
+            model_changes_.SetModel(model_);
+            model_->SetObserver(&model_changes_);
         }
 
         UpdateGroups();
@@ -1092,6 +1115,11 @@ namespace view
 
         PrepareForSort();
 
+        if(SortByKeysAndUpdateMapping())
+        {
+            return;
+        }
+
         // Sort the items.
         ListView_SortItems(list_view_, &TableView::SortFunc, this);
 
@@ -1112,6 +1140,60 @@ namespace view
         }
     }
 
+    bool TableView::SortByKeysAndUpdateMapping()
+    {
+        int row_count = RowCount();
+        ui::TableSorter sorter(model_);
+        sorter.AddColumn(sort_descriptors_[0].column_id,
+            sort_descriptors_[0].ascending);
+        if(sort_descriptors_.size()>1 && sort_descriptors_[1].column_id!=-1)
+        {
+            // Secondary sort.
+            sorter.AddColumn(sort_descriptors_[1].column_id,
+                sort_descriptors_[1].ascending);
+        }
+        // Sorting by groups as well keeps the visual order matching the item
+        // indices, see CompareRows.
+        sorter.set_sort_by_group(model_->HasGroups());
+
+        std::vector<int> key_rows(row_count);
+        for(int i=0; i<row_count; ++i)
+        {
+            key_rows[i] = GetSortKeyRow(i);
+        }
+        sorter.set_key_rows(key_rows);
+
+        std::vector<int> view_to_model;
+        if(!sorter.Sort(row_count, &view_to_model))
+        {
+            return false;
+        }
+
+        // A subclass may order rows its own way in CompareRows, which the keys
+        // know nothing about. Keep the key order only if CompareRows agrees with
+        // it; that takes one comparison per row rather than a sort's worth.
+        for(int i=1; i<row_count; ++i)
+        {
+            if(CompareRows(view_to_model[i-1], view_to_model[i]) > 0)
+            {
+                return false;
+            }
+        }
+
+        model_to_view_.reset(new int[row_count]);
+        view_to_model_.reset(new int[row_count]);
+        for(int i=0; i<row_count; ++i)
+        {
+            int model_index = view_to_model[i];
+            view_to_model_[i] = model_index;
+            model_to_view_[model_index] = i;
+        }
+
+        // Move the items into place; comparing view indices is cheap.
+        ListView_SortItems(list_view_, &TableView::MappedSortFunc, this);
+        return true;
+    }
+
     bool TableView::SelectMultiple(int view_index, int mark_view_index)
     {
         int group_id = 0;
@@ -1141,6 +1223,23 @@ namespace view
         return true;
     }
 
+    // Orders model rows the way the sorted table shows them: by CompareRows,
+    // then by model index, as the key sort does.
+    class TableView::SortedRowLess
+    {
+    public:
+        explicit SortedRowLess(TableView* table_view) : table_view_(table_view) {}
+
+        bool operator()(int model_row1, int model_row2) const
+        {
+            int result = table_view_->CompareRows(model_row1, model_row2);
+            return result!=0 ? result<0 : model_row1<model_row2;
+        }
+
+    private:
+        TableView* table_view_;
+    };
+
     // static
     int CALLBACK TableView::SortFunc(LPARAM model_index_1_p,
         LPARAM model_index_2_p, LPARAM table_view_param)
@@ -1158,6 +1257,15 @@ namespace view
         return model_index_1_p - model_index_2_p;
     }
 
+    // static
+    int CALLBACK TableView::MappedSortFunc(LPARAM model_index_1_p,
+        LPARAM model_index_2_p, LPARAM table_view_param)
+    {
+        TableView* table_view = reinterpret_cast<TableView*>(table_view_param);
+        return table_view->model_to_view_[static_cast<int>(model_index_1_p)] -
+            table_view->model_to_view_[static_cast<int>(model_index_2_p)];
+    }
+
     void TableView::ResetColumnSortImage(int column_id, SortDirection direction)
     {
         if(!list_view_ || column_id==-1)
@@ -1243,14 +1351,21 @@ namespace view
             return 0;
         }
 
-        switch(hdr->code)
+        if(hdr->code == NM_CUSTOMDRAW)
         {
-        case NM_CUSTOMDRAW:
-            {
-                // Draw notification. dwDragState indicates the current stage of drawing.
-                return OnCustomDraw(reinterpret_cast<NMLVCUSTOMDRAW*>(hdr));
-            }
+            // Draw notification. dwDragState indicates the current stage of drawing.
+            // Items can't be added or removed while the list view paints, so
+            // pending model changes aren't flushed here; OnCustomDraw skips
+            // rows the model no longer has.
+            return OnCustomDraw(reinterpret_cast<NMLVCUSTOMDRAW*>(hdr));
+        }
+
+        // The notifications below read the model through the view's mapping,
+        // which must include the pending model changes.
+        model_changes_.Flush();
 
+        switch(hdr->code)
+        {
         case LVN_ITEMCHANGED:
             {
                 // Notification that the state of an item has changed. The state
@@ -1448,11 +1563,18 @@ namespace view
                     ItemColor foreground = {0};
                     ItemColor background = {0};
 
+                    int model_index = ViewToModel(
+                        static_cast<int>(draw_info->nmcd.dwItemSpec));
+                    if(model_index >= model_->RowCount())
+                    {
+                        // Removed from the model, and not yet from the list view.
+                        return CDRF_DODEFAULT;
+                    }
+
                     LOGFONT logfont;
                     GetObject(GetWindowFont(list_view_), sizeof(logfont), &logfont);
 
-                    if(GetCellColors(ViewToModel(
-                        static_cast<int>(draw_info->nmcd.dwItemSpec)),
+                    if(GetCellColors(model_index,
                         draw_info->iSubItem,
                         &foreground,
                         &background,
@@ -1484,11 +1606,16 @@ namespace view
                 DCHECK((table_type_ == ICON_AND_TEXT) || (ImplementPostPaint()));
                 int view_index = static_cast<int>(draw_info->nmcd.dwItemSpec);
                 // We get notifications for empty items, just ignore them.
-                if(view_index >= model_->RowCount())
+                if(view_index>=RowCount() || view_index>=model_->RowCount())
                 {
                     return CDRF_DODEFAULT;
                 }
                 int model_index = ViewToModel(view_index);
+                if(model_index >= model_->RowCount())
+                {
+                    // Removed from the model, and not yet from the list view.
+                    return CDRF_DODEFAULT;
+                }
                 LRESULT r = CDRF_DODEFAULT;
                 // First let's take care of painting the right icon.
                 if(table_type_ == ICON_AND_TEXT)
@@ -1727,7 +1854,15 @@ namespace view
 
     void TableView::UpdateListViewCache0(int start, int length, bool add)
     {
-        if(is_sorted())
+        // A few rows added to a large sorted table are placed by binary search
+        // instead of resorting every row.
+        const bool insert_sorted = add && is_sorted() && CanInsertSorted() &&
+            length<RowCount();
+        if(insert_sorted)
+        {
+            InsertSortedItems(start, length);
+        }
+        else if(is_sorted())
         {
             if(add)
             {
@@ -1739,28 +1874,15 @@ namespace view
             }
         }
 
-        LVITEM item = { 0 };
-        if(add)
+        if(add && !insert_sorted)
         {
-            const bool has_groups = model_->HasGroups();
             for(int i=start; i<start+length; ++i)
             {
-                item.mask = has_groups ? (LVIF_GROUPID | LVIF_PARAM) : LVIF_PARAM;
-                item.iItem = i;
-                if(has_groups)
-                {
-                    item.iGroupId = model_->GetGroupID(i);
-                }
-                if(model_->ShouldIndent(i))
-                {
-                    item.mask |= LVIF_INDENT;
-                    item.iIndent = 1;
-                }
-                item.lParam = i;
-                ListView_InsertItem(list_view_, &item);
+                InsertListViewItem(i, i);
             }
         }
 
+        LVITEM item;
         memset(&item, 0, sizeof(LVITEM));
         item.mask = (table_type_ == ICON_AND_TEXT) ? (LVIF_IMAGE | LVIF_TEXT) :
             LVIF_TEXT;
@@ -1772,7 +1894,7 @@ namespace view
             for(int i=start; i<start+length; ++i)
             {
                 // Set item.
-                item.iItem = add ? i : ModelToView(i);
+                item.iItem = (add && !insert_sorted) ? i : ModelToView(i);
                 item.iSubItem = j;
                 std::wstring text = model_->GetText(i, visible_columns_[j]);
                 item.pszText = const_cast<LPWSTR>(text.c_str());
@@ -1800,16 +1922,103 @@ namespace view
             }
         }
 
-        if(is_sorted())
+        if(is_sorted() && !insert_sorted)
         {
-            // NOTE: As most of our tables are smallish I'm not going to optimize this.
-            // If our tables become large and frequently update, then it'll make sense
-            // to optimize this.
-
             SortItemsAndUpdateMapping();
         }
     }
 
+    void TableView::InsertListViewItem(int view_index, int model_row)
+    {
+        LVITEM item = { 0 };
+        item.mask = LVIF_PARAM;
+        item.iItem = view_index;
+        if(model_->HasGroups())
+        {
+            item.mask |= LVIF_GROUPID;
+            item.iGroupId = model_->GetGroupID(model_row);
+        }
+        if(model_->ShouldIndent(model_row))
+        {
+            item.mask |= LVIF_INDENT;
+            item.iIndent = 1;
+        }
+        item.lParam = model_row;
+        ListView_InsertItem(list_view_, &item);
+    }
+
+    void TableView::InsertSortedItems(int start, int length)
+    {
+        const int old_row_count = RowCount();
+        const int row_count = old_row_count + length;
+        PrepareForSort();
+
+        // The existing rows in view order, in the model indices they have now.
+        std::vector<int> old_order(old_row_count);
+        for(int i=0; i<old_row_count; ++i)
+        {
+            int model_index = ViewToModel(i);
+            old_order[i] = model_index>=start ? model_index+length : model_index;
+        }
+        UpdateItemsLParams(start, length);
+
+        std::vector<int> added(length);
+        for(int i=0; i<length; ++i)
+        {
+            added[i] = start + i;
+        }
+        SortedRowLess less(this);
+        std::sort(added.begin(), added.end(), less);
+
+        // Merge the added rows into the existing ones, finding where each goes
+        // by binary search from where the previous one went.
+        std::vector<int> view_to_model(row_count);
+        std::vector<int> added_view_indices(length);
+        int old_index = 0;
+        int view_index = 0;
+        for(int i=0; i<length; ++i)
+        {
+            int low = old_index;
+            int high = old_row_count;
+            while(low < high)
+            {
+                int middle = low + (high - low) / 2;
+                if(less(old_order[middle], added[i]))
+                {
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+            while(old_index < low)
+            {
+                view_to_model[view_index++] = old_order[old_index++];
+            }
+            added_view_indices[i] = view_index;
+            view_to_model[view_index++] = added[i];
+        }
+        while(old_index < old_row_count)
+        {
+            view_to_model[view_index++] = old_order[old_index++];
+        }
+
+        model_to_view_.reset(new int[row_count]);
+        view_to_model_.reset(new int[row_count]);
+        for(int i=0; i<row_count; ++i)
+        {
+            view_to_model_[i] = view_to_model[i];
+            model_to_view_[view_to_model[i]] = i;
+        }
+
+        // Inserting in increasing view order puts each item at its final index.
+        for(int i=0; i<length; ++i)
+        {
+            InsertListViewItem(added_view_indices[i], added[i]);
+        }
+    }
+
     void TableView::OnDoubleClick()
     {
         if(!ignore_listview_change_ && table_view_observer_)
@@ -12,6 +12,7 @@
 #include "SkColor.h"
 
 #include "ui_base/keycodes/keyboard_codes_win.h"
+#include "ui_base/models/batched_table_model_observer.h"
 #include "ui_base/models/table_model_observer.h"
 
 #include "view/controls/native_control.h"
@@ -50,7 +51,10 @@ namespace ui
 // convert to view coordinates use model_to_view.
 //
 // Sorting is done by a locale sensitive string sort. You can customize the
-// sort by way of overriding CompareValues.
+// sort by way of overriding CompareValues, or CompareRows on the view. A model
+// that also provides sort keys (see TableModel::GetSortKey) is sorted by its
+// keys, fetched once per row, as long as CompareRows agrees with that order;
+// otherwise the list view sorts the rows by calling CompareRows.
 //
 // TableView is a wrapper around the window type ListView in report mode.
 namespace view
@@ -287,12 +291,25 @@ namespace view
         // Used to sort the two rows. Returns a value < 0, == 0 or > 0 indicating
         // whether the row2 comes before row1, row2 is the same as row1 or row1 comes
         // after row2. This invokes CompareValues on the model with the sorted column.
+        // Used for full sorts when the model has no sort keys (see
+        // TableModel::GetSortKey) or the key order disagrees with it, to check
+        // the key order, and to place rows added to a sorted table.
         virtual int CompareRows(int model_row1, int model_row2);
 
+        // Returns the row whose group and sort keys |model_row| is sorted by.
+        // Subclasses that override CompareRows to sort rows by another row's
+        // values override this to match.
+        virtual int GetSortKeyRow(int model_row) { return model_row; }
+
         // Called before sorting. This does nothing and is intended for subclasses
         // that need to cache state used during sorting.
         virtual void PrepareForSort() {}
 
+        // Returns true if rows added to a sorted table can be placed among the
+        // existing rows with CompareRows, without resorting. Subclasses whose
+        // order of existing rows can change when rows are added return false.
+        virtual bool CanInsertSorted() { return true; }
+
         // Returns the width of the specified column by id, or -1 if the column isn't
         // visible.
         int GetColumnWidth(int column_id);
@@ -345,6 +362,11 @@ namespace view
         // model_to_view) appropriately.
         void SortItemsAndUpdateMapping();
 
+        // Sorts the rows by the model's sort keys and fills in the mappings.
+        // Returns false, leaving the mappings alone, if the model has no sort
+        // keys for the sorted columns or CompareRows orders the rows otherwise.
+        bool SortByKeysAndUpdateMapping();
+
         // Selects multiple items from the current view row to the marked view row
         // (implements shift-click behavior). |view_index| is the most recent row
         // that the user clicked on, and so there is no guarantee that
@@ -352,6 +374,8 @@ namespace view
         // selection attempt was rejected because it crossed group boundaries.
         bool SelectMultiple(int view_index, int mark_view_index);
 
+        class SortedRowLess;
+
         // Method invoked by ListView to compare the two values. Invokes CompareRows.
         static int CALLBACK SortFunc(LPARAM model_index_1_p,
             LPARAM model_index_2_p, LPARAM table_view_param);
@@ -361,6 +385,11 @@ namespace view
         static int CALLBACK NaturalSortFunc(LPARAM model_index_1_p,
             LPARAM model_index_2_p, LPARAM table_view_param);
 
+        // Method invoked by ListView to move the items to the order already in
+        // model_to_view_. Compares the view indices of the two rows.
+        static int CALLBACK MappedSortFunc(LPARAM model_index_1_p,
+            LPARAM model_index_2_p, LPARAM table_view_param);
+
         // Resets the sort image displayed for the specified column.
         void ResetColumnSortImage(int column_id, SortDirection direction);
 
@@ -382,6 +411,15 @@ namespace view
         // range start - [start + length] are updated from the model.
         void UpdateListViewCache0(int start, int length, bool add);
 
+        // Inserts an item for |model_row| at |view_index| in the ListView, without
+        // any text.
+        void InsertListViewItem(int view_index, int model_row);
+
+        // Inserts the ListView items for the rows [start, start + length) just
+        // added to a sorted table at their sorted positions, found by binary
+        // search among the existing rows, and updates the mappings.
+        void InsertSortedItems(int start, int length);
+
         // Returns the index of the selected item before |view_index|, or -1 if
         // |view_index| is the first selected item.
         //
@@ -487,6 +525,10 @@ namespace view
         scoped_array<int> view_to_model_;
         scoped_array<int> model_to_view_;
 
+        // Collects the model's notifications and passes them to us coalesced,
+        // once per message loop turn.
+        ui::BatchedTableModelObserver model_changes_;
+
         string16 alt_text_;
 
         DISALLOW_COPY_AND_ASSIGN(TableView);
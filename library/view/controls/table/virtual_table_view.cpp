@@ -0,0 +1,778 @@
+#include "virtual_table_view.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+#include "SkBitmap.h"
+
+#include "ui_gfx/canvas_skia.h"
+#include "ui_gfx/color_utils.h"
+#include "ui_gfx/skia_util.h"
+
+#include "ui_base/resource/resource_bundle.h"
+
+#include "table_view_observer.h"
+
+namespace
+{
+
+    // Padding around the text of a cell.
+    const int kTextHorizontalPadding = 4;
+    const int kTextVerticalPadding = 2;
+
+    // Size of the icons drawn for ICON_AND_TEXT tables.
+    const int kIconSize = 16;
+
+    // Columns are never laid out narrower than this.
+    const int kMinColumnWidth = 10;
+
+    int GetTextFlags(ui::TableColumn::Alignment alignment)
+    {
+        switch(alignment)
+        {
+        case ui::TableColumn::RIGHT:
+            return gfx::Canvas::TEXT_ALIGN_RIGHT;
+        case ui::TableColumn::CENTER:
+            return gfx::Canvas::TEXT_ALIGN_CENTER;
+        default:
+            return gfx::Canvas::TEXT_ALIGN_LEFT;
+        }
+    }
+
+}
+
+namespace view
+{
+
+    // Paints the column titles above the table, following its horizontal
+    // scroll position.
+    class VirtualTableView::Header : public View
+    {
+    public:
+        explicit Header(VirtualTableView* table) : table_(table) {}
+
+        virtual gfx::Size GetPreferredSize()
+        {
+            return gfx::Size(table_->GetPreferredSize().width(),
+                table_->row_height());
+        }
+
+    protected:
+        virtual void OnPaint(gfx::Canvas* canvas)
+        {
+            canvas->FillRectInt(gfx::GetSysSkColor(COLOR_BTNFACE),
+                0, 0, width(), height());
+            SkColor line_color = gfx::GetSysSkColor(COLOR_BTNSHADOW);
+            SkColor text_color = gfx::GetSysSkColor(COLOR_BTNTEXT);
+            const std::vector<VisibleColumn>& columns = table_->visible_columns_;
+            for(size_t i=0; i<columns.size(); ++i)
+            {
+                int x = table_->x() + columns[i].x;
+                if(x >= width())
+                {
+                    break;
+                }
+                if(x+columns[i].width <= 0)
+                {
+                    continue;
+                }
+                canvas->DrawStringInt(columns[i].column.title, table_->font_,
+                    text_color, x+kTextHorizontalPadding, 0,
+                    columns[i].width-2*kTextHorizontalPadding, height(),
+                    GetTextFlags(columns[i].column.alignment));
+                canvas->DrawLineInt(line_color, x+columns[i].width-1, 0,
+                    x+columns[i].width-1, height());
+            }
+            canvas->DrawLineInt(line_color, 0, height()-1, width(), height()-1);
+        }
+
+    private:
+        VirtualTableView* table_;
+
+        DISALLOW_COPY_AND_ASSIGN(Header);
+    };
+
+    // Stacks the header above the ScrollView holding the table.
+    class VirtualTableView::Parent : public View
+    {
+    public:
+        Parent(Header* header, ScrollView* scroll_view)
+            : header_(header), scroll_view_(scroll_view)
+        {
+            AddChildView(header_);
+            AddChildView(scroll_view_);
+        }
+
+        virtual void Layout()
+        {
+            int header_height = header_->GetPreferredSize().height();
+            header_->SetBounds(0, 0, width(), header_height);
+            scroll_view_->SetBounds(0, header_height, width(),
+                std::max(0, height()-header_height));
+            scroll_view_->Layout();
+        }
+
+        virtual gfx::Size GetPreferredSize()
+        {
+            gfx::Size size = scroll_view_->GetContents()->GetPreferredSize();
+            size.Enlarge(0, header_->GetPreferredSize().height());
+            return size;
+        }
+
+    private:
+        Header* header_;
+        ScrollView* scroll_view_;
+
+        DISALLOW_COPY_AND_ASSIGN(Parent);
+    };
+
+    // static
+    const char VirtualTableView::kViewClassName[] = "view/VirtualTableView";
+
+    VirtualTableView::VirtualTableView(ui::TableModel* model,
+        const std::vector<ui::TableColumn>& columns,
+        TableTypes table_type,
+        bool single_selection)
+        : model_(NULL),
+        table_type_(table_type),
+        single_selection_(single_selection),
+        observer_(NULL),
+        columns_width_(-1),
+        font_(ui::ResourceBundle::GetSharedInstance().GetFont(
+        ui::ResourceBundle::BaseFont)),
+        focused_row_(-1),
+        anchor_row_(-1),
+        scroll_helper_(this),
+        parent_view_(NULL),
+        header_(NULL),
+        scroll_view_(NULL)
+    {
+        DCHECK(table_type==TEXT_ONLY || table_type==ICON_AND_TEXT);
+        for(size_t i=0; i<columns.size(); ++i)
+        {
+            visible_columns_.push_back(VisibleColumn(columns[i]));
+        }
+        int content_height = font_.GetHeight();
+        if(table_type_ == ICON_AND_TEXT)
+        {
+            content_height = std::max(content_height, kIconSize);
+        }
+        row_height_ = content_height + 2 * kTextVerticalPadding;
+        set_focusable(true);
+        // OnPaint fills every row, so scrolling can move the painted rows.
+        SetFillsBoundsOpaquely(true);
+        SetModel(model);
+    }
+
+    VirtualTableView::~VirtualTableView()
+    {
+        if(model_)
+        {
+            model_->SetObserver(NULL);
+        }
+    }
+
+    View* VirtualTableView::CreateParentIfNecessary()
+    {
+        if(!parent_view_)
+        {
+            scroll_view_ = new ScrollView();
+            scroll_view_->SetContents(this);
+            header_ = new Header(this);
+            parent_view_ = new Parent(header_, scroll_view_);
+        }
+        return parent_view_;
+    }
+
+    void VirtualTableView::SetModel(ui::TableModel* model)
+    {
+        if(model == model_)
+        {
+            return;
+        }
+
+        if(model_)
+        {
+            model_->SetObserver(NULL);
+        }
+        model_ = model;
+        if(model_)
+        {
+            model_->SetObserver(this);
+        }
+        OnModelChanged();
+    }
+
+    int VirtualTableView::RowCount() const
+    {
+        return model_ ? model_->RowCount() : 0;
+    }
+
+    void VirtualTableView::Select(int row)
+    {
+        SchedulePaintForVisibleSelection();
+        selection_.Clear();
+        if(row >= 0)
+        {
+            DCHECK_LT(row, RowCount());
+            selection_.Add(row, row+1);
+            SchedulePaintForRows(row, 1);
+            ScrollRectToVisible(GetRowBounds(row));
+        }
+        SchedulePaintForRows(focused_row_, 1);
+        focused_row_ = row;
+        anchor_row_ = row;
+        NotifySelectionChanged();
+    }
+
+    void VirtualTableView::SetSelectedState(int row, bool state)
+    {
+        DCHECK(row>=0 && row<RowCount());
+        if(state == selection_.Contains(row))
+        {
+            return;
+        }
+
+        if(state)
+        {
+            if(single_selection_)
+            {
+                SchedulePaintForVisibleSelection();
+                selection_.Clear();
+            }
+            selection_.Add(row, row+1);
+        }
+        else
+        {
+            selection_.Remove(row, row+1);
+        }
+        SchedulePaintForRows(row, 1);
+        NotifySelectionChanged();
+    }
+
+    void VirtualTableView::SelectAll()
+    {
+        if(single_selection_ || RowCount()==0)
+        {
+            return;
+        }
+
+        selection_.Clear();
+        selection_.Add(0, RowCount());
+        SchedulePaint();
+        NotifySelectionChanged();
+    }
+
+    void VirtualTableView::ClearSelection()
+    {
+        if(selection_.empty())
+        {
+            return;
+        }
+
+        SchedulePaintForVisibleSelection();
+        selection_.Clear();
+        NotifySelectionChanged();
+    }
+
+    gfx::Rect VirtualTableView::GetRowBounds(int row) const
+    {
+        return gfx::Rect(0, row*row_height_, width(), row_height_);
+    }
+
+    int VirtualTableView::GetRowAt(int y) const
+    {
+        if(y < 0)
+        {
+            return -1;
+        }
+        int row = y / row_height_;
+        return row<RowCount() ? row : -1;
+    }
+
+    void VirtualTableView::Layout()
+    {
+        View* viewport = parent();
+        if(!viewport)
+        {
+            return;
+        }
+
+        if(columns_width_ != viewport->width())
+        {
+            LayoutColumns(viewport->width());
+            if(header_)
+            {
+                header_->SchedulePaint();
+            }
+        }
+        gfx::Size preferred = GetPreferredSize();
+        SetBounds(x(), y(), std::max(viewport->width(), preferred.width()),
+            std::max(viewport->height(), preferred.height()));
+    }
+
+    gfx::Size VirtualTableView::GetPreferredSize()
+    {
+        int width = 0;
+        if(!visible_columns_.empty())
+        {
+            const VisibleColumn& last = visible_columns_.back();
+            width = last.x + last.width;
+        }
+        // The row count is only read here, never the rows themselves.
+        return gfx::Size(width, RowCount()*row_height_);
+    }
+
+    bool VirtualTableView::OnMousePressed(const MouseEvent& event)
+    {
+        RequestFocus();
+
+        int row = GetRowAt(event.y());
+        if(event.IsOnlyLeftMouseButton())
+        {
+            if(row == -1)
+            {
+                return true;
+            }
+            if(event.flags() & ui::EF_IS_DOUBLE_CLICK)
+            {
+                if(observer_)
+                {
+                    observer_->OnDoubleClick();
+                }
+                return true;
+            }
+            SelectByUser(row, event.IsShiftDown(), event.IsControlDown());
+        }
+        else if(event.IsMiddleMouseButton())
+        {
+            if(row!=-1 && observer_)
+            {
+                observer_->OnMiddleClick();
+            }
+        }
+        else if(event.IsOnlyRightMouseButton())
+        {
+            // Right clicking a row outside the selection selects it, so the
+            // context menu applies to the row under the mouse.
+            if(row!=-1 && !IsRowSelected(row))
+            {
+                SelectByUser(row, false, false);
+            }
+        }
+        return true;
+    }
+
+    bool VirtualTableView::OnKeyPressed(const KeyEvent& event)
+    {
+        if(observer_)
+        {
+            observer_->OnKeyDown(event.key_code());
+        }
+
+        int row_count = RowCount();
+        if(row_count == 0)
+        {
+            return false;
+        }
+
+        int page = std::max(1, GetVisibleBounds().height()/row_height_ - 1);
+        int row = focused_row_;
+        switch(event.key_code())
+        {
+        case ui::VKEY_UP:
+            row = row==-1 ? 0 : row-1;
+            break;
+        case ui::VKEY_DOWN:
+            row = row==-1 ? 0 : row+1;
+            break;
+        case ui::VKEY_PRIOR:
+            row = row==-1 ? 0 : row-page;
+            break;
+        case ui::VKEY_NEXT:
+            row = row==-1 ? 0 : row+page;
+            break;
+        case ui::VKEY_HOME:
+            row = 0;
+            break;
+        case ui::VKEY_END:
+            row = row_count - 1;
+            break;
+        case ui::VKEY_SPACE:
+            if(!event.IsControlDown() || focused_row_==-1)
+            {
+                return false;
+            }
+            SetSelectedState(focused_row_, !IsRowSelected(focused_row_));
+            return true;
+        case ui::VKEY_A:
+            if(!event.IsControlDown())
+            {
+                return false;
+            }
+            SelectAll();
+            return true;
+        default:
+            return false;
+        }
+
+        row = std::max(0, std::min(row, row_count-1));
+        if(event.IsControlDown() && !event.IsShiftDown())
+        {
+            // Ctrl moves the focus without changing the selection.
+            SchedulePaintForRows(focused_row_, 1);
+            focused_row_ = row;
+            SchedulePaintForRows(focused_row_, 1);
+            ScrollRectToVisible(GetRowBounds(row));
+        }
+        else
+        {
+            SelectByUser(row, event.IsShiftDown(), false);
+        }
+        return true;
+    }
+
+    int VirtualTableView::GetPageScrollIncrement(ScrollView* scroll_view,
+        bool is_horizontal, bool is_positive)
+    {
+        return scroll_helper_.GetPageScrollIncrement(scroll_view,
+            is_horizontal, is_positive);
+    }
+
+    int VirtualTableView::GetLineScrollIncrement(ScrollView* scroll_view,
+        bool is_horizontal, bool is_positive)
+    {
+        return scroll_helper_.GetLineScrollIncrement(scroll_view,
+            is_horizontal, is_positive);
+    }
+
+    std::string VirtualTableView::GetClassName() const
+    {
+        return kViewClassName;
+    }
+
+    void VirtualTableView::OnModelChanged()
+    {
+        selection_.Clear();
+        focused_row_ = -1;
+        anchor_row_ = -1;
+        RowCountChanged();
+        NotifySelectionChanged();
+    }
+
+    void VirtualTableView::OnItemsChanged(int start, int length)
+    {
+        if(length == -1)
+        {
+            DCHECK_GE(start, 0);
+            length = RowCount() - start;
+        }
+        SchedulePaintForRows(start, length);
+    }
+
+    void VirtualTableView::OnItemsAdded(int start, int length)
+    {
+        selection_.ItemsAdded(start, length);
+        if(focused_row_ >= start)
+        {
+            focused_row_ += length;
+        }
+        if(anchor_row_ >= start)
+        {
+            anchor_row_ += length;
+        }
+        RowCountChanged();
+    }
+
+    void VirtualTableView::OnItemsRemoved(int start, int length)
+    {
+        bool had_selection = !selection_.empty();
+        selection_.ItemsRemoved(start, length);
+        if(focused_row_ >= start+length)
+        {
+            focused_row_ -= length;
+        }
+        else if(focused_row_ >= start)
+        {
+            focused_row_ = -1;
+        }
+        if(anchor_row_ >= start+length)
+        {
+            anchor_row_ -= length;
+        }
+        else if(anchor_row_ >= start)
+        {
+            anchor_row_ = focused_row_;
+        }
+        RowCountChanged();
+        if(had_selection)
+        {
+            NotifySelectionChanged();
+        }
+    }
+
+    VariableRowHeightScrollHelper::RowInfo VirtualTableView::GetRowInfo(int y)
+    {
+        int row = std::max(0, y) / row_height_;
+        return VariableRowHeightScrollHelper::RowInfo(row*row_height_,
+            row_height_);
+    }
+
+    void VirtualTableView::OnPaint(gfx::Canvas* canvas)
+    {
+        gfx::Rect clip = GetLocalBounds();
+        SkRect sk_clip;
+        if(canvas->AsCanvasSkia()->getClipBounds(&sk_clip))
+        {
+            clip = clip.Intersect(gfx::SkRectToRect(sk_clip));
+        }
+        if(clip.IsEmpty())
+        {
+            return;
+        }
+
+        canvas->FillRectInt(gfx::GetSysSkColor(COLOR_WINDOW),
+            clip.x(), clip.y(), clip.width(), clip.height());
+
+        // Only the rows inside the clip are asked for, whatever the row count.
+        int start, end;
+        GetRowRange(clip.y(), clip.height(), &start, &end);
+        for(int row=start; row<end; ++row)
+        {
+            PaintRow(canvas, row, clip);
+        }
+
+        if(HasFocus() && focused_row_>=start && focused_row_<end)
+        {
+            gfx::Rect bounds = GetRowBounds(focused_row_);
+            canvas->DrawFocusRect(bounds.x(), bounds.y(), bounds.width(),
+                bounds.height());
+        }
+    }
+
+    void VirtualTableView::OnFocus()
+    {
+        View::OnFocus();
+        SchedulePaintForVisibleSelection();
+        SchedulePaintForRows(focused_row_, 1);
+    }
+
+    void VirtualTableView::OnBlur()
+    {
+        View::OnBlur();
+        SchedulePaintForVisibleSelection();
+        SchedulePaintForRows(focused_row_, 1);
+    }
+
+    void VirtualTableView::OnBoundsChanged(const gfx::Rect& previous_bounds)
+    {
+        // The header follows the horizontal scroll position.
+        if(header_ && x()!=previous_bounds.x())
+        {
+            header_->SchedulePaint();
+        }
+    }
+
+    void VirtualTableView::LayoutColumns(int width)
+    {
+        columns_width_ = width;
+
+        // Fixed width and autosized columns first, then the percentages share
+        // what is left.
+        int used_width = 0;
+        float total_percent = 0;
+        for(size_t i=0; i<visible_columns_.size(); ++i)
+        {
+            VisibleColumn& visible = visible_columns_[i];
+            const ui::TableColumn& column = visible.column;
+            if(column.width > 0)
+            {
+                visible.width = column.width;
+            }
+            else if(column.percent > 0)
+            {
+                visible.width = 0;
+                total_percent += column.percent;
+                continue;
+            }
+            else
+            {
+                visible.width = font_.GetStringWidth(column.title) +
+                    2 * kTextHorizontalPadding;
+            }
+            visible.width = std::max(visible.width, column.min_visible_width);
+            used_width += visible.width;
+        }
+
+        int available_width = std::max(0, width-used_width);
+        int x = 0;
+        for(size_t i=0; i<visible_columns_.size(); ++i)
+        {
+            VisibleColumn& visible = visible_columns_[i];
+            if(visible.column.width<=0 && visible.column.percent>0)
+            {
+                visible.width = std::max(visible.column.min_visible_width,
+                    static_cast<int>(available_width *
+                    visible.column.percent / total_percent));
+            }
+            visible.width = std::max(visible.width, kMinColumnWidth);
+            visible.x = x;
+            x += visible.width;
+        }
+    }
+
+    void VirtualTableView::GetRowRange(int y, int height,
+        int* start, int* end) const
+    {
+        int row_count = RowCount();
+        *start = std::max(0, std::min(y/row_height_, row_count));
+        *end = std::max(*start,
+            std::min((y+height+row_height_-1)/row_height_, row_count));
+    }
+
+    void VirtualTableView::PaintRow(gfx::Canvas* canvas, int row,
+        const gfx::Rect& clip)
+    {
+        gfx::Rect bounds = GetRowBounds(row);
+        bool selected = IsRowSelected(row);
+        if(selected)
+        {
+            canvas->FillRectInt(gfx::GetSysSkColor(
+                HasFocus() ? COLOR_HIGHLIGHT : COLOR_BTNFACE),
+                bounds.x(), bounds.y(), bounds.width(), bounds.height());
+        }
+        SkColor text_color = gfx::GetSysSkColor(
+            (selected && HasFocus()) ? COLOR_HIGHLIGHTTEXT : COLOR_WINDOWTEXT);
+
+        for(size_t i=0; i<visible_columns_.size(); ++i)
+        {
+            const VisibleColumn& visible = visible_columns_[i];
+            if(visible.x >= clip.right())
+            {
+                break;
+            }
+            if(visible.x+visible.width <= clip.x())
+            {
+                continue;
+            }
+
+            int text_x = visible.x + kTextHorizontalPadding;
+            if(i==0 && table_type_==ICON_AND_TEXT)
+            {
+                SkBitmap icon = model_->GetIcon(row);
+                if(!icon.isNull())
+                {
+                    canvas->DrawBitmapInt(icon, 0, 0, icon.width(),
+                        icon.height(), text_x,
+                        bounds.y()+(bounds.height()-kIconSize)/2,
+                        kIconSize, kIconSize, true);
+                }
+                text_x += kIconSize + kTextHorizontalPadding;
+            }
+            int text_width = visible.x + visible.width - kTextHorizontalPadding -
+                text_x;
+            if(text_width > 0)
+            {
+                canvas->DrawStringInt(model_->GetText(row, visible.column.id),
+                    font_, text_color, text_x, bounds.y(), text_width,
+                    bounds.height(), GetTextFlags(visible.column.alignment));
+            }
+        }
+    }
+
+    void VirtualTableView::SchedulePaintForRows(int start, int length)
+    {
+        if(start<0 || length<=0)
+        {
+            return;
+        }
+        SchedulePaintInRect(gfx::Rect(0, start*row_height_, width(),
+            length*row_height_).Intersect(GetVisibleBounds()));
+    }
+
+    void VirtualTableView::SchedulePaintForVisibleSelection()
+    {
+        gfx::Rect visible = GetVisibleBounds();
+        int start, end;
+        GetRowRange(visible.y(), visible.height(), &start, &end);
+        const TableSelectionRanges::Ranges& ranges = selection_.ranges();
+        for(size_t i=0; i<ranges.size(); ++i)
+        {
+            if(ranges[i].start >= end)
+            {
+                break;
+            }
+            int first = std::max(start, ranges[i].start);
+            int last = std::min(end, ranges[i].end);
+            if(first < last)
+            {
+                SchedulePaintForRows(first, last-first);
+            }
+        }
+    }
+
+    void VirtualTableView::SelectByUser(int row, bool extend, bool toggle)
+    {
+        DCHECK(row>=0 && row<RowCount());
+        if(single_selection_)
+        {
+            extend = false;
+            toggle = false;
+        }
+
+        SchedulePaintForRows(focused_row_, 1);
+        if(extend && anchor_row_!=-1)
+        {
+            SchedulePaintForVisibleSelection();
+            selection_.Clear();
+            selection_.Add(std::min(anchor_row_, row),
+                std::max(anchor_row_, row)+1);
+            SchedulePaintForVisibleSelection();
+        }
+        else if(toggle)
+        {
+            if(IsRowSelected(row))
+            {
+                selection_.Remove(row, row+1);
+            }
+            else
+            {
+                selection_.Add(row, row+1);
+            }
+            anchor_row_ = row;
+        }
+        else
+        {
+            SchedulePaintForVisibleSelection();
+            selection_.Clear();
+            selection_.Add(row, row+1);
+            anchor_row_ = row;
+        }
+        focused_row_ = row;
+        SchedulePaintForRows(row, 1);
+        ScrollRectToVisible(GetRowBounds(row));
+        NotifySelectionChanged();
+    }
+
+    void VirtualTableView::RowCountChanged()
+    {
+        PreferredSizeChanged();
+        if(scroll_view_)
+        {
+            // Contents of a ScrollView aren't laid out again by
+            // PreferredSizeChanged.
+            scroll_view_->Layout();
+        }
+        SchedulePaint();
+    }
+
+    void VirtualTableView::NotifySelectionChanged()
+    {
+        if(observer_)
+        {
+            observer_->OnSelectionChanged();
+        }
+    }
+
+} //namespace view
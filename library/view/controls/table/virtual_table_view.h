@@ -0,0 +1,204 @@
+#ifndef __view_virtual_table_view_h__
+#define __view_virtual_table_view_h__
+
+#pragma once
+
+#include <vector>
+
+#include "ui_gfx/font.h"
+
+#include "ui_base/models/table_model.h"
+#include "ui_base/models/table_model_observer.h"
+
+#include "table_selection_ranges.h"
+#include "table_view.h"
+#include "view/controls/scroll_view.h"
+
+namespace view
+{
+
+    class TableViewObserver;
+
+    // A VirtualTableView displays the rows of a TableModel like TableView, but
+    // draws them itself instead of wrapping a ListView. Only the rows in the
+    // visible part of the enclosing ScrollView are requested from the model and
+    // painted, and the selection is kept as ranges of rows, so scrolling,
+    // painting and model updates cost the same however many rows the model has.
+    //
+    // All rows have the same height. Columns are sized as described for
+    // ui::TableColumn: fixed widths first, then percentages of what is left,
+    // with autosized columns as wide as their title. There is no sorting; rows
+    // show in model order, so model and view indices are the same.
+    //
+    // Add the view returned by CreateParentIfNecessary to the hierarchy, not the
+    // table itself.
+    class VirtualTableView : public View,
+        public ui::TableModelObserver,
+        public VariableRowHeightScrollHelper::Controller
+    {
+    public:
+        // The view class name.
+        static const char kViewClassName[];
+
+        // Only TEXT_ONLY and ICON_AND_TEXT are supported.
+        VirtualTableView(ui::TableModel* model,
+            const std::vector<ui::TableColumn>& columns,
+            TableTypes table_type,
+            bool single_selection);
+        virtual ~VirtualTableView();
+
+        // Returns the view to add to the hierarchy: a ScrollView containing the
+        // table, below a header showing the column titles. Created on the first
+        // call.
+        View* CreateParentIfNecessary();
+
+        // Assigns a new model to the table view, detaching the old one if
+        // present. If |model| is NULL, the table view cannot be used after this
+        // call.
+        void SetModel(ui::TableModel* model);
+        ui::TableModel* model() const { return model_; }
+
+        void SetObserver(TableViewObserver* observer) { observer_ = observer; }
+        TableViewObserver* observer() const { return observer_; }
+
+        // Returns the number of rows in the model.
+        int RowCount() const;
+
+        // Selection ---------------------------------------------------------------
+
+        // Selects |row|, clearing any other selection, makes it the focused row
+        // and scrolls it into view. A |row| of -1 clears the selection.
+        void Select(int row);
+
+        // Adds or removes |row| from the selection.
+        void SetSelectedState(int row, bool state);
+
+        // Selects every row. Does nothing for single selection tables.
+        void SelectAll();
+
+        // Clears the selection.
+        void ClearSelection();
+
+        bool IsRowSelected(int row) const { return selection_.Contains(row); }
+        int SelectedRowCount() const { return selection_.GetCount(); }
+
+        // Returns the first selected row, or -1 if nothing is selected.
+        int FirstSelectedRow() const { return selection_.GetFirst(); }
+
+        const TableSelectionRanges& selection() const { return selection_; }
+
+        // The row that has the focus rectangle and keyboard navigation starts
+        // from, or -1.
+        int focused_row() const { return focused_row_; }
+
+        // Geometry ----------------------------------------------------------------
+
+        int row_height() const { return row_height_; }
+
+        // Returns the bounds of |row| in the coordinates of the table.
+        gfx::Rect GetRowBounds(int row) const;
+
+        // Returns the row at |y|, or -1 if there is none.
+        int GetRowAt(int y) const;
+
+        // View overrides.
+        virtual void Layout();
+        virtual gfx::Size GetPreferredSize();
+        virtual bool OnMousePressed(const MouseEvent& event);
+        virtual bool OnKeyPressed(const KeyEvent& event);
+        virtual int GetPageScrollIncrement(ScrollView* scroll_view,
+            bool is_horizontal, bool is_positive);
+        virtual int GetLineScrollIncrement(ScrollView* scroll_view,
+            bool is_horizontal, bool is_positive);
+        virtual std::string GetClassName() const;
+
+        // ui::TableModelObserver overrides.
+        virtual void OnModelChanged();
+        virtual void OnItemsChanged(int start, int length);
+        virtual void OnItemsAdded(int start, int length);
+        virtual void OnItemsRemoved(int start, int length);
+
+        // VariableRowHeightScrollHelper::Controller override.
+        virtual VariableRowHeightScrollHelper::RowInfo GetRowInfo(int y);
+
+    protected:
+        // View overrides.
+        virtual void OnPaint(gfx::Canvas* canvas);
+        virtual void OnFocus();
+        virtual void OnBlur();
+        virtual void OnBoundsChanged(const gfx::Rect& previous_bounds);
+
+    private:
+        class Header;
+        class Parent;
+
+        // A column with its position from the last layout.
+        struct VisibleColumn
+        {
+            VisibleColumn(const ui::TableColumn& column)
+                : column(column), x(0), width(0) {}
+
+            ui::TableColumn column;
+            int x;
+            int width;
+        };
+
+        // Computes the x and width of each column to fill |width|.
+        void LayoutColumns(int width);
+
+        // Sets |start| and |end| to the rows [start, end) intersecting the band
+        // [y, y + height).
+        void GetRowRange(int y, int height, int* start, int* end) const;
+
+        // Paints |row| into |canvas|, only the columns that intersect |clip|.
+        void PaintRow(gfx::Canvas* canvas, int row, const gfx::Rect& clip);
+
+        // Schedules a paint of the rows [start, start + length).
+        void SchedulePaintForRows(int start, int length);
+
+        // Schedules a paint of the selected rows that are visible.
+        void SchedulePaintForVisibleSelection();
+
+        // Moves the focused row to |row| and scrolls it into view. With |extend|
+        // the selection becomes the rows from the anchor to |row|, with |toggle|
+        // |row|'s selected state flips, otherwise |row| alone is selected.
+        void SelectByUser(int row, bool extend, bool toggle);
+
+        // Updates the size of the table and the scroll view after the row count
+        // changed.
+        void RowCountChanged();
+
+        void NotifySelectionChanged();
+
+        ui::TableModel* model_;
+        TableTypes table_type_;
+        bool single_selection_;
+        TableViewObserver* observer_;
+
+        std::vector<VisibleColumn> visible_columns_;
+
+        // Width the columns were last laid out for.
+        int columns_width_;
+
+        gfx::Font font_;
+        int row_height_;
+
+        TableSelectionRanges selection_;
+        int focused_row_;
+
+        // The row shift-click and shift-arrow selections extend from.
+        int anchor_row_;
+
+        VariableRowHeightScrollHelper scroll_helper_;
+
+        // Created by CreateParentIfNecessary, owned by the view hierarchy.
+        Parent* parent_view_;
+        Header* header_;
+        ScrollView* scroll_view_;
+
+        DISALLOW_COPY_AND_ASSIGN(VirtualTableView);
+    };
+
+} //namespace view
+
+#endif //__view_virtual_table_view_h__
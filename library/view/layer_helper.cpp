@@ -14,8 +14,7 @@ namespace view
     {
 
         LayerHelper::LayerHelper()
-            : fills_bounds_opaquely_(false),
-            paint_to_layer_(false),
+            : paint_to_layer_(false),
             property_setter_explicitly_set_(false),
             needs_paint_all_(true) {}
 
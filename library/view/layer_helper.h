@@ -66,13 +66,6 @@ namespace view
             void set_paint_to_layer(bool value) { paint_to_layer_ = value; }
             bool paint_to_layer() const { return paint_to_layer_; }
 
-            // See description in View for details
-            void set_fills_bounds_opaquely(bool fills_bounds_opaquely)
-            {
-                fills_bounds_opaquely_ = fills_bounds_opaquely;
-            }
-            bool fills_bounds_opaquely() const { return fills_bounds_opaquely_; }
-
             void SetPropertySetter(LayerPropertySetter* setter);
             LayerPropertySetter* property_setter()
             {
@@ -106,8 +99,6 @@ namespace view
             // TODO(sky): this should be passed into paint.
             gfx::Rect clip_rect_;
 
-            bool fills_bounds_opaquely_;
-
             // Should the View paint to a layer?
             bool paint_to_layer_;
 
@@ -1145,6 +1145,8 @@ namespace view
         rows_.push_back(row);
         current_row_col_set_ = row->column_set();
         SkipPaddingColumns();
+        // A size the host cached before doesn't have the new row.
+        host_->InvalidateLayout();
     }
 
     void GridLayout::UpdateRemainingHeightFromRows(ViewState* view_state)
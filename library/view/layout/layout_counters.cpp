@@ -0,0 +1,15 @@
+#include "layout_counters.h"
+
+namespace view
+{
+
+    // static
+    LayoutCounters::Counts LayoutCounters::counts_;
+
+    // static
+    void LayoutCounters::Reset()
+    {
+        counts_ = Counts();
+    }
+
+} //namespace view
@@ -0,0 +1,47 @@
+#ifndef __view_layout_counters_h__
+#define __view_layout_counters_h__
+
+#pragma once
+
+#include "base/basic_types.h"
+
+namespace view
+{
+
+    // Counts the layout work done by Views on the UI thread. RootView takes the
+    // counts at every frame it paints and starts them over, so they measure the
+    // work between two frames; tests read and reset them directly.
+    class LayoutCounters
+    {
+    public:
+        struct Counts
+        {
+            Counts() : layouts(0), preferred_sizes(0), preferred_size_hits(0) {}
+
+            // Calls to View::Layout.
+            int layouts;
+
+            // Preferred sizes and heights for a width computed by a LayoutManager.
+            int preferred_sizes;
+
+            // Preferred sizes and heights for a width a View answered from its
+            // cache.
+            int preferred_size_hits;
+        };
+
+        static const Counts& counts() { return counts_; }
+        static void Reset();
+
+        static void RecordLayout() { ++counts_.layouts; }
+        static void RecordPreferredSize() { ++counts_.preferred_sizes; }
+        static void RecordPreferredSizeHit() { ++counts_.preferred_size_hits; }
+
+    private:
+        static Counts counts_;
+
+        DISALLOW_IMPLICIT_CONSTRUCTORS(LayoutCounters);
+    };
+
+} //namespace view
+
+#endif //__view_layout_counters_h__
@@ -2,7 +2,8 @@
 #include "view.h"
 
 #include "base/message_loop.h"
-#include "base/win/scoped_gdi_object.h"
+
+#include "SkRegion.h"
 
 #include "ui_gfx/canvas_skia.h"
 #include "ui_gfx/path.h"
@@ -14,9 +15,11 @@
 #include "ui_base/dragdrop/drag_drop_types.h"
 
 #include "accessibility/native_view_accessibility_win.h"
+#include "child_hit_test_index.h"
 #include "context_menu_controller.h"
 #include "drag_controller.h"
 #include "layer_property_setter.h"
+#include "layout/layout_counters.h"
 #include "layout/layout_manager.h"
 #include "widget/root_view.h"
 #include "widget/tooltip_manager.h"
@@ -98,10 +101,16 @@ namespace view
         visible_(true),
         enabled_(true),
         painting_enabled_(true),
+        fills_bounds_opaquely_(false),
         registered_for_visible_bounds_notification_(false),
         clip_x_(0.0),
         clip_y_(0.0),
         needs_layout_(true),
+        preferred_size_valid_(false),
+        height_for_width_width_(-1),
+        height_for_width_(0),
+        paint_cache_enabled_(false),
+        paint_cache_valid_(false),
         flip_canvas_on_paint_for_rtl_ui_(false),
         accelerator_registration_delayed_(false),
         accelerator_focus_manager_(NULL),
@@ -170,6 +179,11 @@ namespace view
         // Let's insert the view.
         view->parent_ = this;
         children_.insert(children_.begin()+index, view);
+        InvalidatePaintCache();
+        if(child_hit_test_index_.get())
+        {
+            child_hit_test_index_->Invalidate();
+        }
 
         if(GetWidget())
         {
@@ -232,6 +246,13 @@ namespace view
         // Add it in the specified index now.
         InitFocusSiblings(view, index);
         children_.insert(children_.begin()+index, view);
+
+        // The paint order changed, which a cached painting does not know about.
+        InvalidatePaintCache();
+        if(child_hit_test_index_.get())
+        {
+            child_hit_test_index_->Invalidate();
+        }
     }
 
     void View::RemoveChildView(View* view)
@@ -398,11 +419,22 @@ namespace view
 
     gfx::Size View::GetPreferredSize()
     {
-        if(layout_manager_.get())
+        if(!layout_manager_.get())
         {
-            return layout_manager_->GetPreferredSize(this);
+            return gfx::Size();
         }
-        return gfx::Size();
+
+        if(preferred_size_valid_)
+        {
+            LayoutCounters::RecordPreferredSizeHit();
+        }
+        else
+        {
+            LayoutCounters::RecordPreferredSize();
+            preferred_size_ = layout_manager_->GetPreferredSize(this);
+            preferred_size_valid_ = true;
+        }
+        return preferred_size_;
     }
 
     int View::GetBaseline()
@@ -426,11 +458,22 @@ namespace view
 
     int View::GetHeightForWidth(int w)
     {
-        if(layout_manager_.get())
+        if(!layout_manager_.get())
+        {
+            return GetPreferredSize().height();
+        }
+
+        if(height_for_width_width_ == w)
+        {
+            LayoutCounters::RecordPreferredSizeHit();
+        }
+        else
         {
-            return layout_manager_->GetPreferredHeightForWidth(this, w);
+            LayoutCounters::RecordPreferredSize();
+            height_for_width_ = layout_manager_->GetPreferredHeightForWidth(this, w);
+            height_for_width_width_ = w;
         }
-        return GetPreferredSize().height();
+        return height_for_width_;
     }
 
     void View::SetVisible(bool visible)
@@ -460,6 +503,12 @@ namespace view
             // This notifies all sub-views recursively.
             PropagateVisibilityNotifications(this, visible_);
 
+            // Layout managers leave hidden children out.
+            if(parent_)
+            {
+                parent_->InvalidatePreferredSize();
+            }
+
             // If we are newly visible, schedule paint.
             if(IsVisible())
             {
@@ -507,6 +556,12 @@ namespace view
 
     void View::SetTransform(const gfx::Transform& transform)
     {
+        if(parent_ && parent_->child_hit_test_index_.get())
+        {
+            // Transformed children are hit tested outside the grid.
+            parent_->child_hit_test_index_->Invalidate();
+        }
+
         if(!transform.HasChange())
         {
             if(!layer_helper_.get() || !this->transform())
@@ -638,6 +693,7 @@ namespace view
 
     void View::Layout()
     {
+        LayoutCounters::RecordLayout();
         needs_layout_ = false;
 
         // If we have a layout manager, let it handle the layout for us.
@@ -668,6 +724,8 @@ namespace view
         // Always invalidate up. This is needed to handle the case of us already being
         // valid, but not our parent.
         needs_layout_ = true;
+        preferred_size_valid_ = false;
+        height_for_width_width_ = -1;
         if(parent_)
         {
             parent_->InvalidateLayout();
@@ -691,6 +749,7 @@ namespace view
         {
             layout_manager_->Installed(this);
         }
+        InvalidatePreferredSize();
     }
 
     // Attributes ------------------------------------------------------------------
@@ -875,7 +934,16 @@ namespace view
 
     void View::SchedulePaintInRect(const gfx::Rect& rect)
     {
-        if(!IsVisible() || !painting_enabled_)
+        // Ancestors are invalidated as the request propagates up below. While
+        // painting is disabled nothing propagates, so do it explicitly.
+        paint_cache_valid_ = false;
+        if(!painting_enabled_)
+        {
+            InvalidatePaintCache();
+            return;
+        }
+
+        if(!IsVisible())
         {
             return;
         }
@@ -892,6 +960,40 @@ namespace view
         }
     }
 
+    bool View::ScrollPaintedRect(const gfx::Rect& rect, int dx, int dy)
+    {
+        // Ancestors' paint caches hold the old pixels, and a horizontal move is
+        // mirrored on the way up in RTL.
+        if(!painting_enabled_ || !IsVisible() || !parent_ || layer() ||
+            transform() || paint_cache_enabled_ || (dx!=0 && base::i18n::IsRTL()))
+        {
+            return false;
+        }
+
+        // The parent clips its children to its bounds, so only the part of the
+        // rect inside them is on screen. Moving the pixels outside would drag
+        // in whatever the ancestors' neighbours painted there.
+        gfx::Rect parent_rect = parent_->GetLocalBounds().Intersect(
+            ConvertRectToParent(rect));
+        if(parent_rect.IsEmpty())
+        {
+            return false;
+        }
+
+        // Views painted after this one, such as overlays, are drawn over the
+        // rect; their pixels would move along and never be repainted.
+        for(int i=parent_->GetIndexOf(this)+1; i<parent_->child_count(); ++i)
+        {
+            const View* sibling = parent_->child_at(i);
+            if(sibling->IsVisible() && sibling->ConvertRectToParent(
+                sibling->GetLocalBounds()).Intersects(parent_rect))
+            {
+                return false;
+            }
+        }
+        return parent_->ScrollPaintedRect(parent_rect, dx, dy);
+    }
+
     void View::Paint(gfx::Canvas* canvas)
     {
         ScopedCanvas scoped_canvas(canvas);
@@ -918,7 +1020,29 @@ namespace view
             canvas->ConcatTransform(*transform());
         }
 
-        PaintCommon(canvas);
+        if(paint_cache_enabled_ && fills_bounds_opaquely())
+        {
+            PaintFromCache(canvas);
+        }
+        else
+        {
+            PaintCommon(canvas);
+        }
+    }
+
+    void View::SetPaintCacheEnabled(bool enabled)
+    {
+        if(paint_cache_enabled_ == enabled)
+        {
+            return;
+        }
+
+        paint_cache_enabled_ = enabled;
+        paint_cache_valid_ = false;
+        if(!enabled)
+        {
+            paint_cache_.reset();
+        }
     }
 
     ui::ThemeProvider* View::GetThemeProvider() const
@@ -945,6 +1069,19 @@ namespace view
 
     View* View::GetEventHandlerForPoint(const gfx::Point& point)
     {
+        View* hit_child;
+        if(child_hit_test_index_.get() &&
+            child_hit_test_index_->GetChildForPoint(point, &hit_child))
+        {
+            if(!hit_child)
+            {
+                return this;
+            }
+            gfx::Point point_in_child_coords(point);
+            View::ConvertPointToView(this, hit_child, &point_in_child_coords);
+            return hit_child->GetEventHandlerForPoint(point_in_child_coords);
+        }
+
         // Walk the child Views recursively looking for the View that most
         // tightly encloses the specified point.
         for(int i=child_count()-1; i>=0; --i)
@@ -965,6 +1102,18 @@ namespace view
         return this;
     }
 
+    void View::SetChildHitTestIndexEnabled(bool enabled)
+    {
+        if(!enabled)
+        {
+            child_hit_test_index_.reset();
+        }
+        else if(!child_hit_test_index_.get())
+        {
+            child_hit_test_index_.reset(new internal::ChildHitTestIndex(this));
+        }
+    }
+
     bool View::OnSetCursor(const gfx::Point& p)
     {
         return false;
@@ -976,11 +1125,16 @@ namespace view
         {
             if(HasHitTestMask())
             {
-                gfx::Path mask;
-                GetHitTestMask(&mask);
-                // TODO: can this use SkRegion's contains instead?
-                base::win::ScopedRegion rgn(mask.CreateNativeRegion());
-                return !!PtInRegion(rgn, l.x(), l.y());
+                if(!hit_test_mask_.get())
+                {
+                    gfx::Path mask;
+                    GetHitTestMask(&mask);
+                    SkRegion clip;
+                    clip.setRect(0, 0, width(), height());
+                    hit_test_mask_.reset(new SkRegion);
+                    hit_test_mask_->setPath(mask, clip);
+                }
+                return hit_test_mask_->contains(l.x(), l.y());
             }
             // No mask, but inside our bounds.
             return true;
@@ -1368,12 +1522,7 @@ namespace view
 
     void View::SetFillsBoundsOpaquely(bool fills_bounds_opaquely)
     {
-        if(!layer_helper_.get())
-        {
-            layer_helper_.reset(new internal::LayerHelper());
-        }
-
-        layer_helper_->set_fills_bounds_opaquely(fills_bounds_opaquely);
+        fills_bounds_opaquely_ = fills_bounds_opaquely;
 
         if(layer())
         {
@@ -1520,6 +1669,11 @@ namespace view
         DCHECK(mask);
     }
 
+    void View::InvalidateHitTestMask()
+    {
+        hit_test_mask_.reset();
+    }
+
     // Focus -----------------------------------------------------------------------
 
     bool View::IsFocusable() const
@@ -1683,6 +1837,41 @@ namespace view
         PaintChildren(canvas);
     }
 
+    void View::PaintFromCache(gfx::Canvas* canvas)
+    {
+        if(!IsVisible() || !painting_enabled_ || bounds_.IsEmpty())
+        {
+            return;
+        }
+
+        if(!paint_cache_.get() ||
+            paint_cache_->getDevice()->width()!=width() ||
+            paint_cache_->getDevice()->height()!=height())
+        {
+            paint_cache_.reset(new gfx::CanvasSkia(width(), height(), true));
+            paint_cache_valid_ = false;
+        }
+
+        if(!paint_cache_valid_)
+        {
+            // The cache is rendered without the clip of the current paint, so it
+            // holds the whole View no matter which part was damaged. The View
+            // covers every pixel, so there is nothing to clear first.
+            PaintCommon(paint_cache_.get());
+            paint_cache_valid_ = true;
+        }
+
+        canvas->DrawBitmapInt(paint_cache_->getDevice()->accessBitmap(false), 0, 0);
+    }
+
+    void View::InvalidatePaintCache()
+    {
+        for(View* v=this; v; v=v->parent_)
+        {
+            v->paint_cache_valid_ = false;
+        }
+    }
+
     // Tree operations -------------------------------------------------------------
 
     void View::DoRemoveChildView(View* view,
@@ -1724,6 +1913,11 @@ namespace view
             }
 
             children_.erase(i);
+            InvalidatePaintCache();
+            if(child_hit_test_index_.get())
+            {
+                child_hit_test_index_->Invalidate();
+            }
         }
 
         if(update_tool_tip)
@@ -1801,10 +1995,23 @@ namespace view
 
         ViewHierarchyChanged(is_add, parent, child);
         parent->needs_layout_ = true;
+        parent->InvalidatePreferredSize();
     }
 
     // Size and disposition --------------------------------------------------------
 
+    void View::InvalidatePreferredSize()
+    {
+        // Always invalidate up, as InvalidateLayout() does. A View that
+        // overrides GetPreferredSize() never fills its own cache, so finding an
+        // invalid cache says nothing about the ancestors above it.
+        for(View* view=this; view; view=view->parent_)
+        {
+            view->preferred_size_valid_ = false;
+            view->height_for_width_width_ = -1;
+        }
+    }
+
     void View::PropagateVisibilityNotifications(View* start, bool is_visible)
     {
         for(int i=0,count=child_count(); i<count; ++i)
@@ -1829,6 +2036,20 @@ namespace view
 
     void View::BoundsChanged(const gfx::Rect& previous_bounds)
     {
+        if(parent_ && parent_->child_hit_test_index_.get())
+        {
+            parent_->child_hit_test_index_->ChildBoundsChanged(this,
+                previous_bounds);
+        }
+        if(previous_bounds.size() != size())
+        {
+            InvalidateHitTestMask();
+            if(child_hit_test_index_.get())
+            {
+                child_hit_test_index_->Invalidate();
+            }
+        }
+
         if(IsVisible())
         {
             // Paint the new bounds.
@@ -2087,7 +2308,7 @@ namespace view
 
         layer_helper_->SetLayer(new ui::Layer(compositor));
         layer()->set_delegate(this);
-        layer()->SetFillsBoundsOpaquely(layer_helper_->fills_bounds_opaquely());
+        layer()->SetFillsBoundsOpaquely(fills_bounds_opaquely_);
         layer()->SetBounds(gfx::Rect(offset.x(), offset.y(), width(), height()));
         layer()->SetTransform(GetTransform());
         if(layer_parent)
@@ -2130,7 +2351,6 @@ namespace view
 
         if(!layer_helper_->property_setter_explicitly_set() &&
             !ShouldPaintToLayer() &&
-            !layer_helper_->fills_bounds_opaquely() &&
             !layer_helper_->layer_updated_externally())
         {
             layer_helper_.reset();
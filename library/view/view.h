@@ -30,6 +30,7 @@
 namespace gfx
 {
     class Canvas;
+    class CanvasSkia;
     class Insets;
     class Path;
     class Transform;
@@ -45,6 +46,7 @@ namespace ui
 }
 
 class NativeViewAccessibilityWin;
+class SkRegion;
 
 namespace view
 {
@@ -60,6 +62,7 @@ namespace view
 
     namespace internal
     {
+        class ChildHitTestIndex;
         class NativeWidgetView;
         class RootView;
     }
@@ -223,6 +226,8 @@ namespace view
         virtual int GetBaseline();
 
         // Get the size the View would like to be, if enough space were available.
+        // View's implementation asks the LayoutManager and keeps the answer (and
+        // the last GetHeightForWidth answer) until the layout is invalidated.
         virtual gfx::Size GetPreferredSize();
 
         // Convenience method that sizes this view to its preferred size.
@@ -259,8 +264,10 @@ namespace view
         // This indicates that the view completely fills its bounds in an opaque
         // color.
         // This doesn't affect compositing but is a hint to the compositor to optimize
-        // painting.
+        // painting. A ScrollView also scrolls opaque contents by moving the pixels
+        // already painted, see ScrollPaintedRect.
         void SetFillsBoundsOpaquely(bool fills_bounds_opaquely);
+        bool fills_bounds_opaquely() const { return fills_bounds_opaquely_; }
 
         // Transformations -----------------------------------------------------------
 
@@ -465,19 +472,47 @@ namespace view
         virtual void SchedulePaint();
         virtual void SchedulePaintInRect(const gfx::Rect& r);
 
+        // Moves the pixels already painted for |rect| (in the View's coordinates)
+        // by |dx|, |dy| in the Widget's backing store, and schedules a paint of the
+        // part of |rect| they no longer cover. Only the part of |rect| inside the
+        // bounds of every ancestor is moved. The caller must have moved the
+        // content by the same amount without scheduling a paint. Returns false,
+        // having moved and scheduled nothing, when the pixels can't be moved: no
+        // part of |rect| is visible, the View or an ancestor has a transform or a
+        // layer or caches its painting, a later sibling of the View or of an
+        // ancestor overlaps |rect|, or the Widget can't scroll its backing store.
+        // The caller then schedules a paint of |rect| itself.
+        virtual bool ScrollPaintedRect(const gfx::Rect& rect, int dx, int dy);
+
         // Called by the framework to paint a View. Performs translation and clipping
         // for View coordinates and language direction as required, allows the View
         // to paint itself via the various OnPaint*() event handlers and then paints
         // the hierarchy beneath it.
         virtual void Paint(gfx::Canvas* canvas);
 
+        // Enables or disables caching of this View's painting. When enabled, the
+        // first Paint() renders the View and all of its descendants into an
+        // offscreen bitmap, and later Paint() calls only blit that bitmap until the
+        // View or one of its descendants schedules a paint, or the View's size
+        // changes. Intended for complex subtrees whose content rarely changes
+        // (toolbars, bookmark bars). Disabling the cache releases the bitmap.
+        // The cache holds no backdrop, so it's only used while the View also
+        // fills its bounds opaquely (see SetFillsBoundsOpaquely()); otherwise the
+        // View paints normally.
+        void SetPaintCacheEnabled(bool enabled);
+        bool paint_cache_enabled() const { return paint_cache_enabled_; }
+
         // The background object is owned by this object and may be NULL.
         void set_background(Background* b) { background_.reset(b); }
         const Background* background() const { return background_.get(); }
         Background* background() { return background_.get(); }
 
         // The border object is owned by this object and may be NULL.
-        void set_border(Border* b) { border_.reset(b); }
+        void set_border(Border* b)
+        {
+            border_.reset(b);
+            InvalidatePreferredSize();
+        }
         const Border* border() const { return border_.get(); }
         Border* border() { return border_.get(); }
 
@@ -527,6 +562,11 @@ namespace view
         // Returns the deepest visible descendant that contains the specified point.
         virtual View* GetEventHandlerForPoint(const gfx::Point& point);
 
+        // Keeps the children in a grid by their bounds, so that looking for the
+        // child under a point only hit tests the children near it rather than all
+        // of them. Worth enabling on views with many children.
+        void SetChildHitTestIndexEnabled(bool enabled);
+
         // ù, ɹtrue, falseʾϵͳ.
         // ṩڽߵϵ.
         virtual bool OnSetCursor(const gfx::Point& p);
@@ -967,9 +1007,13 @@ namespace view
         virtual bool HasHitTestMask() const;
 
         // Called by HitTest to retrieve a mask for hit-testing against. Subclasses
-        // override to provide custom shaped hit test regions.
+        // override to provide custom shaped hit test regions. The mask is kept
+        // until the view is resized; call InvalidateHitTestMask if it changes for
+        // another reason.
         virtual void GetHitTestMask(gfx::Path* mask) const;
 
+        void InvalidateHitTestMask();
+
         // Focus ---------------------------------------------------------------------
 
         // Returns whether this view can accept focus.
@@ -1079,6 +1123,13 @@ namespace view
         // invoke OnPaint() on the View.
         void PaintCommon(gfx::Canvas* canvas);
 
+        // Paint() code used when the paint cache is enabled. Re-renders the cache
+        // if it is stale, then draws it to |canvas|.
+        void PaintFromCache(gfx::Canvas* canvas);
+
+        // Marks the paint cache of this View and of every ancestor as stale.
+        void InvalidatePaintCache();
+
         // Tree operations -----------------------------------------------------------
 
         // Removes |view| from the hierarchy tree.  If |update_focus_cycle| is true,
@@ -1112,6 +1163,10 @@ namespace view
         // Call VisibilityChanged() recursively for all children.
         void PropagateVisibilityNotifications(View* from, bool is_visible);
 
+        // Drops the preferred sizes cached by this view and all of its
+        // ancestors.
+        void InvalidatePreferredSize();
+
         // Registers/unregisters accelerators as necessary and calls
         // VisibilityChanged().
         void VisibilityChangedImpl(View* starting_from, bool is_visible);
@@ -1285,6 +1340,10 @@ namespace view
         // Whether this view is painting.
         bool painting_enabled_;
 
+        // See SetFillsBoundsOpaquely(). Kept here rather than with the layer
+        // state, which is dropped when the layer is destroyed.
+        bool fills_bounds_opaquely_;
+
         // Whether or not RegisterViewForVisibleBoundsNotification on the RootView
         // has been invoked.
         bool registered_for_visible_bounds_notification_;
@@ -1304,6 +1363,13 @@ namespace view
         // Whether the view needs to be laid out.
         bool needs_layout_;
 
+        // The answers of the LayoutManager to GetPreferredSize and, for
+        // |height_for_width_width_| (-1 if none), to GetHeightForWidth.
+        gfx::Size preferred_size_;
+        bool preferred_size_valid_;
+        int height_for_width_width_;
+        int height_for_width_;
+
         // The View's LayoutManager defines the sizing heuristics applied to child
         // Views. The default is absolute positioning according to bounds_.
         scoped_ptr<LayoutManager> layout_manager_;
@@ -1316,6 +1382,16 @@ namespace view
         // Border.
         scoped_ptr<Border> border_;
 
+        // Whether painting goes through |paint_cache_|.
+        bool paint_cache_enabled_;
+
+        // Offscreen copy of the last painting of this View and its descendants.
+        // Only allocated while the paint cache is enabled.
+        scoped_ptr<gfx::CanvasSkia> paint_cache_;
+
+        // False when |paint_cache_| no longer reflects the View's content.
+        bool paint_cache_valid_;
+
         // RTL painting --------------------------------------------------------------
 
         // Indicates whether or not the gfx::Canvas object passed to View::Paint()
@@ -1327,6 +1403,14 @@ namespace view
 
         scoped_ptr<internal::LayerHelper> layer_helper_;
 
+        // Input ---------------------------------------------------------------------
+
+        // The mask from GetHitTestMask, created by the first HitTest needing it.
+        mutable scoped_ptr<SkRegion> hit_test_mask_;
+
+        // Set by SetChildHitTestIndexEnabled.
+        scoped_ptr<internal::ChildHitTestIndex> child_hit_test_index_;
+
         // Accelerators --------------------------------------------------------------
 
         // true if when we were added to hierarchy we were without focus manager
@@ -198,6 +198,7 @@ namespace view
                 const ui::OSExchangeData& data,
                 int operation) = 0;
             virtual void SchedulePaintInRect(const gfx::Rect& rect) = 0;
+            virtual bool ScrollRect(const gfx::Rect& rect, int dx, int dy) = 0;
             virtual void SetCursor(HCURSOR cursor) = 0;
             virtual void ClearNativeFocus() = 0;
             virtual void FocusNativeView(HWND native_view) = 0;
@@ -533,6 +533,12 @@ namespace view
         view_->SchedulePaintInRect(rect);
     }
 
+    bool NativeWidgetViews::ScrollRect(const gfx::Rect& rect, int dx, int dy)
+    {
+        // The pixels live in the hosting widget, scheduled by the view's paints.
+        return view_->ScrollPaintedRect(rect, dx, dy);
+    }
+
     void NativeWidgetViews::SetCursor(HCURSOR cursor)
     {
         view_->set_cursor(cursor);
@@ -128,6 +128,7 @@ namespace view
             const ui::OSExchangeData& data,
             int operation);
         virtual void SchedulePaintInRect(const gfx::Rect& rect);
+        virtual bool ScrollRect(const gfx::Rect& rect, int dx, int dy);
         virtual void SetCursor(HCURSOR cursor);
         virtual void ClearNativeFocus();
         virtual void FocusNativeView(HWND native_view);
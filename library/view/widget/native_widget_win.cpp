@@ -1265,6 +1265,47 @@ namespace view
         }
     }
 
+    bool NativeWidgetWin::ScrollRect(const gfx::Rect& rect, int dx, int dy)
+    {
+        if(compositor_.get())
+        {
+            return false;
+        }
+
+        if(use_layered_buffer_)
+        {
+            // The whole back-buffer goes to the screen on the next redraw, which
+            // the strips scrolled into view schedule.
+            SkIRect subset = { rect.x(), rect.y(), rect.right(), rect.bottom() };
+            return layered_window_contents_->getDevice()->accessBitmap(
+                true).scrollRect(&subset, dx, dy);
+        }
+
+        // Child windows aren't moved along with the pixels under them.
+        RECT r = rect.ToRECT();
+        for(HWND child=::GetWindow(hwnd(), GW_CHILD); child;
+            child=::GetWindow(child, GW_HWNDNEXT))
+        {
+            if(!::IsWindowVisible(child))
+            {
+                continue;
+            }
+            RECT child_rect, intersection;
+            ::GetWindowRect(child, &child_rect);
+            ::MapWindowPoints(HWND_DESKTOP, hwnd(),
+                reinterpret_cast<POINT*>(&child_rect), 2);
+            if(::IntersectRect(&intersection, &child_rect, &r))
+            {
+                return false;
+            }
+        }
+
+        // Windows invalidates what it couldn't copy, such as parts covered by
+        // another window.
+        return ScrollWindowEx(hwnd(), dx, dy, &r, &r, NULL, NULL,
+            SW_INVALIDATE) != ERROR;
+    }
+
     void NativeWidgetWin::SetCursor(HCURSOR cursor)
     {
         if(cursor)
@@ -2180,6 +2221,12 @@ namespace view
             }
             else
             {
+                // The system invalidates parts of the window on its own (e.g. when
+                // they are uncovered). Those parts never went through
+                // SchedulePaintInRect(), so add them to the root view's damage or
+                // they would be clipped out.
+                AddUpdateRegionToDamage();
+
                 scoped_ptr<gfx::CanvasPaint> canvas(
                     gfx::CanvasPaint::CreateCanvasPaint(hwnd()));
                 delegate_->OnNativeWidgetPaint(canvas->AsCanvas());
@@ -2700,6 +2747,35 @@ namespace view
         set_window_ex_style(window_ex_style() | ex_style);
     }
 
+    void NativeWidgetWin::AddUpdateRegionToDamage()
+    {
+        base::win::ScopedRegion update_region(CreateRectRgn(0, 0, 0, 0));
+        if(GetUpdateRgn(hwnd(), update_region, FALSE) <= NULLREGION)
+        {
+            return;
+        }
+
+        DWORD size = GetRegionData(update_region, 0, NULL);
+        if(size == 0)
+        {
+            return;
+        }
+        std::vector<char> buffer(size);
+        RGNDATA* region_data = reinterpret_cast<RGNDATA*>(&buffer[0]);
+        if(!GetRegionData(update_region, size, region_data))
+        {
+            return;
+        }
+
+        internal::RootView* root_view =
+            static_cast<internal::RootView*>(GetWidget()->GetRootView());
+        const RECT* rects = reinterpret_cast<const RECT*>(region_data->Buffer);
+        for(DWORD i=0; i<region_data->rdh.nCount; ++i)
+        {
+            root_view->AddDamagedRect(gfx::Rect(rects[i]));
+        }
+    }
+
     void NativeWidgetWin::RedrawInvalidRect()
     {
         if(!use_layered_buffer_)
@@ -2726,7 +2802,8 @@ namespace view
             invalid_rect_.y(),
             invalid_rect_.width(),
             invalid_rect_.height());
-        GetWidget()->GetRootView()->Paint(layered_window_contents_.get());
+        static_cast<internal::RootView*>(GetWidget()->GetRootView())->PaintDamage(
+            layered_window_contents_.get());
         layered_window_contents_->restore();
 
         RECT wr;
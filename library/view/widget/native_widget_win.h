@@ -272,6 +272,7 @@ namespace view
             const ui::OSExchangeData& data,
             int operation);
         virtual void SchedulePaintInRect(const gfx::Rect& rect);
+        virtual bool ScrollRect(const gfx::Rect& rect, int dx, int dy);
         virtual void SetCursor(HCURSOR cursor);
         virtual void ClearNativeFocus();
         virtual void FocusNativeView(HWND native_view);
@@ -496,6 +497,10 @@ namespace view
 
         void SetInitParams(const Widget::InitParams& params);
 
+        // Adds the window's current update region to the root view's damage
+        // region. Called before a non-accelerated paint.
+        void AddUpdateRegionToDamage();
+
         // Synchronously paints the invalid contents of the Widget.
         void RedrawInvalidRect();
 
@@ -6,6 +6,8 @@
 #include "base/logging.h"
 #include "base/message_loop.h"
 
+#include "SkPath.h"
+
 #include "ui_gfx/canvas_skia.h"
 
 #include "ui_base/accessibility/accessible_view_state.h"
@@ -38,7 +40,10 @@ namespace view
             last_mouse_event_y_(-1),
             focus_search_(this, false, false),
             focus_traversable_parent_(NULL),
-            focus_traversable_parent_view_(NULL) {}
+            focus_traversable_parent_view_(NULL),
+            last_frame_repainted_pixels_(0),
+            total_repainted_pixels_(0),
+            painted_frame_count_(0) {}
 
         RootView::~RootView()
         {
@@ -175,11 +180,121 @@ namespace view
         void RootView::SchedulePaintInRect(const gfx::Rect& rect)
         {
             gfx::Rect xrect = ConvertRectToParent(rect);
-            gfx::Rect invalid_rect = GetLocalBounds().Intersect(xrect);
-            if(!invalid_rect.IsEmpty())
+            ScheduleDamage(GetLocalBounds().Intersect(xrect));
+        }
+
+        bool RootView::ScrollPaintedRect(const gfx::Rect& rect, int dx, int dy)
+        {
+            gfx::Rect scroll_rect = GetLocalBounds().Intersect(
+                ConvertRectToParent(rect));
+            if(abs(dx)>=scroll_rect.width() ||
+                abs(dy)>=scroll_rect.height())
+            {
+                // None of the painted pixels stay in view.
+                return false;
+            }
+            if(!widget_->ScrollRect(scroll_rect, dx, dy))
+            {
+                return false;
+            }
+
+            // Damage that isn't painted yet moved along with the pixels around it.
+            std::vector<gfx::Rect> damaged_rects;
+            damage_region_.GetRects(&damaged_rects);
+            for(size_t i=0; i<damaged_rects.size(); ++i)
+            {
+                gfx::Rect moved_rect = damaged_rects[i].Intersect(scroll_rect);
+                if(!moved_rect.IsEmpty())
+                {
+                    moved_rect.Offset(dx, dy);
+                    ScheduleDamage(moved_rect.Intersect(scroll_rect));
+                }
+            }
+
+            // The strips that scrolled into view.
+            if(dy > 0)
+            {
+                ScheduleDamage(gfx::Rect(scroll_rect.x(), scroll_rect.y(),
+                    scroll_rect.width(), dy));
+            }
+            else if(dy < 0)
+            {
+                ScheduleDamage(gfx::Rect(scroll_rect.x(), scroll_rect.bottom()+dy,
+                    scroll_rect.width(), -dy));
+            }
+            if(dx > 0)
+            {
+                ScheduleDamage(gfx::Rect(scroll_rect.x(), scroll_rect.y(),
+                    dx, scroll_rect.height()));
+            }
+            else if(dx < 0)
+            {
+                ScheduleDamage(gfx::Rect(scroll_rect.right()+dx, scroll_rect.y(),
+                    -dx, scroll_rect.height()));
+            }
+            return true;
+        }
+
+        void RootView::AddDamagedRect(const gfx::Rect& rect)
+        {
+            damage_region_.Add(GetLocalBounds().Intersect(rect));
+        }
+
+        void RootView::ScheduleDamage(const gfx::Rect& rect)
+        {
+            if(!rect.IsEmpty())
+            {
+                damage_region_.Add(rect);
+                widget_->SchedulePaintInRect(rect);
+            }
+        }
+
+        void RootView::PaintDamage(gfx::Canvas* canvas)
+        {
+            if(damage_region_.IsEmpty())
             {
-                widget_->SchedulePaintInRect(invalid_rect);
+                // The platform asked for a paint nothing was scheduled for, so paint
+                // whatever the canvas clip asks for.
+                View::Paint(canvas);
+                return;
             }
+
+            last_frame_repainted_pixels_ = damage_region_.GetArea();
+            total_repainted_pixels_ += last_frame_repainted_pixels_;
+            ++painted_frame_count_;
+            last_frame_layout_counts_ = LayoutCounters::counts();
+            LayoutCounters::Reset();
+
+            SkRegion damage(damage_region_.region());
+
+            // Damage scheduled while painting belongs to the next frame.
+            damage_region_.Clear();
+
+            // SkCanvas::clipRegion() takes device coordinates, so apply the offset
+            // of the paint rect the canvas was translated by. Any other transform
+            // falls back to clipping with the region's outline.
+            gfx::CanvasSkia* skia_canvas = canvas->AsCanvasSkia();
+            const SkMatrix& matrix = skia_canvas->getTotalMatrix();
+            canvas->Save();
+            if((matrix.getType() & ~SkMatrix::kTranslate_Mask) == 0)
+            {
+                damage.translate(SkScalarRound(matrix.getTranslateX()),
+                    SkScalarRound(matrix.getTranslateY()));
+                skia_canvas->clipRegion(damage);
+            }
+            else
+            {
+                SkPath damage_path;
+                damage.getBoundaryPath(&damage_path);
+                skia_canvas->clipPath(damage_path);
+            }
+            View::Paint(canvas);
+            canvas->Restore();
+        }
+
+        void RootView::ClearDamage()
+        {
+            damage_region_.Clear();
         }
 
         bool RootView::OnSetCursor(const gfx::Point& p)
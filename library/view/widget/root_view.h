@@ -6,8 +6,11 @@
 
 #include <string>
 
+#include "ui_gfx/damage_region.h"
+
 #include "view/focus/focus_manager.h"
 #include "view/focus/focus_search.h"
+#include "view/layout/layout_counters.h"
 
 namespace view
 {
@@ -53,6 +56,39 @@ namespace view
             // Called when parent of the host changed.
             void NotifyNativeViewHierarchyChanged(bool attached, HWND native_view);
 
+            // Painting ------------------------------------------------------------------
+
+            // Adds |rect| (in RootView coordinates) to the damage region without
+            // asking the Widget to schedule a paint. Used by the Widget for areas the
+            // platform invalidated on its own, such as exposed window contents.
+            void AddDamagedRect(const gfx::Rect& rect);
+
+            const gfx::DamageRegion& damage_region() const { return damage_region_; }
+
+            // Paints the damage scheduled since the last frame, clipped to it, and
+            // clears it. Used by the Widget for the paints it scheduled; anything
+            // else (e.g. painting into a drag image) calls Paint() and isn't clipped.
+            void PaintDamage(gfx::Canvas* canvas);
+
+            // Drops the damage scheduled so far without painting it here. Used by
+            // the Widget after the compositor has drawn the frame.
+            void ClearDamage();
+
+            // Paint statistics. A frame is one PaintDamage() with scheduled damage;
+            // the pixel counts are the areas of the damage regions painted.
+            int64 last_frame_repainted_pixels() const
+            {
+                return last_frame_repainted_pixels_;
+            }
+            int64 total_repainted_pixels() const { return total_repainted_pixels_; }
+            int painted_frame_count() const { return painted_frame_count_; }
+
+            // The layout work done between the last two frames.
+            const LayoutCounters::Counts& last_frame_layout_counts() const
+            {
+                return last_frame_layout_counts_;
+            }
+
             // Input ---------------------------------------------------------------------
 
             // Process a key event. Send the event to the focused view and up the focus
@@ -90,6 +126,7 @@ namespace view
             virtual bool IsVisibleInRootView() const;
             virtual std::string GetClassName() const;
             virtual void SchedulePaintInRect(const gfx::Rect& rect);
+            virtual bool ScrollPaintedRect(const gfx::Rect& rect, int dx, int dy);
             virtual bool OnSetCursor(const gfx::Point& p);
             virtual bool OnMousePressed(const MouseEvent& event);
             virtual bool OnMouseDragged(const MouseEvent& event);
@@ -122,6 +159,12 @@ namespace view
             // be applied to the point prior to calling this).
             void SetMouseLocationAndFlags(const MouseEvent& event);
 
+            // Painting ------------------------------------------------------------------
+
+            // Adds |rect| (in RootView coordinates) to the damage region and asks
+            // the Widget to paint it. Empty rects are ignored.
+            void ScheduleDamage(const gfx::Rect& rect);
+
             //////////////////////////////////////////////////////////////////////////////
 
             // Tree operations -----------------------------------------------------------
@@ -170,6 +213,18 @@ namespace view
             // Tracks drag state for a view.
             View::DragInfo drag_info;
 
+            // Painting ------------------------------------------------------------------
+
+            // Rects scheduled for painting since the last frame. PaintDamage() clips
+            // to it, so View::Paint() skips views lying entirely outside the damaged
+            // rects rather than repainting their whole bounding box.
+            gfx::DamageRegion damage_region_;
+
+            int64 last_frame_repainted_pixels_;
+            int64 total_repainted_pixels_;
+            int painted_frame_count_;
+            LayoutCounters::Counts last_frame_layout_counts_;
+
             DISALLOW_IMPLICIT_CONSTRUCTORS(RootView);
         };
 
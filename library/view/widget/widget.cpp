@@ -749,6 +749,11 @@ namespace view
         native_widget_->SchedulePaintInRect(rect);
     }
 
+    bool Widget::ScrollRect(const gfx::Rect& rect, int dx, int dy)
+    {
+        return native_widget_->ScrollRect(rect, dx, dy);
+    }
+
     void Widget::SetCursor(HCURSOR cursor)
     {
         native_widget_->SetCursor(cursor);
@@ -1144,12 +1149,16 @@ namespace view
         compositor->set_root_layer(GetRootView()->layer());
         compositor->Draw(force_clear);
 
+        // The layers repaint what was scheduled on their own, so the root view's
+        // damage is done with.
+        root_view_->ClearDamage();
+
         return true;
     }
 
     void Widget::OnNativeWidgetPaint(gfx::Canvas* canvas)
     {
-        GetRootView()->Paint(canvas);
+        root_view_->PaintDamage(canvas);
     }
 
     int Widget::GetNonClientComponent(const gfx::Point& point)
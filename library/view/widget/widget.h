@@ -405,6 +405,12 @@ namespace view
         // redrawn.
         void SchedulePaintInRect(const gfx::Rect& rect);
 
+        // Moves the pixels already painted in |rect| (in client area coordinates)
+        // by |dx|, |dy|, clipped to |rect|. The strips left uncovered aren't
+        // scheduled for painting. Returns false, moving nothing, if the backing
+        // store can't be scrolled.
+        bool ScrollRect(const gfx::Rect& rect, int dx, int dy);
+
         // Sets the currently visible cursor. If |cursor| is NULL, the cursor used
         // before the current is restored.
         void SetCursor(HCURSOR cursor);